@@ -17,6 +17,12 @@ using lnk_data_atom = caf::atom_constant<caf::atom("tl data")>;
 using lnk_dnode_atom = caf::atom_constant<caf::atom("tl dnode")>;
 // async invoke `fusion_link::populate()`
 using flnk_populate_atom = caf::atom_constant<caf::atom("tfl pull")>;
+// deliver buffered node events to subscriber
+using node_flush_atom = caf::atom_constant<caf::atom("tn flush")>;
+// requests served by published subtree
+using rtree_ls_atom = caf::atom_constant<caf::atom("trt ls")>;
+using rtree_data_atom = caf::atom_constant<caf::atom("trt data")>;
+using rtree_deref_atom = caf::atom_constant<caf::atom("trt deref")>;
 	
 } /* namespace blue_sky */
 
@@ -37,6 +37,10 @@ BSS_FCN_DECL(load_and_construct, blue_sky::tree::sym_link)
 BSS_FCN_DECL(serialize, blue_sky::tree::fusion_link)
 BSS_FCN_DECL(load_and_construct, blue_sky::tree::fusion_link)
 
+// remote link
+BSS_FCN_DECL(save, blue_sky::tree::remote_link)
+BSS_FCN_DECL(load_and_construct, blue_sky::tree::remote_link)
+
 // node
 BSS_FCN_DECL(serialize, blue_sky::tree::node)
 
@@ -0,0 +1,68 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Apply changes of several nodes in single transaction
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "node.h"
+#include "errors.h"
+
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// Collects inserts, erases, renames and moves that are applied by `commit()` at once:
+/// `tree::batch b; b.insert(N, L).rename(N, lid, "new_name").erase(M, lid2); b.commit();`
+/// All affected nodes are locked once (in order of their addresses, so concurrent batches
+/// can't deadlock), readers never see partially applied batch.
+/// Inserted link is removed from it's previous owner and becomes handle of pointed node inside
+/// transaction, so previous owners of inserted links and of replaced handles are locked too.
+/// Events produced by batch are delivered after commit, every subscriber gets them together.
+/// If any operation fails, already applied ones are rolled back and no events are delivered
+/// (`mutation_log` records rolled back operations followed by their inverses).
+class BS_API batch {
+public:
+	using InsertPolicy = node::InsertPolicy;
+
+	/// add link `L` into node `dst`
+	auto insert(sp_node dst, sp_link L, InsertPolicy pol = InsertPolicy::AllowDupNames) -> batch&;
+	/// add hard link to object `obj` into node `dst`
+	auto insert(sp_node dst, std::string name, sp_obj obj, InsertPolicy pol = InsertPolicy::AllowDupNames)
+	-> batch&;
+	/// erase link with given ID from node `N`
+	auto erase(sp_node N, const link::id_type& lid) -> batch&;
+	/// rename link with given ID in node `N`
+	auto rename(sp_node N, const link::id_type& lid, std::string new_name) -> batch&;
+	/// move link with given ID from node `src` to the end of node `dst`
+	auto move(sp_node src, const link::id_type& lid, sp_node dst, InsertPolicy pol = InsertPolicy::AllowDupNames)
+	-> batch&;
+
+	/// number of pending operations
+	auto size() const -> std::size_t;
+	auto empty() const -> bool;
+
+	/// apply all pending operations in single transaction
+	/// returns error of first failed operation, all changes are rolled back in that case
+	auto commit() -> error;
+	/// drop pending operations, tree isn't touched
+	auto abort() -> void;
+
+private:
+	enum class Op { Insert, Erase, Rename, Move };
+	struct op {
+		Op kind;
+		sp_node N;
+		sp_link L;
+		link::id_type lid;
+		std::string name;
+		sp_node dst;
+		InsertPolicy pol;
+	};
+	std::vector<op> ops_;
+};
+
+NAMESPACE_END(blue_sky::tree)
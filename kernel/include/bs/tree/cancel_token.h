@@ -0,0 +1,72 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Cancellation token & deadline for async tree requests
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "errors.h"
+
+#include <chrono>
+#include <memory>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// Token that is passed along with async request. Request is dropped before execution
+/// if token is cancelled or it's deadline is expired, callback then receives `Error::RequestCancelled`.
+/// Copies share state, so request can be cancelled by any copy.
+/// While request is executing, it's token is available via `cancel_token::current()`,
+/// so that long operations (like `fusion_iface::pull_data()`) can poll it and bail out early.
+class BS_API cancel_token {
+public:
+	using clock = std::chrono::steady_clock;
+
+	/// make token that can only be cancelled explicitly
+	cancel_token();
+	/// make token that additionally expires at given time point
+	explicit cancel_token(clock::time_point deadline);
+	/// ... or after given timeout (counted from now)
+	explicit cancel_token(clock::duration timeout);
+
+	/// token that never fires (used by API that don't accept tokens)
+	static auto none() -> const cancel_token&;
+
+	/// cancel request(s) associated with token
+	/// requests sleeping until busy link finishes it's operation are woken up
+	auto cancel() const -> void;
+	/// true if token was cancelled or deadline is expired
+	auto is_cancelled() const -> bool;
+	/// returns `clock::time_point::max()` if deadline isn't set
+	auto deadline() const -> clock::time_point;
+
+	/// returns quiet error with `Error::RequestCancelled` code if token is fired, success otherwise
+	auto check() const -> error;
+
+	/// token of request that is executing in calling thread
+	static auto current() -> const cancel_token&;
+
+	/// RAII guard that makes token current for calling thread
+	class BS_API scope {
+	public:
+		explicit scope(const cancel_token& token);
+		~scope();
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+
+	private:
+		const cancel_token* prev_;
+	};
+
+private:
+	struct state;
+	std::shared_ptr<state> state_;
+
+	struct none_tag {};
+	explicit cancel_token(none_tag);
+};
+
+NAMESPACE_END(blue_sky::tree)
@@ -26,7 +26,11 @@ enum class Error {
 	UnboundSymLink,
 	LinkBusy,
 	NoFusionBridge,
-	KeyMismatch
+	KeyMismatch,
+	LinkRejected,
+	RemoteUnreachable,
+	RequestCancelled,
+	QueueOverflow
 };
 
 BS_API std::error_code make_error_code(Error);
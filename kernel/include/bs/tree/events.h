@@ -0,0 +1,67 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Events that are emitted by node when it's content changes
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "link.h"
+#include "../detail/enumops.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// kinds of node events, can be combined into subscription filter
+enum class Event : std::uint32_t {
+	None = 0,
+	LinkInserted = 1,
+	LinkErased = 2,
+	LinkRenamed = 4,
+	LinkStatusChanged = 8,
+	LinkMoved = 16,
+	/// some events were dropped because subscriber can't keep up, subtree must be rescanned
+	Overflow = 32,
+	/// object pointed by link was modified or replaced, see `link::notify_data_changed()`
+	DataChanged = 64,
+	/// custom order of node was sorted, carries no link
+	Reordered = 128,
+	All = 255
+};
+
+/// single change of node content
+struct event {
+	Event kind = Event::None;
+	/// inserted, erased, renamed, moved link or link which status or data changed
+	sp_link link;
+	/// handle of node where change happened (destination node for move)
+	sp_link origin;
+	/// handle of source node for move
+	sp_link source;
+	/// previous name for rename
+	std::string old_name;
+	/// changed request & it's previous status
+	link::Req req = link::Req::Data;
+	link::ReqStatus prev_status = link::ReqStatus::Void;
+
+	/// state captured while node is locked, filled only for internal synchronous subscribers
+	/// (mutations log), because they receive events after node can be changed again
+	/// paths (by IDs) of origin & source nodes
+	std::string origin_path, source_path;
+	/// link name after change
+	std::string name;
+	/// link position in origin node after insert, move or data change
+	std::size_t idx = 0;
+};
+
+/// subscriber receives events in batches
+using events_f = std::function<void(std::vector<event>)>;
+
+NAMESPACE_END(blue_sky::tree)
+
+BS_ALLOW_ENUMOPS(blue_sky::tree::Event)
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "link.h"
+#include "cancel_token.h"
 
 NAMESPACE_BEGIN(blue_sky) NAMESPACE_BEGIN(tree)
 
@@ -22,6 +23,8 @@ public:
 	virtual auto populate(const sp_node& root, const std::string& child_type_id = "") -> error = 0;
 	/// download passed object's content from third-party backend
 	virtual auto pull_data(const sp_obj& root) -> error = 0;
+	/// [NOTE] both calls are made with token of originating request set as `cancel_token::current()`
+	/// long running bridge should poll it and return early -- link status is then rolled back
 
 	virtual ~fusion_iface();
 };
@@ -61,6 +64,9 @@ public:
 	// async populate
 	auto populate(process_data_cb f, std::string child_type_id) const
 		-> void;
+	// async populate that is dropped if `token` is cancelled or expired
+	auto populate(process_data_cb f, std::string child_type_id, cancel_token token) const
+		-> void;
 
 	// access to link's fusion bridge
 	auto bridge() const -> sp_fusion;
@@ -12,6 +12,7 @@
 #include "../objbase.h"
 #include "../detail/enumops.h"
 #include "inode.h"
+#include "cancel_token.h"
 
 #include <atomic>
 #include <chrono>
@@ -19,6 +20,9 @@
 
 NAMESPACE_BEGIN(blue_sky)
 NAMESPACE_BEGIN(tree)
+NAMESPACE_BEGIN(detail)
+struct path_cache;
+NAMESPACE_END(detail)
 
 /*-----------------------------------------------------------------------------
  *  base class of all links
@@ -50,6 +54,13 @@ public:
 
 	/// obtain link's symbolic name
 	auto name() const -> std::string;
+	/// access name without copying, reference is valid until link is renamed
+	auto name_ref() const -> const std::string&;
+
+	/// if on, names of links created after this call are stored in global pool
+	/// such that equal names share single string instance
+	static auto intern_names(bool on) -> void;
+	static auto interning_names() -> bool;
 
 	/// get link's container
 	auto owner() const -> sp_node;
@@ -59,7 +70,9 @@ public:
 		Plain = 0,
 		Persistent = 1,
 		Disabled = 2,
-		LazyLoad = 4
+		LazyLoad = 4,
+		// dead link that is waiting for removal (see `weak_sweeper`)
+		Tombstone = 8
 	};
 	auto flags() const -> Flags;
 	auto set_flags(Flags new_flags) -> void;
@@ -127,17 +140,55 @@ public:
 	auto rs_reset_if_eq(Req request , ReqStatus self_rs, ReqStatus new_rs = ReqStatus::Void) const -> ReqStatus;
 	auto rs_reset_if_neq(Req request, ReqStatus self_rs, ReqStatus new_rs = ReqStatus::Void) const -> ReqStatus;
 
+	/// tell owner's subscribers that pointed object was modified or replaced
+	auto notify_data_changed() const -> void;
+
 	/// obtain data in async manner passing it to callback
 	using process_data_cb = std::function<void(result_or_err<sp_obj>, sp_clink)>;
 	auto data(process_data_cb f, bool high_priority = false) const -> void;
 	/// ... and data node
 	auto data_node(process_data_cb f, bool high_priority = false) const -> void;
+	/// same as above, but request is dropped if `token` is cancelled or expired before execution
+	/// (callback receives `Error::RequestCancelled`), token is also current while request executes
+	auto data(process_data_cb f, cancel_token token, bool high_priority = false) const -> void;
+	auto data_node(process_data_cb f, cancel_token token, bool high_priority = false) const -> void;
+
+	/// what happens with async request that doesn't fit into queue
+	enum class Overflow {
+		Reject,   ///< callback immediately receives `Error::QueueOverflow`
+		/// join queued request of same kind to same link (receive it's result), else reject
+		/// joined request is still cancelled by it's own token only
+		Coalesce,
+		/// sender waits until queue has room or it's token is cancelled or expires
+		/// (then callback receives `Error::RequestCancelled`)
+		/// [NOTE] blocked actor thread can't process requests, so requests sent from link actors
+		/// (i.e. from callbacks of other requests) are rejected instead. Don't send requests with this
+		/// policy from other actors too, or make sure that it can't exhaust CAF workers
+		Block
+	};
+	/// bounds of async requests queues, zero means unbounded
+	struct queue_limits {
+		std::size_t per_link = 0;
+		std::size_t total = 0;
+		Overflow policy = Overflow::Reject;
+	};
+	/// limits apply to requests queued to all link & fusion link actors
+	static auto set_queue_limits(queue_limits limits) -> void;
+	static auto get_queue_limits() -> queue_limits;
+	/// number of async requests queued to this link and not started yet
+	auto queue_depth() const -> std::size_t;
+	/// number of async requests queued to all links, producers can throttle on it
+	static auto total_queue_depth() -> std::size_t;
+	/// number of senders waiting for room in queue (`Overflow::Block`)
+	static auto blocked_senders() -> std::size_t;
 
 protected:
 	// serialization support
 	friend class blue_sky::atomizer;
 	// full access for node
 	friend class node;
+	friend class batch;
+	friend struct detail::path_cache;
 
 	/// ctor accept name of created link
 	link(std::string name, Flags f = Plain);
@@ -252,6 +303,9 @@ public:
 
 	auto type_id() const -> std::string override;
 
+	/// check if pointed object is already destroyed
+	auto expired() const -> bool;
+
 private:
 	std::weak_ptr<objbase> data_;
 
@@ -0,0 +1,75 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Append-only binary log of subtree mutations, it's replay and follower
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "node.h"
+#include "errors.h"
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// Records inserts, erases, renames, moves, sorts and data changes (`link::notify_data_changed()`)
+/// of subtree into binary log file. Inserted and changed links are stored with serialized objects,
+/// so replaying log on top of base snapshot (made by `save_tree()` with `TreeArchive::Binary`)
+/// reproduces the tree:
+/// `save_tree(root, "base.bst", TreeArchive::Binary); mutation_log log(root, "tree.log");`
+/// Every record gets sequence number, log starts with header that holds seq of last record
+/// folded into base snapshot. Records are written in order mutations happen by thread that made them,
+/// before mutating call returns. If single call produces more than `capacity` events, they are
+/// replaced by record with whole subtree.
+/// Durability: records are flushed to OS after every call, but not fsync'ed - they survive crash of
+/// process, but not of OS or power loss. Incomplete record at the tail is dropped when log is opened.
+class BS_API mutation_log {
+public:
+	/// start logging mutations of subtree pointed by `root` into `filename`
+	/// existing log is continued, throws `error` if log can't be opened or created
+	mutation_log(sp_link root, std::string filename, std::size_t capacity = 65536);
+	/// stops logging
+	~mutation_log();
+
+	auto filename() const -> const std::string&;
+	/// seq of last written record
+	auto last_seq() const -> std::uint64_t;
+
+	/// write events that are produced but not written yet (by other threads)
+	auto flush() -> void;
+	/// fold log into `snapshot`, log is restarted from scratch
+	auto compact(const std::string& snapshot) -> error;
+
+	/// apply records with seq > `after_seq` to subtree pointed by `root`, returns seq of last applied record
+	static auto replay(const std::string& filename, const sp_link& root, std::uint64_t after_seq = 0)
+	-> result_or_err<std::uint64_t>;
+	/// load `snapshot`, replay log on top of it, save snapshot back and restart log
+	static auto compact(const std::string& snapshot, const std::string& filename) -> error;
+
+private:
+	struct impl;
+	std::shared_ptr<impl> pimpl_;
+};
+
+/// Tails log written by `mutation_log` (possibly by another process) and applies new records to replica.
+/// Replica is expected to be restored from same base snapshot.
+class BS_API log_follower {
+public:
+	log_follower(std::string filename, sp_link replica, std::uint64_t after_seq = 0);
+
+	/// apply records appended since previous call, returns number of applied records
+	/// fails if log was compacted past records not yet seen by follower (replica must be reloaded)
+	auto poll() -> result_or_err<std::size_t>;
+	/// seq of last applied record
+	auto last_seq() const -> std::uint64_t;
+
+private:
+	const std::string filename_;
+	const sp_link replica_;
+	std::uint64_t last_seq_;
+	// read position & base seq of log file when position was taken
+	std::uint64_t offset_ = 0, base_seq_ = 0;
+};
+
+NAMESPACE_END(blue_sky::tree)
@@ -14,6 +14,7 @@
 #include "../detail/is_container.h"
 #include "../detail/enumops.h"
 #include "link.h"
+#include "events.h"
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
@@ -22,31 +23,54 @@
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
+#include <functional>
+#include <map>
+
 NAMESPACE_BEGIN(blue_sky::tree)
 
 // global alias to shorten typing
 namespace mi = boost::multi_index;
 
+class query;
+
 class BS_API node : public objbase {
 public:
 	using id_type = link::id_type;
 
+	// secondary key that can be switched off
+	// inactive key returns same empty value for all links, so index isn't really maintained
+	template<typename R, R (link::*KeyF)() const>
+	struct lazy_key {
+		using result_type = std::decay_t<R>;
+		bool active = true;
+
+		R operator()(const link& L) const {
+			if(active) return (L.*KeyF)();
+			static const result_type nil{};
+			return nil;
+		}
+		R operator()(const sp_link& L) const {
+			return (*this)(*L);
+		}
+	};
+
+	// names are compared by reference, interned names are equal if they point to same string
+	struct name_less {
+		bool operator()(const std::string& lhs, const std::string& rhs) const {
+			return &lhs != &rhs && lhs < rhs;
+		}
+	};
+
 	// links are sorted by unique ID
 	using id_key = mi::const_mem_fun<
 		link, const id_type&, &link::id
 	>;
 	// and non-unique name
-	using name_key = mi::const_mem_fun<
-		link, std::string, &link::name
-	>;
+	using name_key = lazy_key<const std::string&, &link::name_ref>;
 	// and non-unique object ID
-	using oid_key = mi::const_mem_fun<
-		link, std::string, &link::oid
-	>;
+	using oid_key = lazy_key<std::string, &link::oid>;
 	// and non-unique object type
-	using type_key = mi::const_mem_fun<
-		link, std::string, &link::obj_type_id
-	>;
+	using type_key = lazy_key<std::string, &link::obj_type_id>;
 	// and have random-access index that preserve custom items ordering
 	struct any_order {};
 
@@ -56,7 +80,7 @@ public:
 		mi::indexed_by<
 			mi::sequenced< mi::tag< any_order > >,
 			mi::hashed_unique< mi::tag< id_key >, id_key >,
-			mi::ordered_non_unique< mi::tag< name_key >, name_key >,
+			mi::ordered_non_unique< mi::tag< name_key >, name_key, name_less >,
 			mi::ordered_non_unique< mi::tag< oid_key >, oid_key >,
 			mi::ordered_non_unique< mi::tag< type_key >, type_key >
 		>
@@ -64,6 +88,9 @@ public:
 
 	// key alias
 	enum class Key { ID, OID, Name, Type, AnyOrder };
+
+	/// set of secondary indexes (ID & AnyOrder indexes are always maintained)
+	enum class Indexes { None = 0, Name = 1, OID = 2, Type = 4, All = 7 };
 	template<Key K> using Key_const = std::integral_constant<Key, K>;
 
 private:
@@ -173,6 +200,8 @@ public:
 	/// deep search by given key with specified treatment
 	sp_link deep_search(const std::string& key, Key key_meaning) const;
 
+	/// links with given key, switched off index of that key is built on first call
+	/// [NOTE] building index invalidates all iterators, like `set_indexes()`
 	range<Key::Name> equal_range(const std::string& link_name) const;
 	range<Key::OID>  equal_range_oid(const std::string& oid) const;
 	range<Key::Type> equal_type(const std::string& type_id) const;
@@ -210,6 +239,24 @@ public:
 		}
 	}
 
+	/// move link with given ID from this node to `dst` node
+	/// link object and it's inode are preserved, both nodes are locked during operation,
+	/// so link is never seen in both nodes or in none of them
+	insert_status<Key::AnyOrder> move(
+		const id_type& lid, const std::shared_ptr<node>& dst, InsertPolicy pol = InsertPolicy::AllowDupNames
+	);
+	/// move link and place it at given index in `dst`
+	insert_status<Key::AnyOrder> move(
+		const id_type& lid, const std::shared_ptr<node>& dst, std::size_t idx,
+		InsertPolicy pol = InsertPolicy::AllowDupNames
+	);
+	/// bulk move preserving relative order of links, moved links are placed at given index in `dst`
+	/// returns number of moved links
+	std::size_t move(
+		const std::vector<id_type>& lids, const std::shared_ptr<node>& dst, std::size_t idx = std::size_t(-1),
+		InsertPolicy pol = InsertPolicy::AllowDupNames
+	);
+
 	/// leafs removal
 	void erase(const std::size_t idx);
 	void erase(const id_type& link_id);
@@ -233,6 +280,32 @@ public:
 		return keys(Key_const<K>());
 	}
 
+	/// position of paged iteration, default constructed cursor points to the beginning
+	struct cursor {
+		/// last returned link and it's key in iteration order
+		id_type last_id = {};
+		std::string last_key;
+		/// link that followed last returned one, iteration resumes from it if last link is erased
+		id_type next_id = {};
+		/// number of links returned so far, custom order resumes from this position
+		/// if both last and next links are erased
+		std::size_t offset = 0;
+		/// true if there are no more links
+		bool at_end = false;
+	};
+	struct page_t {
+		std::vector<sp_link> links;
+		/// cursor to get next page from
+		cursor next;
+	};
+	/// return up to `n` links that follow cursor position in given order
+	/// cursor stays valid while node is modified: next page starts right after last returned link
+	/// (if that link is erased, iteration continues from link that followed it, if both are erased,
+	/// AnyOrder continues from former position and key orders from next key)
+	/// order by key without index is copied once and reused until node is changed
+	/// [NOTE] ID index has no stable order, so `Key::ID` gives links in custom order
+	auto page(Key order, const cursor& from, std::size_t n = 1024) const -> page_t;
+
 	/// rename link at given position
 	bool rename(iterator<Key::AnyOrder> pos, std::string new_name);
 	bool rename(const std::size_t idx, std::string new_name);
@@ -263,10 +336,108 @@ public:
 
 	/// ensure that owner of all contained leafs is correctly set to this node
 	/// if deep is true, correct owners in all subtree
-	void propagate_owner(bool deep = false);
+	/// deep pass processes nested nodes concurrently if `parallel` is set
+	void propagate_owner(bool deep = false, bool parallel = true);
+
+	/// make deep copy of this node
+	/// if `parallel` is true, sibling subtrees are cloned concurrently
+	/// owners of all links in returned subtree are already set up
+	auto clone(bool parallel = true) const -> std::shared_ptr<node>;
+
+	/// secondary indexes that are updated on every insert
+	/// searches by key without index scan links, calls that return iterators of such index
+	/// (`begin<K>()`, `end<K>()`, `equal_range()`) build it on first use and it stays active after that
+	auto indexes() const -> Indexes;
+	/// enable or drop indexes
+	/// [NOTE] invalidates all iterators if set of active indexes changes
+	auto set_indexes(Indexes idx) -> void;
+
+	/// maintain summary of keys (IDs, names, OIDs) of all links in subtree
+	/// that lets `deep_search()` skip subtrees that can't contain searched key
+	/// summary is turned on in all nested nodes, including ones that are inserted later
+	/// subtrees behind sym, weak, fusion links and nodes owned by other links aren't summarized,
+	/// any key is reported as possible while such link is in subtree
+	/// [NOTE] can't be turned off in nested node while parent maintains summary
+	/// returns if summary is maintained after call
+	auto enable_summary(bool on = true) -> bool;
+	/// check if subtree can contain link with given key
+	/// false means that key is definitely not in subtree, always true if summary is off
+	auto may_contain(const std::string& key, Key key_meaning = Key::Name) const -> bool;
+
+	/// stats of subtree, including all nested nodes
+	struct stats_t {
+		/// number of links and nodes
+		std::size_t links = 0, nodes = 0;
+		/// number of lazy links which data isn't loaded yet
+		std::size_t unloaded = 0;
+		/// objects count per type
+		std::map<std::string, std::size_t> types;
+		/// values of registered metrics
+		std::map<std::string, double> metrics;
+	};
+	/// additive metric: value for subtree is a sum of values for every link that owns object
+	using metric_f = std::function<double(const sp_link&)>;
+	/// register metric that is calculated by all nodes maintaining stats (pass nullptr to remove)
+	/// [NOTE] `f` is called while node is locked and must not modify tree
+	static auto register_metric(std::string name, metric_f f) -> void;
+
+	/// maintain stats of subtree that are updated on every insert, erase and move
+	/// stats are turned on in all nested nodes, including ones that are inserted later
+	/// [NOTE] can't be turned off in nested node while parent maintains stats
+	/// returns if stats are maintained after call
+	auto enable_stats(bool on = true) -> bool;
+	/// read stats of subtree, empty if stats are off
+	/// contributions of lazy links that are loaded since last call and of links counted before
+	/// metrics were (un)registered are recalculated here in place, only such subtrees are visited
+	auto stats() const -> stats_t;
+
+	/// strict weak ordering of links that custom order can be sorted by
+	using less_f = std::function<bool(const link&, const link&)>;
+	/// order of names where digit sequences are compared as numbers (`item_2` < `item_10`)
+	static auto natural_order() -> less_f;
+	/// order by modification time of link's inode, links without inode go first
+	static auto mod_time_order() -> less_f;
+	/// order by user-defined key, `key(const link&)` must return value comparable with `<`
+	template<typename F>
+	static auto key_order(F key) -> less_f {
+		return [key = std::move(key)](const link& lhs, const link& rhs) { return key(lhs) < key(rhs); };
+	}
+
+	/// stable sort of custom order (`Key::AnyOrder`) in place
+	/// if `persistent` is set, order is maintained after that: inserted and renamed links and links
+	/// which data is changed (see `link::notify_data_changed()`) are moved to their sorted position,
+	/// explicit positions passed to `insert()` & `move()` are ignored
+	/// sort with nullptr comparator turns persistent order off
+	/// `Event::Reordered` is emitted after links are sorted
+	/// [NOTE] `less` is called while node is locked and must not modify tree
+	auto sort(less_f less, bool persistent = true) -> void;
+	/// true if custom order is maintained sorted
+	auto is_sorted() const -> bool;
+
+	/// generation of last change of node's links: insert, erase, rename, move or data change
+	/// values are taken from single global clock, so they are comparable between nodes and
+	/// with `node::current_generation()` -- node has changed since moment `g` if `generation() > g`
+	auto generation() const -> std::uint64_t;
+	/// generation of last change in whole subtree, including nested nodes
+	/// first call turns on tracking in all nested nodes, including ones that are inserted later,
+	/// after that every change costs one counter update per ancestor
+	auto subtree_generation() const -> std::uint64_t;
+	/// latest generation assigned to any node
+	static auto current_generation() -> std::uint64_t;
+
+	/// subscribe to events of this node (and whole subtree if `deep` is set)
+	/// events are delivered asynchronously in batches: all events that happen while callback
+	/// is busy are passed in next call, repeating renames & status changes of link are merged
+	/// if more than `capacity` events are waiting, rest are dropped and `Event::Overflow` is delivered
+	/// returns subscription ID
+	auto subscribe(
+		events_f f, Event filter = Event::All, bool deep = true, std::size_t capacity = 4096
+	) -> std::uint64_t;
+	/// stop receiving events, returns false if subscription isn't found
+	auto unsubscribe(std::uint64_t subscription_id) -> bool;
 
 	/// ctor - creates hard self link with given name
-	node(std::string custom_id = "");
+	node(std::string custom_id = "", Indexes idx = Indexes::All);
 	// copy ctor makes deep copy of contained links
 	node(const node& src);
 
@@ -275,6 +446,12 @@ public:
 private:
 	friend class blue_sky::atomizer;
 	friend class link;
+	friend class batch;
+	friend class query;
+	friend class snapshot;
+	friend class mutation_log;
+	friend struct detail::path_cache;
+	friend void blue_sky::detail::adjust_cloned_node(const sp_obj&);
 	// PIMPL
 	class node_impl;
 	std::unique_ptr< node_impl > pimpl_;
@@ -300,7 +477,9 @@ private:
 	std::vector<Key_type<Key::OID>> keys(Key_const<Key::OID>) const;
 	std::vector<Key_type<Key::Type>> keys(Key_const<Key::Type>) const;
 
-	auto on_rename(const id_type& renamed_lnk) const -> void;
+	auto on_rename(const id_type& renamed_lnk, const std::string& old_name) const -> void;
+	auto on_status_changed(const sp_link& lnk, link::Req req, link::ReqStatus prev) const -> void;
+	auto on_data_changed(const sp_link& lnk) const -> void;
 
 	BS_TYPE_DECL
 };
@@ -312,4 +491,5 @@ NAMESPACE_END(blue_sky::tree)
 
 // allow bitwise operations for InsertPoiicy enum class
 BS_ALLOW_ENUMOPS(blue_sky::tree::node::InsertPolicy)
+BS_ALLOW_ENUMOPS(blue_sky::tree::node::Indexes)
 
@@ -0,0 +1,73 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Query links in subtree with filters that are pushed down to node indexes
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#pragma once
+
+#include "node.h"
+
+#include <functional>
+#include <optional>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// Search for links in subtree, for example:
+/// `tree::query(root).type("bs_person").name_glob("Citizen_*").where(pred).limit(n).for_each(f)`
+/// Name, OID and type filters are resolved using indexes of every visited node,
+/// glob pattern with literal prefix uses range of Name index.
+/// Only subtrees owned by links are visited (sym links aren't followed), so every link is found once.
+class BS_API query {
+public:
+	using predicate_f = std::function<bool(const sp_link&)>;
+	/// receives found links, return false to stop query
+	using consumer_f = std::function<bool(const sp_link&)>;
+
+	explicit query(sp_node root);
+	explicit query(const sp_link& root);
+
+	/// link name must be equal to given
+	auto name(std::string link_name) -> query&;
+	/// link name must match pattern that can contain '*' and '?' wildcards
+	auto name_glob(std::string pattern) -> query&;
+	/// pointed object must be of given type
+	auto type(std::string obj_type_id) -> query&;
+	/// pointed object must have given ID
+	auto oid(std::string obj_id) -> query&;
+	/// arbitrary predicate that is checked after all other filters
+	auto where(predicate_f pred) -> query&;
+
+	/// stop after `n` results
+	auto limit(std::size_t n) -> query&;
+	/// don't go deeper than given level, 0 means only root's leafs
+	auto max_depth(std::size_t depth) -> query&;
+	/// visit nodes behind lazy links that aren't loaded yet
+	auto follow_lazy_links(bool on = true) -> query&;
+	/// process subtrees in parallel, predicates must be thread-safe then
+	/// consumer is never called concurrently
+	auto parallel(bool on = true) -> query&;
+
+	/// pass found links to consumer as soon as they are found, returns number of results
+	auto for_each(consumer_f f) const -> std::size_t;
+	/// collect all results
+	auto collect() const -> std::vector<sp_link>;
+	/// first found link or nullptr
+	auto first() const -> sp_link;
+	/// number of links that match query
+	auto count() const -> std::size_t;
+
+private:
+	struct runner;
+
+	sp_node root_;
+	std::optional<std::string> name_, name_glob_, type_, oid_;
+	std::vector<predicate_f> where_;
+	std::size_t limit_ = std::size_t(-1), max_depth_ = std::size_t(-1);
+	bool follow_lazy_ = false, parallel_ = false;
+};
+
+NAMESPACE_END(blue_sky::tree)
@@ -0,0 +1,100 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Link that mounts subtree published by another BS process
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "link.h"
+#include "node.h"
+#include "../timetypes.h"
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/*-----------------------------------------------------------------------------
+ *  Server side
+ *-----------------------------------------------------------------------------*/
+/// publish subtree pointed by `root` at given TCP port, so it can be mounted by `remote_link`
+/// pass zero port to pick any free one, returns actual port
+/// server listens only at `host` address (loopback by default), empty host means all interfaces
+/// [NOTE] server has no authentication, anyone who can connect can read published subtree
+BS_API auto publish(
+	sp_link root, std::uint16_t port = 0, const std::string& host = "127.0.0.1", bool reuse_addr = false
+) -> result_or_err<std::uint16_t>;
+/// stop serving subtree published at `port`
+BS_API auto unpublish(std::uint16_t port) -> error;
+
+/*-----------------------------------------------------------------------------
+ *  Remote link proxies link of published subtree.
+ *  `data_node()` fetches listing of all children in single request and fills local node
+ *  with remote links to them. Metadata of children (name, OID, object type) is cached,
+ *  so it's available without network requests. Object is pulled by `data()` and cached too.
+ *  Nested remote links share single connection to server.
+ *-----------------------------------------------------------------------------*/
+class BS_API remote_link : public link {
+	friend class blue_sky::atomizer;
+
+public:
+	/// mount root of subtree published at `host:port`
+	/// connection is established lazily on first request
+	remote_link(
+		std::string name, std::string host, std::uint16_t port,
+		timespan timeout = std::chrono::seconds(10), Flags f = Plain
+	);
+	/// mount link at `remote_path` (by IDs) relative to published root
+	remote_link(
+		std::string name, std::string host, std::uint16_t port, std::string remote_path,
+		timespan timeout = std::chrono::seconds(10), Flags f = Plain
+	);
+	~remote_link();
+
+	auto clone(bool deep = false) const -> sp_link override;
+
+	// link API implementation
+	auto type_id() const -> std::string override;
+	// return cached metadata, never make network requests
+	auto oid() const -> std::string override;
+	auto obj_type_id() const -> std::string override;
+
+	/// server address
+	auto host() const -> const std::string&;
+	auto port() const -> std::uint16_t;
+	auto timeout() const -> timespan;
+	/// path (by IDs) of pointed link relative to published root
+	auto remote_path() const -> const std::string&;
+	/// true if pointed remote object is a node (known after parent is listed)
+	auto is_node() const -> bool;
+
+	/// resolve path relative to this link on server side and return remote link to found target
+	auto deref_path(const std::string& path, node::Key path_unit = node::Key::ID) const
+	-> result_or_err<sp_link>;
+	/// list remote subtree down to `depth` levels
+	/// listings of all nodes at one level are requested without waiting for each other
+	auto populate(std::size_t depth = 1) const -> error;
+	/// drop cached object and listing, next `data()` or `data_node()` will reach server
+	auto refresh() -> void;
+
+	/// cached object (nullptr if not fetched yet)
+	auto cache() const -> sp_obj;
+
+private:
+	struct impl;
+	std::unique_ptr<impl> pimpl_;
+
+	// construct remote link to child of already mounted node
+	remote_link(std::unique_ptr<impl> pimpl, std::string name, Flags f);
+
+	// pull object from server, for nodes same as `data_node_impl()`
+	auto data_impl() const -> result_or_err<sp_obj> override;
+	// fetch children listing and make local node
+	auto data_node_impl() const -> result_or_err<sp_node> override;
+	// only set handle of already fetched node, never reach server
+	auto propagate_handle() -> result_or_err<sp_node> override;
+};
+using sp_remote_link = std::shared_ptr<remote_link>;
+using sp_cremote_link = std::shared_ptr<const remote_link>;
+
+NAMESPACE_END(blue_sky::tree)
@@ -0,0 +1,54 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Consistent point-in-time view of subtree
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "node.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// Snapshot is taken in O(1): it only remembers new epoch number.
+/// Every node that is changed after that first saves it's links list (copy-on-write),
+/// so readers of snapshot see subtree exactly as it was, while writers continue.
+/// Unchanged nodes are shared with live tree, saved versions are dropped when last snapshot
+/// that can see them is destroyed.
+/// [NOTE] only structure (links & their names) is versioned, objects themselves are shared
+class BS_API snapshot {
+public:
+	/// link with name it had when snapshot was taken
+	struct leaf {
+		sp_link link;
+		std::string name;
+	};
+	using leafs_t = std::shared_ptr<const std::vector<leaf>>;
+	using epoch_t = std::uint64_t;
+
+	explicit snapshot(sp_node root);
+	explicit snapshot(const sp_link& root);
+
+	auto root() const -> const sp_node&;
+	auto epoch() const -> epoch_t;
+
+	/// links of node in the moment of snapshot
+	auto leafs(const sp_node& N) const -> leafs_t;
+
+	/// visit every node of subtree in depth-first order, sym links aren't followed
+	using step_f = std::function<void(const sp_node&, const std::vector<leaf>&)>;
+	auto walk(step_f f) const -> void;
+
+private:
+	struct state;
+	std::shared_ptr<const state> state_;
+};
+
+NAMESPACE_END(blue_sky::tree)
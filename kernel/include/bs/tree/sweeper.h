@@ -0,0 +1,82 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Background removal of weak links whose target has expired
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "node.h"
+
+#include <chrono>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/// what sweeper does with dead weak link
+enum class SweepAction {
+	Erase,    ///< remove link from it's node
+	Tombstone ///< only set `link::Tombstone` flag, marked links are removed later by `compact()`
+};
+
+struct sweep_policy {
+	/// interval between full scans of subtree, zero disables periodic scans
+	std::chrono::milliseconds period = std::chrono::seconds(10);
+	/// max number of links removed by single batch commit
+	/// also number of expiry notifications that triggers sweep before next scan
+	std::size_t batch_size = 1024;
+	SweepAction action = SweepAction::Erase;
+	/// sweep links which `data()` call failed because target is expired
+	bool on_expiry = true;
+	/// scan subtrees in parallel
+	bool parallel = false;
+	/// log stats of every pass
+	bool log_stats = false;
+};
+
+struct sweep_stats {
+	/// number of full scans & sweeps of reported links
+	std::size_t scans = 0, sweeps = 0;
+	std::size_t links_scanned = 0;
+	std::size_t erased = 0, tombstoned = 0;
+	std::size_t batches = 0;
+	std::chrono::nanoseconds time_spent{0};
+
+	auto operator+=(const sweep_stats& rhs) -> sweep_stats&;
+};
+
+/// Finds weak links with expired targets in subtree pointed by `root` and removes them in batches.
+/// Runs in background thread: does full scan every `period` and sweeps links reported by
+/// failed `weak_link::data()` calls as soon as `batch_size` of them are collected.
+/// Stops when destroyed.
+class BS_API weak_sweeper {
+public:
+	weak_sweeper(sp_link root, sweep_policy policy = {});
+	~weak_sweeper();
+
+	auto policy() const -> sweep_policy;
+	auto set_policy(sweep_policy policy) -> void;
+
+	/// scan subtree and sweep dead links right now, returns stats of this pass
+	auto sweep() -> sweep_stats;
+	/// erase links marked as tombstones, returns stats of this pass
+	auto compact() -> sweep_stats;
+
+	/// accumulated stats of all passes
+	auto stats() const -> sweep_stats;
+	auto reset_stats() -> void;
+
+	/// single sweep of subtree without background thread
+	static auto sweep(const sp_link& root, const sweep_policy& policy = {}) -> sweep_stats;
+
+private:
+	friend class weak_link;
+	struct impl;
+	std::shared_ptr<impl> pimpl_;
+
+	// called by weak link which target is found expired
+	static auto on_expired(const link& L) -> void;
+};
+
+NAMESPACE_END(blue_sky::tree)
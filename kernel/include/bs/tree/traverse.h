@@ -0,0 +1,66 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Iterative traversal of tree that can't overflow call stack
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include "node.h"
+#include "../detail/function_view.h"
+
+#include <list>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+enum class TraverseOrder {
+	PreOrder,  ///< node is visited before it's subtree
+	PostOrder, ///< node is visited after it's subtree
+	BFS        ///< nodes are visited level by level
+};
+
+/// what traversal does after visit
+enum class TraverseStep {
+	Continue, ///< go on
+	Skip,     ///< don't enter visited node's subtree (no effect in post-order)
+	Stop      ///< stop whole traversal
+};
+
+struct traverse_opts {
+	TraverseOrder order = TraverseOrder::PreOrder;
+	/// enter nodes pointed by sym links
+	/// in DFS sym link isn't entered if it's already on path from root (that cuts cycles),
+	/// in BFS every sym link is entered once
+	bool follow_symlinks = true;
+	/// enter lazy links that aren't loaded yet
+	bool follow_lazy_links = false;
+	/// fill `nodes` & `leafs` of frame before it's visited
+	/// otherwise only links to nested nodes are collected after visit (before it in post-order)
+	bool list_links = false;
+};
+
+/// visited link
+struct traverse_frame {
+	/// link to visited node (root frame started from node holds it's handle)
+	sp_link link;
+	/// node pointed by link, null if link isn't a node or can't be entered
+	sp_node node;
+	/// root has depth 0
+	std::size_t depth = 0;
+	/// links to nested nodes that are visited next, visitor can change list in pre-order & BFS
+	std::list<sp_link> nodes;
+	/// rest of node's links, collected only if `traverse_opts::list_links` is set
+	std::vector<sp_link> leafs;
+};
+
+using traverse_fv = function_view<TraverseStep (traverse_frame&)>;
+
+/// visit `root` and every nested node using explicit stack (DFS) or queue (BFS),
+/// so that depth of tree is limited only by available memory
+/// returns false if traversal was stopped by visitor
+BS_API auto traverse(const sp_link& root, traverse_fv f, const traverse_opts& opts = {}) -> bool;
+BS_API auto traverse(const sp_node& root, traverse_fv f, const traverse_opts& opts = {}) -> bool;
+
+NAMESPACE_END(blue_sky::tree)
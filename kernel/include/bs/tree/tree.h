@@ -11,7 +11,15 @@
 
 #include "link.h"
 #include "fusion.h"
+#include "remote_link.h"
 #include "node.h"
+#include "query.h"
+#include "snapshot.h"
+#include "batch.h"
+#include "mutation_log.h"
+#include "cancel_token.h"
+#include "sweeper.h"
+#include "traverse.h"
 #include "errors.h"
 #include "../detail/function_view.h"
 
@@ -58,6 +66,30 @@ BS_API sp_link deref_path(
 	bool follow_lazy_links = true
 );
 
+/// resolve batch of paths relative to `start` (or absolute)
+/// paths are merged into prefix tree, so shared prefixes are dereferenced once
+/// and different tails are resolved in parallel (if `parallel` is set)
+/// returns links in the same order as paths, unresolved paths give nullptr
+BS_API auto deref_paths(
+	const std::vector<std::string>& paths, sp_link start, node::Key path_unit = node::Key::ID,
+	bool follow_lazy_links = true, bool parallel = true
+) -> std::vector<sp_link>;
+
+/// resolve path which levels are glob patterns of link names, like "/results/*/mesh/*_final"
+/// '*' matches any sequence of chars, '?' - any single char, patterns don't span over '/'
+/// levels matched by several links are resolved in parallel (if `parallel` is set)
+/// found links are passed to `f` as soon as they are found (never concurrently), return false to stop
+/// returns number of found links
+using glob_process_f = std::function<bool(const sp_link&)>;
+BS_API auto deref_glob(
+	const std::string& pattern, sp_link start, glob_process_f f,
+	bool follow_lazy_links = true, bool parallel = true
+) -> std::size_t;
+/// collect all links matching pattern
+BS_API auto deref_glob(
+	const std::string& pattern, sp_link start, bool follow_lazy_links = true, bool parallel = true
+) -> std::vector<sp_link>;
+
 /// walk the tree just like the Python's `os.walk` is implemented
 using step_process_fv = function_view<void (const sp_link&, std::list<sp_link>&, std::vector<sp_link>&)>;
 BS_API void walk(
@@ -76,6 +108,22 @@ BS_API auto deref_path(
 	std::string path, sp_link start, node::Key path_unit = node::Key::ID,
 	bool follow_lazy_links = true, bool high_priority = false
 ) -> void;
+/// request is dropped if `token` is cancelled or expired before execution (`f` then receives nullptr)
+/// token is also checked when walk goes down to next level
+BS_API auto deref_path(
+	deref_process_f f, cancel_token token,
+	std::string path, sp_link start, node::Key path_unit = node::Key::ID,
+	bool follow_lazy_links = true, bool high_priority = false
+) -> void;
+
+/// deferred `deref_paths`, all results are passed to callback at once
+using deref_paths_process_f = std::function<void(std::vector<sp_link>)>;
+
+BS_API auto deref_paths(
+	deref_paths_process_f f,
+	std::vector<std::string> paths, sp_link start, node::Key path_unit = node::Key::ID,
+	bool follow_lazy_links = true, bool high_priority = false
+) -> void;
 
 /*-----------------------------------------------------------------------------
  *  Misc utility functions
@@ -109,6 +157,8 @@ BS_API auto make_root_link(
 //  Tree save/load to JSON or binary archive
 //
 enum class TreeArchive { Text, Binary, FS };
+/// archives store nested nodes nested, so unlike copy, walk & destruction
+/// save & load recurse over tree depth and very deep chains may exhaust stack
 BS_API auto
 	save_tree(const sp_link& root, const std::string& filename, TreeArchive ar = TreeArchive::Text)
 -> error;
@@ -35,6 +35,10 @@ void py_bind_error(py::module& m) {
 		.value("LinkBusy", tree::Error::LinkBusy)
 		.value("NoFusionBridge", tree::Error::NoFusionBridge)
 		.value("KeyMismatch", tree::Error::KeyMismatch)
+		.value("LinkRejected", tree::Error::LinkRejected)
+		.value("RemoteUnreachable", tree::Error::RemoteUnreachable)
+		.value("RequestCancelled", tree::Error::RequestCancelled)
+		.value("QueueOverflow", tree::Error::QueueOverflow)
 	;
 
 	/*-----------------------------------------------------------------------------
@@ -11,6 +11,7 @@
 #include <bs/python/tree.h>
 #include <bs/tree/link.h>
 #include <bs/tree/node.h>
+#include <bs/tree/remote_link.h>
 #include "../kernel/python_subsyst_impl.h"
 
 #include <boost/uuid/uuid_io.hpp>
@@ -51,6 +52,20 @@ auto adapt(adapted_data_cb&& f) {
 NAMESPACE_END()
 
 void py_bind_link(py::module& m) {
+	///////////////////////////////////////////////////////////////////////////////
+	//  cancel token
+	//
+	py::class_<cancel_token>(m, "cancel_token")
+		.def(py::init<>())
+		.def(py::init<cancel_token::clock::duration>(), "timeout"_a)
+		.def("cancel", &cancel_token::cancel)
+		.def_property_readonly("is_cancelled", &cancel_token::is_cancelled)
+		.def("check", &cancel_token::check,
+			"Returns error with RequestCancelled code if token is cancelled or expired")
+		.def_static("current", &cancel_token::current, py::return_value_policy::copy,
+			"Token of request executing in calling thread")
+	;
+
 	///////////////////////////////////////////////////////////////////////////////
 	//  inode
 	//
@@ -73,6 +88,7 @@ void py_bind_link(py::module& m) {
 	py::enum_<link::Flags>(link_pyface, "Flags", py::arithmetic())
 		.value("Persistent", link::Flags::Persistent)
 		.value("Disabled", link::Flags::Disabled)
+		.value("Tombstone", link::Flags::Tombstone)
 		.export_values()
 	;
 	py::implicitly_convertible<int, link::Flags>();
@@ -89,6 +105,20 @@ void py_bind_link(py::module& m) {
 		.value("OK", link::ReqStatus::OK)
 		.value("Error", link::ReqStatus::Error)
 	;
+	// async requests queue limits
+	py::enum_<link::Overflow>(link_pyface, "Overflow")
+		.value("Reject", link::Overflow::Reject)
+		.value("Coalesce", link::Overflow::Coalesce)
+		.value("Block", link::Overflow::Block)
+	;
+	py::class_<link::queue_limits>(link_pyface, "queue_limits")
+		.def(py::init([](std::size_t per_link, std::size_t total, link::Overflow policy) {
+			return link::queue_limits{per_link, total, policy};
+		}), "per_link"_a = 0, "total"_a = 0, "policy"_a = link::Overflow::Reject)
+		.def_readwrite("per_link", &link::queue_limits::per_link)
+		.def_readwrite("total", &link::queue_limits::total)
+		.def_readwrite("policy", &link::queue_limits::policy)
+	;
 
 	// link base class
 	link_pyface
@@ -104,12 +134,20 @@ void py_bind_link(py::module& m) {
 				return L.data(adapt(std::move(f)), high_priority);
 			}, "f"_a, "high_priority"_a = false
 		)
+		.def("data", [](const link& L, adapted_data_cb f, cancel_token token, bool high_priority) {
+				return L.data(adapt(std::move(f)), std::move(token), high_priority);
+			}, "f"_a, "token"_a, "high_priority"_a = false
+		)
 
 		.def("data_node_ex", &link::data_node_ex, "wait_if_busy"_a = true)
 		.def("data_node", py::overload_cast<>(&link::data_node, py::const_))
 		.def("data_node", py::overload_cast<link::process_data_cb, bool>(&link::data_node, py::const_),
 			"f"_a, "high_priority"_a = false
 		)
+		.def("data_node",
+			py::overload_cast<link::process_data_cb, cancel_token, bool>(&link::data_node, py::const_),
+			"f"_a, "token"_a, "high_priority"_a = false
+		)
 
 		.def("type_id", &link::type_id)
 		.def("oid", &link::oid)
@@ -129,6 +167,9 @@ void py_bind_link(py::module& m) {
 			"Set status of given request if it is NOT equal to given value, returns prev status"
 		)
 
+		.def("notify_data_changed", &link::notify_data_changed,
+			"Tell owner's subscribers that pointed object was modified or replaced")
+
 		.def_property_readonly("id", [](const link& L) {
 			return boost::uuids::to_string(L.id());
 		})
@@ -136,6 +177,19 @@ void py_bind_link(py::module& m) {
 		.def_property_readonly("owner", &link::owner)
 		.def_property_readonly("info", &link::info)
 		.def_property("flags", &link::flags, &link::set_flags)
+
+		.def_static("intern_names", &link::intern_names, "on"_a,
+			"Store names of links created after this call in global pool, equal names share one string"
+		)
+		.def_static("interning_names", &link::interning_names)
+
+		.def_static("set_queue_limits", &link::set_queue_limits, "limits"_a,
+			"Bound queues of async requests to all links"
+		)
+		.def_static("get_queue_limits", &link::get_queue_limits)
+		.def_property_readonly("queue_depth", &link::queue_depth)
+		.def_static("total_queue_depth", &link::total_queue_depth)
+		.def_static("blocked_senders", &link::blocked_senders)
 	;
 
 	// export adapters manip functions
@@ -175,6 +229,7 @@ void py_bind_link(py::module& m) {
 	py::class_<weak_link, link, std::shared_ptr<weak_link>>(m, "weak_link")
 		.def(py::init<std::string, const sp_obj&, link::Flags>(),
 			"name"_a, "data"_a, "flags"_a = link::Flags::Plain)
+		.def_property_readonly("expired", &weak_link::expired)
 	;
 
 	py::class_<sym_link, link, std::shared_ptr<sym_link>>(m, "sym_link")
@@ -204,8 +259,39 @@ void py_bind_link(py::module& m) {
 			py::overload_cast<link::process_data_cb, std::string>(&fusion_link::populate, py::const_),
 			"f"_a, "obj_type_id"_a
 		)
+		.def("populate",
+			py::overload_cast<link::process_data_cb, std::string, cancel_token>(&fusion_link::populate, py::const_),
+			"f"_a, "obj_type_id"_a, "token"_a
+		)
 	;
 
+	///////////////////////////////////////////////////////////////////////////////
+	//  remote link
+	//
+	py::class_<remote_link, link, std::shared_ptr<remote_link>>(m, "remote_link")
+		.def(py::init<std::string, std::string, std::uint16_t, timespan, link::Flags>(),
+			"name"_a, "host"_a, "port"_a, "timeout"_a = timespan(std::chrono::seconds(10)),
+			"flags"_a = link::Flags::Plain)
+		.def(py::init<std::string, std::string, std::uint16_t, std::string, timespan, link::Flags>(),
+			"name"_a, "host"_a, "port"_a, "remote_path"_a, "timeout"_a = timespan(std::chrono::seconds(10)),
+			"flags"_a = link::Flags::Plain)
+		.def_property_readonly("host", &remote_link::host)
+		.def_property_readonly("port", &remote_link::port)
+		.def_property_readonly("timeout", &remote_link::timeout)
+		.def_property_readonly("remote_path", &remote_link::remote_path)
+		.def_property_readonly("is_node", &remote_link::is_node)
+		.def("deref_path", &remote_link::deref_path, "path"_a, "path_unit"_a = node::Key::ID,
+			"Resolve path relative to this link on server side")
+		.def("populate", &remote_link::populate, "depth"_a = 1,
+			"List remote subtree down to given depth")
+		.def("refresh", &remote_link::refresh, "Drop cached object and listing")
+		.def("cache", &remote_link::cache)
+	;
+
+	m.def("publish", &tree::publish, "root"_a, "port"_a = 0, "host"_a = "127.0.0.1", "reuse_addr"_a = false,
+		"Publish subtree at given TCP port and host address (empty for all interfaces), returns actual port");
+	m.def("unpublish", &tree::unpublish, "port"_a, "Stop serving subtree published at given port");
+
 	py::class_<fusion_iface, py_fusion<>, std::shared_ptr<fusion_iface>>(m, "fusion_iface")
 		.def("populate", &fusion_iface::populate, "root"_a, "child_type_id"_a = "",
 			"Populate root object structure (children)")
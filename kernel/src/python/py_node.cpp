@@ -11,6 +11,7 @@
 #include <bs/tree/node.h>
 
 #include <boost/uuid/uuid_io.hpp>
+#include <boost/uuid/string_generator.hpp>
 #include <pybind11/functional.h>
 #include <pybind11/chrono.h>
 
@@ -24,6 +25,8 @@ using InsertPolicy = node::InsertPolicy;
  *-----------------------------------------------------------------------------*/
 NAMESPACE_BEGIN()
 
+static boost::uuids::string_generator uuid_from_str;
+
 // helpers to omit code duplication
 // ------- contains
 template<Key K>
@@ -139,10 +142,67 @@ void py_bind_node(py::module& m) {
 	;
 	//py::implicitly_convertible<int, InsertPolicy>();
 	//py::implicitly_convertible<long, InsertPolicy>();
+	// export set of node's secondary indexes
+	py::enum_<node::Indexes>(node_pyface, "Indexes", py::arithmetic())
+		.value("None", node::Indexes::None)
+		.value("Name", node::Indexes::Name)
+		.value("OID", node::Indexes::OID)
+		.value("Type", node::Indexes::Type)
+		.value("All", node::Indexes::All)
+	;
+	// node events
+	py::enum_<Event>(m, "Event", py::arithmetic())
+		.value("None", Event::None)
+		.value("LinkInserted", Event::LinkInserted)
+		.value("LinkErased", Event::LinkErased)
+		.value("LinkRenamed", Event::LinkRenamed)
+		.value("LinkStatusChanged", Event::LinkStatusChanged)
+		.value("LinkMoved", Event::LinkMoved)
+		.value("Overflow", Event::Overflow)
+		.value("DataChanged", Event::DataChanged)
+		.value("Reordered", Event::Reordered)
+		.value("All", Event::All)
+	;
+	py::class_<event>(m, "event")
+		.def_readonly("kind", &event::kind)
+		.def_readonly("link", &event::link)
+		.def_readonly("origin", &event::origin)
+		.def_readonly("source", &event::source)
+		.def_readonly("old_name", &event::old_name)
+		.def_readonly("req", &event::req)
+		.def_readonly("prev_status", &event::prev_status)
+	;
+
+	// subtree stats
+	py::class_<node::stats_t>(node_pyface, "stats_t")
+		.def(py::init<>())
+		.def_readonly("links", &node::stats_t::links)
+		.def_readonly("nodes", &node::stats_t::nodes)
+		.def_readonly("unloaded", &node::stats_t::unloaded)
+		.def_readonly("types", &node::stats_t::types)
+		.def_readonly("metrics", &node::stats_t::metrics)
+	;
+
+	// paged iteration
+	py::class_<node::cursor>(node_pyface, "cursor")
+		.def(py::init<>())
+		.def_readwrite("last_key", &node::cursor::last_key)
+		.def_readwrite("offset", &node::cursor::offset)
+		.def_readwrite("at_end", &node::cursor::at_end)
+		.def_property("last_id",
+			[](const node::cursor& c) { return to_string(c.last_id); },
+			[](node::cursor& c, const std::string& lid) { c.last_id = uuid_from_str(lid); }
+		)
+		.def_property("next_id",
+			[](const node::cursor& c) { return to_string(c.next_id); },
+			[](node::cursor& c, const std::string& lid) { c.next_id = uuid_from_str(lid); }
+		)
+	;
 
 	node_pyface
 		BSPY_EXPORT_DEF(node)
 		.def(py::init<>())
+		.def(py::init<std::string, node::Indexes>(), "custom_id"_a = "", "indexes"_a = node::Indexes::All)
 		.def("__len__", &node::size)
 		.def("__iter__",
 			[](const node& N) { return py::make_iterator(N.begin(), N.end()); },
@@ -201,6 +261,45 @@ void py_bind_node(py::module& m) {
 		.def("deep_search_name", &deep_search<Key::Name>, "link_name"_a, "Deep search for link with given name")
 		// deep search by object ID
 		.def("deep_search_oid", &deep_search<Key::OID>, "oid"_a, "Deep search for link to object with given ID")
+		.def("enable_summary", &node::enable_summary, "on"_a = true,
+			"Maintain summary of keys in subtree that lets deep search skip subtrees without searched key"
+		)
+		.def("may_contain", &node::may_contain, "key"_a, "key_meaning"_a = Key::Name,
+			"Check if subtree can contain link with given key (False means it's definitely not there)"
+		)
+		.def("enable_stats", &node::enable_stats, "on"_a = true,
+			"Maintain stats of subtree (links & nodes count, objects per type, registered metrics)"
+		)
+		.def("stats", &node::stats, "Read stats of subtree")
+		.def("sort", &node::sort, "less"_a, "persistent"_a = true,
+			"Stable sort of custom order in place, persistent order is maintained on later changes"
+		)
+		.def("is_sorted", &node::is_sorted, "Check if custom order is maintained sorted")
+		.def_static("natural_order", &node::natural_order,
+			"Order of names where digit sequences are compared as numbers"
+		)
+		.def_static("mod_time_order", &node::mod_time_order, "Order by modification time of link's inode")
+		.def_property_readonly("generation", &node::generation,
+			"Generation of last change of node's links (comparable with `current_generation()`)"
+		)
+		.def_property_readonly("subtree_generation", &node::subtree_generation,
+			"Generation of last change in whole subtree (first access turns on tracking)"
+		)
+		.def_static("current_generation", &node::current_generation, "Latest generation assigned to any node")
+		.def("subscribe", &node::subscribe,
+			"f"_a, "filter"_a = Event::All, "deep"_a = true, "capacity"_a = 4096,
+			"Subscribe to node (or subtree) events that are passed to `f` in batches"
+		)
+		.def("unsubscribe", &node::unsubscribe, "subscription_id"_a)
+		.def("page", [](const node& N, Key order, const node::cursor& from, std::size_t n) {
+			auto res = N.page(order, from, n);
+			return py::make_tuple(std::move(res.links), std::move(res.next));
+		}, "order"_a = Key::AnyOrder, "from"_a = node::cursor{}, "n"_a = 1024,
+			"Return tuple of up to `n` links that follow cursor in given order and cursor to next page"
+		)
+		.def_static("register_metric", &node::register_metric, "name"_a, "f"_a,
+			"Register additive metric that is calculated for every link owning an object"
+		)
 
 		.def("equal_range", [](const node& N, const std::string& link_name) {
 			auto r = N.equal_range(link_name);
@@ -228,6 +327,25 @@ void py_bind_node(py::module& m) {
 			return N.insert(std::move(name), std::move(obj), pol).second;
 		}, "name"_a, "obj"_a, "pol"_a = InsertPolicy::AllowDupNames, "Insert hard link to given object")
 
+		// move given link to another node
+		.def("move", [](node& N, const sp_link& l, const sp_node& dst, InsertPolicy pol) {
+			return N.move(l->id(), dst, pol).second;
+		}, "link"_a, "dst"_a, "pol"_a = InsertPolicy::AllowDupNames, "Move given link to `dst` node")
+		// ... and place it at given index
+		.def("move", [](node& N, const sp_link& l, const sp_node& dst, std::size_t idx, InsertPolicy pol) {
+			return N.move(l->id(), dst, idx, pol).second;
+		}, "link"_a, "dst"_a, "idx"_a, "pol"_a = InsertPolicy::AllowDupNames,
+			"Move given link to `dst` node and place it at given index")
+		// bulk move of links with given IDs
+		.def("move", [](node& N, const std::vector<std::string>& lids, const sp_node& dst, std::size_t idx, InsertPolicy pol) {
+			std::vector<node::id_type> ids;
+			ids.reserve(lids.size());
+			for(const auto& lid : lids)
+				ids.push_back(uuid_from_str(lid));
+			return N.move(ids, dst, idx, pol);
+		}, "lids"_a, "dst"_a, "idx"_a = std::size_t(-1), "pol"_a = InsertPolicy::AllowDupNames,
+			"Move links with given IDs to `dst` node preserving their order, returns number of moved links")
+
 		// erase by given index
 		.def("__delitem__", &erase_idx, "idx"_a)
 		.def("erase",       &erase_idx, "idx"_a, "Erase link with given index")
@@ -304,9 +422,16 @@ void py_bind_node(py::module& m) {
 		.def_property_readonly("handle", &node::handle,
 			"Returns a single link that owns this node in overall tree"
 		)
-		.def("propagate_owner", &node::propagate_owner, "deep"_a = false,
+		.def("propagate_owner", &node::propagate_owner, "deep"_a = false, "parallel"_a = true,
+			py::call_guard<py::gil_scoped_release>(),
 			"Set owner of all contained links to this node (if deep, fix owner in entire subtree)"
 		)
+		.def_property("indexes", &node::indexes, &node::set_indexes,
+			"Secondary indexes that are updated on every insert, other keys are searched by scanning links until first range query builds their index"
+		)
+		.def("clone", &node::clone, "parallel"_a = true,
+			"Make deep copy of node, if `parallel` is set sibling subtrees are cloned concurrently"
+		)
 	;
 }
 
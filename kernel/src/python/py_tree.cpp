@@ -67,6 +67,38 @@ void py_bind_tree(py::module& m) {
 		"follow_lazy_links"_a = true, "high_priority"_a = false,
 		"Async quick link search by given path relative to `start`"
 	);
+	m.def("deref_path",
+		py::overload_cast<deref_process_f, cancel_token, std::string, sp_link, Key, bool, bool>(&deref_path),
+		"deref_cb"_a, "token"_a, "path"_a, "start"_a, "path_unit"_a = Key::ID,
+		"follow_lazy_links"_a = true, "high_priority"_a = false,
+		"Async link search that is dropped when `token` is cancelled or expired"
+	);
+	// deref_paths
+	m.def("deref_paths",
+		py::overload_cast<const std::vector<std::string>&, sp_link, Key, bool, bool>(&deref_paths),
+		"paths"_a, "start"_a, "path_unit"_a = Key::ID, "follow_lazy_links"_a = true, "parallel"_a = true,
+		py::call_guard<py::gil_scoped_release>(),
+		"Resolve batch of paths relative to `start`, shared prefixes are walked once"
+	);
+	m.def("deref_paths",
+		py::overload_cast<deref_paths_process_f, std::vector<std::string>, sp_link, Key, bool, bool>(&deref_paths),
+		"deref_cb"_a, "paths"_a, "start"_a, "path_unit"_a = Key::ID,
+		"follow_lazy_links"_a = true, "high_priority"_a = false,
+		"Async resolve batch of paths, callback receives all results at once"
+	);
+	// deref_glob
+	m.def("deref_glob",
+		py::overload_cast<const std::string&, sp_link, glob_process_f, bool, bool>(&deref_glob),
+		"pattern"_a, "start"_a, "f"_a, "follow_lazy_links"_a = true, "parallel"_a = true,
+		py::call_guard<py::gil_scoped_release>(),
+		"Pass links matching glob path pattern (levels can contain '*' and '?') to `f`"
+	);
+	m.def("deref_glob",
+		py::overload_cast<const std::string&, sp_link, bool, bool>(&deref_glob),
+		"pattern"_a, "start"_a, "follow_lazy_links"_a = true, "parallel"_a = true,
+		py::call_guard<py::gil_scoped_release>(),
+		"Find all links matching glob path pattern (levels can contain '*' and '?')"
+	);
 
 	// bind list of links as opaque type 
 	using v_links = std::vector<sp_link>;
@@ -97,6 +129,181 @@ void py_bind_tree(py::module& m) {
 		"Walk the tree similar to Python `os.walk()`"
 	);
 
+	// traverse
+	py::enum_<TraverseOrder>(m, "TraverseOrder")
+		.value("PreOrder", TraverseOrder::PreOrder)
+		.value("PostOrder", TraverseOrder::PostOrder)
+		.value("BFS", TraverseOrder::BFS)
+	;
+	py::enum_<TraverseStep>(m, "TraverseStep")
+		.value("Continue", TraverseStep::Continue)
+		.value("Skip", TraverseStep::Skip)
+		.value("Stop", TraverseStep::Stop)
+	;
+	py::class_<traverse_frame>(m, "traverse_frame")
+		.def_readonly("link", &traverse_frame::link)
+		.def_readonly("node", &traverse_frame::node)
+		.def_readonly("depth", &traverse_frame::depth)
+		.def_readwrite("nodes", &traverse_frame::nodes, py::return_value_policy::reference_internal)
+		.def_readwrite("leafs", &traverse_frame::leafs, py::return_value_policy::reference_internal)
+	;
+	using py_traverse_cb = std::function<TraverseStep(traverse_frame&)>;
+	m.def("traverse",
+		[](
+			const sp_link& root, py_traverse_cb pyf, TraverseOrder order, bool follow_symlinks,
+			bool follow_lazy_links, bool list_links
+		) {
+			return traverse(
+				root, [&](traverse_frame& F) { return pyf(F); },
+				{order, follow_symlinks, follow_lazy_links, list_links}
+			);
+		},
+		"root"_a, "f"_a, "order"_a = TraverseOrder::PreOrder, "follow_symlinks"_a = true,
+		"follow_lazy_links"_a = false, "list_links"_a = false,
+		"Visit every node in subtree without recursion, `f(frame)` returns `TraverseStep`"
+	);
+
+	// query
+	// [NOTE] release GIL while query runs, Python callbacks acquire it when called from worker threads
+	py::class_<query>(m, "query")
+		.def(py::init<sp_node>(), "root"_a)
+		.def(py::init<const sp_link&>(), "root"_a)
+		.def("name", &query::name, "link_name"_a, py::return_value_policy::reference_internal)
+		.def("name_glob", &query::name_glob, "pattern"_a, py::return_value_policy::reference_internal)
+		.def("type", &query::type, "obj_type_id"_a, py::return_value_policy::reference_internal)
+		.def("oid", &query::oid, "obj_id"_a, py::return_value_policy::reference_internal)
+		.def("where", &query::where, "pred"_a, py::return_value_policy::reference_internal)
+		.def("limit", &query::limit, "n"_a, py::return_value_policy::reference_internal)
+		.def("max_depth", &query::max_depth, "depth"_a, py::return_value_policy::reference_internal)
+		.def("follow_lazy_links", &query::follow_lazy_links, "on"_a = true,
+			py::return_value_policy::reference_internal)
+		.def("parallel", &query::parallel, "on"_a = true, py::return_value_policy::reference_internal)
+		.def("for_each", &query::for_each, "f"_a, py::call_guard<py::gil_scoped_release>(),
+			"Pass found links to `f` as soon as they are found, stop if `f` returns False"
+		)
+		.def("collect", &query::collect, py::call_guard<py::gil_scoped_release>())
+		.def("first", &query::first, py::call_guard<py::gil_scoped_release>())
+		.def("count", &query::count, py::call_guard<py::gil_scoped_release>())
+	;
+
+	// snapshot
+	py::class_<snapshot> snap(m, "snapshot");
+
+	py::class_<snapshot::leaf>(snap, "leaf")
+		.def_readonly("link", &snapshot::leaf::link)
+		.def_readonly("name", &snapshot::leaf::name)
+	;
+
+	snap
+		.def(py::init<sp_node>(), "root"_a)
+		.def(py::init<const sp_link&>(), "root"_a)
+		.def_property_readonly("root", &snapshot::root)
+		.def_property_readonly("epoch", &snapshot::epoch)
+		.def("leafs", [](const snapshot& self, const sp_node& N) { return *self.leafs(N); }, "node"_a,
+			"Links of node in the moment of snapshot"
+		)
+		.def("walk", &snapshot::walk, "step_f"_a, py::call_guard<py::gil_scoped_release>(),
+			"Visit every node of subtree in depth-first order"
+		)
+	;
+
+	// batch
+	py::class_<batch>(m, "batch")
+		.def(py::init<>())
+		.def("insert", py::overload_cast<sp_node, sp_link, batch::InsertPolicy>(&batch::insert),
+			"dst"_a, "link"_a, "pol"_a = batch::InsertPolicy::AllowDupNames,
+			py::return_value_policy::reference_internal)
+		.def("insert", py::overload_cast<sp_node, std::string, sp_obj, batch::InsertPolicy>(&batch::insert),
+			"dst"_a, "name"_a, "obj"_a, "pol"_a = batch::InsertPolicy::AllowDupNames,
+			py::return_value_policy::reference_internal)
+		.def("erase", &batch::erase, "node"_a, "lid"_a, py::return_value_policy::reference_internal)
+		.def("rename", &batch::rename, "node"_a, "lid"_a, "new_name"_a,
+			py::return_value_policy::reference_internal)
+		.def("move", &batch::move, "src"_a, "lid"_a, "dst"_a, "pol"_a = batch::InsertPolicy::AllowDupNames,
+			py::return_value_policy::reference_internal)
+		.def("commit", &batch::commit, py::call_guard<py::gil_scoped_release>(),
+			"Apply all pending operations in single transaction"
+		)
+		.def("abort", &batch::abort, "Drop pending operations")
+		.def("__len__", &batch::size)
+		.def_property_readonly("empty", &batch::empty)
+	;
+
+	// mutations log
+	py::class_<mutation_log>(m, "mutation_log")
+		.def(py::init<sp_link, std::string, std::size_t>(),
+			"root"_a, "filename"_a, "capacity"_a = 65536)
+		.def_property_readonly("filename", &mutation_log::filename)
+		.def_property_readonly("last_seq", &mutation_log::last_seq)
+		.def("flush", &mutation_log::flush, py::call_guard<py::gil_scoped_release>(),
+			"Write all queued events to log")
+		.def("compact", py::overload_cast<const std::string&>(&mutation_log::compact),
+			"snapshot"_a, py::call_guard<py::gil_scoped_release>(),
+			"Fold log into snapshot and restart it"
+		)
+		.def_static("replay", &mutation_log::replay, "filename"_a, "root"_a, "after_seq"_a = 0,
+			py::call_guard<py::gil_scoped_release>(),
+			"Apply log records to subtree, returns seq of last applied record"
+		)
+		.def_static("compact", py::overload_cast<const std::string&, const std::string&>(&mutation_log::compact),
+			"snapshot"_a, "filename"_a, py::call_guard<py::gil_scoped_release>(),
+			"Load snapshot, replay log on top of it, save snapshot back and restart log"
+		)
+	;
+
+	py::class_<log_follower>(m, "log_follower")
+		.def(py::init<std::string, sp_link, std::uint64_t>(),
+			"filename"_a, "replica"_a, "after_seq"_a = 0)
+		.def("poll", &log_follower::poll, py::call_guard<py::gil_scoped_release>(),
+			"Apply records appended since previous call, returns number of applied records"
+		)
+		.def_property_readonly("last_seq", &log_follower::last_seq)
+	;
+
+	// weak links sweeper
+	py::enum_<SweepAction>(m, "SweepAction")
+		.value("Erase", SweepAction::Erase)
+		.value("Tombstone", SweepAction::Tombstone)
+	;
+
+	py::class_<sweep_policy>(m, "sweep_policy")
+		.def(py::init<>())
+		.def_readwrite("period", &sweep_policy::period)
+		.def_readwrite("batch_size", &sweep_policy::batch_size)
+		.def_readwrite("action", &sweep_policy::action)
+		.def_readwrite("on_expiry", &sweep_policy::on_expiry)
+		.def_readwrite("parallel", &sweep_policy::parallel)
+		.def_readwrite("log_stats", &sweep_policy::log_stats)
+	;
+
+	py::class_<sweep_stats>(m, "sweep_stats")
+		.def_readonly("scans", &sweep_stats::scans)
+		.def_readonly("sweeps", &sweep_stats::sweeps)
+		.def_readonly("links_scanned", &sweep_stats::links_scanned)
+		.def_readonly("erased", &sweep_stats::erased)
+		.def_readonly("tombstoned", &sweep_stats::tombstoned)
+		.def_readonly("batches", &sweep_stats::batches)
+		.def_readonly("time_spent", &sweep_stats::time_spent)
+	;
+
+	py::class_<weak_sweeper>(m, "weak_sweeper")
+		.def(py::init<sp_link, sweep_policy>(), "root"_a, "policy"_a = sweep_policy{})
+		.def_property("policy", &weak_sweeper::policy, &weak_sweeper::set_policy)
+		.def("sweep", py::overload_cast<>(&weak_sweeper::sweep), py::call_guard<py::gil_scoped_release>(),
+			"Scan subtree and sweep dead weak links right now"
+		)
+		.def("compact", &weak_sweeper::compact, py::call_guard<py::gil_scoped_release>(),
+			"Erase links marked as tombstones"
+		)
+		.def_property_readonly("stats", &weak_sweeper::stats)
+		.def("reset_stats", &weak_sweeper::reset_stats)
+		.def_static("sweep_once",
+			py::overload_cast<const sp_link&, const sweep_policy&>(&weak_sweeper::sweep),
+			"root"_a, "policy"_a = sweep_policy{}, py::call_guard<py::gil_scoped_release>(),
+			"Single sweep of subtree without background thread"
+		)
+	;
+
 	// make root link
 	m.def("make_root_link", &make_root_link,
 		"link_type"_a = "hard_link", "name"_a = "/", "root_node"_a = nullptr,
@@ -218,6 +218,33 @@ BSS_FCN_END
 BSS_FCN_EXPORT(serialize, tree::fusion_link)
 BSS_FCN_EXPORT(load_and_construct, tree::fusion_link)
 
+/*-----------------------------------------------------------------------------
+ *  remote_link
+ *-----------------------------------------------------------------------------*/
+// only mount point is saved, metadata & cached object are fetched from server after load
+BSS_FCN_BEGIN(save, tree::remote_link)
+	ar(
+		make_nvp("name", static_cast<const tree::link&>(t).pimpl_->name_),
+		make_nvp("host", t.host()),
+		make_nvp("port", t.port()),
+		make_nvp("remote_path", t.remote_path()),
+		make_nvp("timeout", t.timeout()),
+		make_nvp("linkbase", base_class<tree::link>(&t))
+	);
+BSS_FCN_END
+
+BSS_FCN_BEGIN(load_and_construct, tree::remote_link)
+	std::string name, host, remote_path;
+	std::uint16_t port;
+	timespan timeout;
+	ar(name, host, port, remote_path, timeout);
+	construct(std::move(name), std::move(host), port, std::move(remote_path), timeout);
+	ar( base_class<tree::link>(construct.ptr()) );
+BSS_FCN_END
+
+BSS_FCN_EXPORT(save, tree::remote_link)
+BSS_FCN_EXPORT(load_and_construct, tree::remote_link)
+
 /*-----------------------------------------------------------------------------
  *  instantiate code for polymorphic types
  *-----------------------------------------------------------------------------*/
@@ -227,6 +254,7 @@ CEREAL_REGISTER_TYPE_WITH_NAME(tree::hard_link, "hard_link")
 CEREAL_REGISTER_TYPE_WITH_NAME(tree::weak_link, "weak_link")
 CEREAL_REGISTER_TYPE_WITH_NAME(tree::sym_link, "sym_link")
 CEREAL_REGISTER_TYPE_WITH_NAME(tree::fusion_link, "fusion_link")
+CEREAL_REGISTER_TYPE_WITH_NAME(tree::remote_link, "remote_link")
 
 BSS_REGISTER_DYNAMIC_INIT(link)
 
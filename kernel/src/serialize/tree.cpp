@@ -9,10 +9,12 @@
 
 #include <bs/log.h>
 #include "../tree/node_impl.h"
+#include "../tree/link_impl.h"
 #include <bs/serialize/serialize.h>
 #include <bs/serialize/tree.h>
 
 #include <fstream>
+#include <limits>
 #include <cereal/types/vector.hpp>
 
 NAMESPACE_BEGIN(blue_sky)
@@ -23,19 +25,43 @@ using namespace tree;
  *  node::node_impl
  *-----------------------------------------------------------------------------*/
 namespace {
+// snapshot of tree that is saved by `save_tree()` in this thread
+thread_local const tree::snapshot* saved_snapshot = nullptr;
+
+// makes given snapshot a source of nodes links while tree is saved
+struct snapshot_scope {
+	const tree::snapshot* prev_;
+
+	snapshot_scope(const tree::snapshot& S) : prev_(std::exchange(saved_snapshot, &S)) {}
+	~snapshot_scope() { saved_snapshot = prev_; }
+};
+
+// epoch of links lists that are saved
+// inside `save_tree()` lists are taken from snapshot, so that changes made while tree is being
+// saved don't break it's consistency, otherwise current list is taken (no snapshot can have max epoch)
+auto saved_epoch() -> snapshot::epoch_t {
+	return saved_snapshot ? saved_snapshot->epoch() : std::numeric_limits<snapshot::epoch_t>::max();
+}
+
 // proxy leafs view to serialize 'em as separate block or 'unit'
 struct leafs_view {
 	links_container& links_;
+	// saved links list
+	snapshot::leafs_t leafs_;
 
-	leafs_view(const links_container& L) : links_(const_cast<links_container&>(L)) {}
+	leafs_view(const links_container& L, snapshot::leafs_t leafs)
+		: links_(const_cast<links_container&>(L)), leafs_(std::move(leafs))
+	{}
 
+	// links are saved with names they had in saved list
 	template<typename Archive>
 	auto save(Archive& ar) const -> void {
-		ar(make_size_tag(links_.size()));
+		ar(make_size_tag(leafs_->size()));
 		// save links in custom index order
-		const auto& any_order = links_.get<Key_tag<Key::AnyOrder>>();
-		for(const auto& leaf : any_order)
-			ar(leaf);
+		for(const auto& leaf : *leafs_) {
+			const auto scope = link_name::save_as_scope(leaf.link->pimpl()->name_, leaf.name);
+			ar(leaf.link);
+		}
 	}
 
 	template<typename Archive>
@@ -57,7 +83,9 @@ struct leafs_view {
 BSS_FCN_INL_BEGIN(serialize, node::node_impl)
 	ar(
 		make_nvp("allowed_otypes", t.allowed_otypes_),
-		make_nvp("leafs", leafs_view(t.links_))
+		make_nvp("leafs", leafs_view(
+			t.links_, Archive::is_saving::value ? t.snapshot_leafs(saved_epoch()) : nullptr
+		))
 	);
 BSS_FCN_INL_END(save, node::node_impl)
 
@@ -82,6 +110,9 @@ NAMESPACE_BEGIN(tree)
  *  tree save/load impl
  *-----------------------------------------------------------------------------*/
 auto save_tree(const sp_link& root, const std::string& filename, TreeArchive ar) -> error {
+	// tree is saved as it was at the moment of call
+	const auto S = snapshot(root);
+	const auto scope = snapshot_scope(S);
 	if(ar == TreeArchive::FS) {
 		auto ar = tree_fs_output(filename);
 		ar(root);
@@ -0,0 +1,272 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Implementation of multi-node transaction
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/batch.h>
+#include <bs/tree/link.h>
+#include "node_impl.h"
+
+#include <algorithm>
+#include <functional>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+/*-----------------------------------------------------------------------------
+ *  collect operations
+ *-----------------------------------------------------------------------------*/
+auto batch::insert(sp_node dst, sp_link L, InsertPolicy pol) -> batch& {
+	ops_.push_back({Op::Insert, std::move(dst), std::move(L), {}, {}, nullptr, pol});
+	return *this;
+}
+
+auto batch::insert(sp_node dst, std::string name, sp_obj obj, InsertPolicy pol) -> batch& {
+	return insert(std::move(dst), std::make_shared<hard_link>(std::move(name), std::move(obj)), pol);
+}
+
+auto batch::erase(sp_node N, const link::id_type& lid) -> batch& {
+	ops_.push_back({Op::Erase, std::move(N), nullptr, lid, {}, nullptr, InsertPolicy::AllowDupNames});
+	return *this;
+}
+
+auto batch::rename(sp_node N, const link::id_type& lid, std::string new_name) -> batch& {
+	ops_.push_back({Op::Rename, std::move(N), nullptr, lid, std::move(new_name), nullptr, InsertPolicy::AllowDupNames});
+	return *this;
+}
+
+auto batch::move(sp_node src, const link::id_type& lid, sp_node dst, InsertPolicy pol) -> batch& {
+	ops_.push_back({Op::Move, std::move(src), nullptr, lid, {}, std::move(dst), pol});
+	return *this;
+}
+
+auto batch::size() const -> std::size_t {
+	return ops_.size();
+}
+
+auto batch::empty() const -> bool {
+	return ops_.empty();
+}
+
+auto batch::abort() -> void {
+	ops_.clear();
+}
+
+/*-----------------------------------------------------------------------------
+ *  commit
+ *-----------------------------------------------------------------------------*/
+auto batch::commit() -> error {
+	using node_impl = node::node_impl;
+	const auto ops = std::exchange(ops_, {});
+	if(ops.empty()) return perfect;
+	for(const auto& o : ops) {
+		if(!o.N || (o.kind == Op::Move && !o.dst)) return error::quiet(Error::NotANode);
+	}
+
+	// nodes touched by batch: targets of operations, previous owners of inserted links
+	// and owners of previous handles of nodes that inserted links point to
+	const auto touched = [&] {
+		std::vector<sp_node> res;
+		for(const auto& o : ops) {
+			res.push_back(o.N);
+			if(o.dst) res.push_back(o.dst);
+			if(o.kind != Op::Insert || !o.L) continue;
+			if(auto P = o.L->owner()) res.push_back(std::move(P));
+			if(const auto D = node_impl::handled_node(o.L)) {
+				if(const auto H = D->handle(); H && H != o.L) {
+					if(auto Q = H->owner()) res.push_back(std::move(Q));
+				}
+			}
+		}
+		std::sort(res.begin(), res.end());
+		res.erase(std::unique(res.begin(), res.end()), res.end());
+		return res;
+	};
+	const auto impls = [](const std::vector<sp_node>& nodes) {
+		std::vector<node_impl*> res;
+		res.reserve(nodes.size());
+		for(const auto& N : nodes) res.push_back(N->pimpl_.get());
+		return res;
+	};
+
+	// events are delivered only if batch succeeds
+	struct defer_events {
+		node_impl::deferred_events_t events;
+		node_impl::deferred_events_t* prev = std::exchange(node_impl::deferred_events_, &events);
+
+		~defer_events() { node_impl::deferred_events_ = prev; }
+	} deferred;
+
+	// nested nodes of inserted links start maintaining stats & generation after nodes are unlocked,
+	// because they can be locked by this batch too
+	struct defer_subtrees {
+		std::vector<sp_link> links;
+		std::vector<sp_link>* prev = std::exchange(node_impl::deferred_subtrees_, &links);
+		bool flushed = false;
+
+		auto flush() -> void {
+			node_impl::deferred_subtrees_ = prev;
+			flushed = true;
+			node_impl::track_deferred(links);
+		}
+		~defer_subtrees() { if(!flushed) node_impl::deferred_subtrees_ = prev; }
+	} deferred_subtrees;
+
+	// actions that revert applied operations, executed in reverse order
+	std::vector<std::function<void()>> undo;
+	// links that resolve their node after commit
+	std::vector<std::pair<sp_link, sp_node>> lazy;
+
+	// make `L` just inserted into `N` owned by it & handle of node it points to
+	const auto adopt = [&](node_impl& N, const sp_node& N_node, const sp_link& L, const sp_node& P) {
+		if(P && P != N_node) {
+			auto [prev, prev_idx] = P->pimpl_->erase_nolock(L->id());
+			if(prev) undo.push_back([&P = *P->pimpl_, prev = prev, prev_idx = prev_idx] {
+				P.insert_at_nolock(prev, prev_idx);
+			});
+		}
+		if(P != N_node) {
+			// [NOTE] sym link revalidates itself on owner change, which locks nodes, so
+			// only owner is set here and derived link is notified after commit
+			L->link::reset_owner(N_node);
+			undo.push_back([L, P] { L->link::reset_owner(P); });
+		}
+
+		if(const auto D = node_impl::handled_node(L)) {
+			if(const auto H = D->handle(); H != L) {
+				// previous handle is removed from it's owner if it differs from owner of `L`
+				if(const auto Q = H ? H->owner() : nullptr; Q && Q != N_node) {
+					auto [prev, prev_idx] = Q->pimpl_->erase_nolock(H->id());
+					if(prev) undo.push_back([&Q = *Q->pimpl_, prev = prev, prev_idx = prev_idx] {
+						Q.insert_at_nolock(prev, prev_idx);
+					});
+				}
+				D->pimpl_->exchange_handle(L);
+				undo.push_back([D, H] { D->pimpl_->exchange_handle(H); });
+			}
+		}
+		else
+			lazy.emplace_back(L, N_node);
+		N.track_subtree(L);
+	};
+
+	const auto apply = [&](const op& o) -> error {
+		auto& N = *o.N->pimpl_;
+		switch(o.kind) {
+		case Op::Insert : {
+			const auto& L = o.L;
+			if(!L || !N.accepts(L) || (L->flags() & Flags::Persistent && L->owner()))
+				return error::quiet(Error::LinkRejected);
+			// replace link with same OID as erase + insert at it's position, so it can be reverted
+			auto pol = o.pol & ~InsertPolicy::Merge;
+			auto replace_idx = std::size_t(-1);
+			if(enumval(pol & InsertPolicy::ReplaceDupOID)) {
+				pol = pol & ~InsertPolicy::ReplaceDupOID;
+				const auto dup = N.find_nolock<Key::OID, Key::ID>(L->oid());
+				if(dup != N.end<Key::ID>() && (*dup)->id() != L->id()) {
+					auto [prev, prev_idx] = N.erase_nolock((*dup)->id());
+					replace_idx = prev_idx;
+					undo.push_back([&N, prev = prev, prev_idx = prev_idx] { N.insert_at_nolock(prev, prev_idx); });
+				}
+			}
+
+			const auto old_name = L->name();
+			const auto P = L->owner();
+			const auto res = N.insert_nolock(L, pol);
+			if(!res.second) return error::quiet(Error::LinkRejected);
+			// sorted node has already placed replacement by comparator
+			if(replace_idx != std::size_t(-1) && !N.sort_less_) {
+				auto& ord = N.links_.get<Key_tag<Key::AnyOrder>>();
+				ord.relocate(N.pos_at(replace_idx), N.project<Key::ID>(res.first));
+				N.emit({Event::LinkMoved, L}, &N);
+			}
+			adopt(N, o.N, L, P);
+			// inverse of insert is pushed after adoption, so it runs first and
+			// erase removes the same subtree that was tracked
+			undo.push_back([&N, L, old_name] {
+				N.erase_nolock(L->id());
+				// insert could rename link
+				if(L->name_ref() != old_name) L->rename_silent(old_name);
+			});
+			break;
+		}
+
+		case Op::Erase : {
+			auto [L, idx] = N.erase_nolock(o.lid);
+			if(!L) return error::quiet(Error::KeyMismatch);
+			undo.push_back([&N, L = L, idx = idx] { N.insert_at_nolock(L, idx); });
+			break;
+		}
+
+		case Op::Rename : {
+			auto old_name = N.rename_nolock(o.lid, o.name);
+			if(!old_name) return error::quiet(Error::KeyMismatch);
+			undo.push_back([&N, lid = o.lid, old_name = std::move(*old_name)] {
+				N.rename_nolock(lid, old_name);
+			});
+			break;
+		}
+
+		case Op::Move : {
+			const auto src_pos = N.find<Key::ID, Key::AnyOrder>(o.lid);
+			if(src_pos == N.end<>()) return error::quiet(Error::KeyMismatch);
+			const auto L = *src_pos;
+			const auto src_idx = std::size_t(std::distance(N.begin<>(), src_pos));
+			const auto old_name = L->name();
+
+			auto& dst = *o.dst->pimpl_;
+			if(!node_impl::move_nolock(N, dst, o.dst, o.lid, dst.end<>(), o.pol).second)
+				return error::quiet(Error::LinkRejected);
+			undo.push_back([&N, &dst, src = o.N, L, src_idx, old_name] {
+				node_impl::move_nolock(dst, N, src, L->id(), N.pos_at(src_idx), InsertPolicy::AllowDupNames);
+				if(L->name_ref() != old_name) N.rename_nolock(L->id(), old_name);
+			});
+			if(o.N != o.dst) {
+				L->link::reset_owner(o.dst);
+				undo.push_back([L, src = o.N] { L->link::reset_owner(src); });
+				if(L->type_id() == "sym_link") lazy.emplace_back(L, o.dst);
+			}
+			break;
+		}
+		}
+		return perfect;
+	};
+
+	// apply all operations in single transaction
+	// set of touched nodes is verified after locking, because owners could change meanwhile
+	auto res = [&]() -> error {
+		for(int attempt = 0; attempt < 16; ++attempt) {
+			const auto nodes = touched();
+			const auto guard = node_impl::lock_all(impls(nodes));
+			if(touched() != nodes) continue;
+
+			for(const auto& o : ops) {
+				if(auto er = apply(o)) {
+					for(auto pos = undo.rbegin(); pos != undo.rend(); ++pos)
+						(*pos)();
+					return er;
+				}
+			}
+			return perfect;
+		}
+		return error::quiet(Error::LinkBusy);
+	}();
+	// links reinserted by rollback are tracked too
+	deferred_subtrees.flush();
+	if(res) return res;
+
+	// links that weren't adopted inside transaction are notified after nodes are unlocked
+	// owner is already set, so virtual `reset_owner()` only refreshes derived state (sym link status)
+	for(const auto& [L, N] : lazy) {
+		if(L->owner() != N) continue;
+		L->reset_owner(N);
+		if(L->type_id() != "sym_link") L->propagate_handle();
+	}
+	node_impl::deliver_deferred(deferred.events);
+	return res;
+}
+
+NAMESPACE_END(blue_sky::tree)
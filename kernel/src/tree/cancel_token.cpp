@@ -0,0 +1,84 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Cancellation token implementation
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/cancel_token.h>
+#include "link_invoke.h"
+
+#include <atomic>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+
+struct cancel_token::state {
+	std::atomic<bool> cancelled = false;
+	const clock::time_point deadline;
+
+	explicit state(clock::time_point deadline_) : deadline(deadline_) {}
+};
+
+NAMESPACE_BEGIN()
+
+// token of currently executing request
+thread_local const cancel_token* current_token_ = nullptr;
+
+NAMESPACE_END()
+
+cancel_token::cancel_token() : cancel_token(clock::time_point::max()) {}
+
+cancel_token::cancel_token(clock::time_point deadline)
+	: state_(std::make_shared<state>(deadline))
+{}
+
+cancel_token::cancel_token(clock::duration timeout)
+	: cancel_token(clock::now() + timeout)
+{}
+
+cancel_token::cancel_token(none_tag) {}
+
+auto cancel_token::none() -> const cancel_token& {
+	static const auto none_ = cancel_token(none_tag{});
+	return none_;
+}
+
+auto cancel_token::cancel() const -> void {
+	// wake threads sleeping on Busy links or waiting for room in requests queue,
+	// so that they notice cancellation
+	if(state_ && !state_->cancelled.exchange(true, std::memory_order_acq_rel)) {
+		detail::parking_lot::wake_everyone();
+		detail::wake_blocked_senders();
+	}
+}
+
+auto cancel_token::is_cancelled() const -> bool {
+	return state_ && (
+		state_->cancelled.load(std::memory_order_acquire) ||
+		(state_->deadline != clock::time_point::max() && clock::now() >= state_->deadline)
+	);
+}
+
+auto cancel_token::deadline() const -> clock::time_point {
+	return state_ ? state_->deadline : clock::time_point::max();
+}
+
+auto cancel_token::check() const -> error {
+	return is_cancelled() ? error::quiet(Error::RequestCancelled) : perfect;
+}
+
+auto cancel_token::current() -> const cancel_token& {
+	return current_token_ ? *current_token_ : none();
+}
+
+cancel_token::scope::scope(const cancel_token& token) : prev_(current_token_) {
+	current_token_ = &token;
+}
+
+cancel_token::scope::~scope() {
+	current_token_ = prev_;
+}
+
+NAMESPACE_END(blue_sky::tree)
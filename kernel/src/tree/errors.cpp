@@ -44,6 +44,18 @@ BS_API std::error_code make_error_code(Error e) {
 			case Error::KeyMismatch :
 				return "Given key is not found";
 
+			case Error::LinkRejected:
+				return "Link is rejected by node";
+
+			case Error::RemoteUnreachable:
+				return "Remote tree is unreachable";
+
+			case Error::RequestCancelled:
+				return "Request is cancelled or deadline is expired";
+
+			case Error::QueueOverflow:
+				return "Requests queue is full";
+
 			default:
 				return "";
 			}
@@ -69,7 +69,8 @@ auto fusion_link::data_impl() const -> result_or_err<sp_obj> {
 		auto err = B->pull_data(pimpl_->data_);
 		if(err.code == obj_fully_loaded)
 			rs_reset_if_neq(Req::DataNode, ReqStatus::Busy, ReqStatus::OK);
-		return err.ok() ? result_or_err<sp_obj>(pimpl_->data_) : tl::make_unexpected(std::move(err));
+		if(err.ok()) return pimpl_->data_;
+		return tl::make_unexpected(impl::bridge_error(std::move(err)));
 	}
 	return tl::make_unexpected(Error::NoFusionBridge);
 }
@@ -82,17 +83,27 @@ auto fusion_link::populate(const std::string& child_type_id, bool wait_if_busy)
 -> result_or_err<sp_node> {
 	// [NOTE] we access here internals of base link
 	// to obtain status of DataNode operation
-	return detail::link_invoke(
+	const auto prev_rs = req_status(Req::DataNode);
+	auto res = detail::link_invoke(
 		this,
 		[&child_type_id](const fusion_link* lnk) { return impl::populate(lnk, child_type_id); },
 		pimpl()->status_[1], wait_if_busy
 	);
+	pimpl()->notify_status(*this, Req::DataNode, prev_rs);
+	return res;
 }
 
 auto fusion_link::populate(link::process_data_cb f, std::string child_type_id) const
 -> void {
+	populate(std::move(f), std::move(child_type_id), cancel_token::none());
+}
+
+auto fusion_link::populate(link::process_data_cb f, std::string child_type_id, cancel_token token) const
+-> void {
+	if(!pimpl()->enqueue(*this, link::impl::Queued::Populate, f, token)) return;
 	pimpl_->send(
-		flnk_populate_atom(), this->bs_shared_this<link>(), std::move(f), std::move(child_type_id)
+		flnk_populate_atom(), this->bs_shared_this<link>(), std::move(f), std::move(child_type_id),
+		std::move(token)
 	);
 }
 
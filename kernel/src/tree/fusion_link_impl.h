@@ -8,6 +8,7 @@
 /// You can obtain one at https://mozilla.org/MPL/2.0/
 #pragma once
 
+#include "link_impl.h"
 #include <bs/tree/fusion.h>
 #include <bs/tree/node.h>
 #include <bs/tree/errors.h>
@@ -30,7 +31,7 @@ static const auto obj_fully_loaded = make_error_code(Error::OKOK);
 
 // actor type for async API
 using flink_actor_t = caf::typed_actor<
-	caf::reacts_to<flnk_populate_atom, sp_clink, link::process_data_cb, std::string>
+	caf::reacts_to<flnk_populate_atom, sp_clink, link::process_data_cb, std::string, cancel_token>
 >;
 
 } // hidden
@@ -53,6 +54,13 @@ struct BS_HIDDEN_API fusion_link::impl : public blue_sky::detail::anon_async_api
 		bridge_ = std::move(new_bridge);
 	}
 
+	// bridge that bails out on cancelled request can return arbitrary error
+	// replace it with cancellation error to roll back link status
+	static auto bridge_error(error&& err) -> error {
+		const auto& token = cancel_token::current();
+		return token.is_cancelled() ? token.check() : std::move(err);
+	}
+
 	// implement populate with specified child type
 	static auto populate(
 		const fusion_link* lnk, const std::string& child_type_id = ""
@@ -66,8 +74,8 @@ struct BS_HIDDEN_API fusion_link::impl : public blue_sky::detail::anon_async_api
 			auto err = B->populate(lnk->pimpl_->data_, child_type_id);
 			if(err.code == obj_fully_loaded)
 				lnk->rs_reset_if_neq(Req::Data, ReqStatus::Busy, ReqStatus::OK);
-			return err.ok() ?
-				result_or_err<sp_node>(lnk->pimpl_->data_) : tl::make_unexpected(std::move(err));
+			if(err.ok()) return lnk->pimpl_->data_;
+			return tl::make_unexpected(bridge_error(std::move(err)));
 		}
 		return tl::make_unexpected(Error::NoFusionBridge);
 	}
@@ -78,9 +86,14 @@ struct BS_HIDDEN_API fusion_link::impl : public blue_sky::detail::anon_async_api
 	static auto async_behavior(flink_actor_t::pointer self) -> flink_actor_t::behavior_type {
 		return {
 			[](
-				flnk_populate_atom, const sp_clink& lnk, const process_data_cb& f, const std::string& obj_type_id
+				flnk_populate_atom, const sp_clink& lnk, const process_data_cb& f, const std::string& obj_type_id,
+				const cancel_token& token
 			) {
-				f(std::static_pointer_cast<const fusion_link>(lnk)->populate(obj_type_id), lnk);
+				const auto flnk = std::static_pointer_cast<const fusion_link>(lnk);
+				link::impl::deliver(
+					[&] { return flnk->populate(obj_type_id); }, token, lnk, f,
+					flnk->pimpl()->dequeue(link::impl::Queued::Populate)
+				);
 			}
 		};
 	}
@@ -10,6 +10,7 @@
 #include <bs/tree/link.h>
 #include <bs/tree/node.h>
 #include <bs/tree/errors.h>
+#include <bs/tree/sweeper.h>
 #include <bs/kernel/types_factory.h>
 
 NAMESPACE_BEGIN(blue_sky::tree)
@@ -68,10 +69,16 @@ std::string weak_link::type_id() const {
 	return "weak_link";
 }
 
+auto weak_link::expired() const -> bool {
+	return data_.expired();
+}
+
 result_or_err<sp_obj> weak_link::data_impl() const {
-	return data_.expired() ?
-		tl::make_unexpected(error::quiet(Error::LinkExpired)) :
-		result_or_err<sp_obj>(data_.lock());
+	if(auto obj = data_.lock())
+		return obj;
+	// let sweepers know about dead link
+	weak_sweeper::on_expired(*this);
+	return tl::make_unexpected(error::quiet(Error::LinkExpired));
 }
 
 auto weak_link::propagate_handle() -> result_or_err<sp_node> {
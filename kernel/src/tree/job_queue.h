@@ -0,0 +1,122 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Stack of tree processing jobs that can be served by several threads
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/common.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+/// Jobs are processed by calling thread and (if `parallel` is set) by helper threads
+/// that are started on demand, when more than one job is waiting in queue.
+/// Processing a job can push new jobs, `run()` returns when all of them are done.
+/// Jobs are taken in LIFO order, so single-threaded run is a depth-first traversal
+/// with explicit stack that can't overflow on deep trees.
+template<typename Job>
+class job_queue {
+public:
+	explicit job_queue(bool parallel = true, std::size_t max_threads = 0)
+		: max_helpers_(parallel ? (max_threads ? max_threads : default_concurrency()) - 1 : 0)
+	{}
+
+	~job_queue() {
+		join_helpers();
+	}
+
+	auto push(Job j) -> void {
+		std::lock_guard<std::mutex> guard(solo_);
+		if(error_) return;
+		jobs_.push_back(std::move(j));
+		++pending_;
+		// start helper only if there is a job for it
+		if(f_ && jobs_.size() > 1 && helpers_.size() < max_helpers_)
+			helpers_.emplace_back([this] { serve(); });
+		else
+			has_work_.notify_one();
+	}
+
+	/// process all pushed jobs by calling `f(Job&&)`
+	/// first exception thrown by `f` is rethrown after all workers are stopped
+	template<typename F>
+	auto run(F&& f) -> void {
+		{
+			std::lock_guard<std::mutex> guard(solo_);
+			f_ = [&f](Job&& j) { f(std::move(j)); };
+			// kick helpers if several jobs are pushed before run
+			const auto n_kick = std::min(jobs_.size() ? jobs_.size() - 1 : 0, max_helpers_);
+			while(helpers_.size() < n_kick)
+				helpers_.emplace_back([this] { serve(); });
+		}
+		serve();
+		join_helpers();
+		f_ = nullptr;
+		if(error_) std::rethrow_exception(std::exchange(error_, nullptr));
+	}
+
+	/// number of threads that processed jobs during last `run()` including caller
+	auto concurrency() const -> std::size_t {
+		return helpers_.size() + 1;
+	}
+
+	static auto default_concurrency() -> std::size_t {
+		return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+private:
+	std::vector<Job> jobs_;
+	std::size_t pending_ = 0;
+	const std::size_t max_helpers_;
+	std::vector<std::thread> helpers_;
+	std::function<void(Job&&)> f_;
+	std::exception_ptr error_;
+
+	std::mutex solo_;
+	std::condition_variable has_work_;
+
+	auto serve() -> void {
+		std::unique_lock<std::mutex> guard(solo_);
+		while(true) {
+			has_work_.wait(guard, [this] { return !jobs_.empty() || !pending_; });
+			if(jobs_.empty()) break;
+
+			auto j = std::move(jobs_.back());
+			jobs_.pop_back();
+			guard.unlock();
+			try {
+				f_(std::move(j));
+			}
+			catch(...) {
+				guard.lock();
+				if(!error_) error_ = std::current_exception();
+				// drop the rest of jobs
+				pending_ -= jobs_.size();
+				jobs_.clear();
+				guard.unlock();
+			}
+			guard.lock();
+			if(!--pending_) has_work_.notify_all();
+		}
+	}
+
+	auto join_helpers() -> void {
+		// helpers vector can't grow here - all jobs are done
+		for(auto& h : helpers_)
+			if(h.joinable()) h.join();
+	}
+};
+
+NAMESPACE_END(blue_sky::tree::detail)
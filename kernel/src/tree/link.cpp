@@ -10,7 +10,82 @@
 #include <bs/kernel/config.h>
 #include "link_impl.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <string_view>
+#include <unordered_map>
+
 NAMESPACE_BEGIN(blue_sky::tree)
+/*-----------------------------------------------------------------------------
+ *  link names pool
+ *-----------------------------------------------------------------------------*/
+NAMESPACE_BEGIN()
+
+struct name_pool {
+	using interned_t = link_name::interned_t;
+
+	std::unordered_map<std::string_view, std::weak_ptr<const std::string>> names_;
+	std::mutex guard_;
+	std::atomic<bool> enabled_ = false;
+
+	// pool is never destructed, because links can outlive static objects
+	static auto get() -> name_pool& {
+		static auto self = new name_pool;
+		return *self;
+	}
+
+	auto intern(std::string name) -> interned_t {
+		std::lock_guard<std::mutex> my_turn(guard_);
+		if(auto pos = names_.find(name); pos != names_.end()) {
+			// returned string isn't released under lock, because another owner still exists
+			if(auto res = pos->second.lock()) return res;
+			// expired string is waiting for release
+			names_.erase(pos);
+		}
+		auto res = interned_t(new std::string(std::move(name)), [](const std::string* s) {
+			name_pool::get().release(s);
+		});
+		names_.emplace(*res, res);
+		return res;
+	}
+
+	auto release(const std::string* s) -> void {
+		{
+			std::lock_guard<std::mutex> my_turn(guard_);
+			// entry can be already replaced by new string with same value
+			if(auto pos = names_.find(*s); pos != names_.end() && pos->first.data() == s->data())
+				names_.erase(pos);
+		}
+		delete s;
+	}
+};
+
+NAMESPACE_END()
+
+link_name::link_name(std::string name) {
+	auto& pool = name_pool::get();
+	if(pool.enabled_.load(std::memory_order_relaxed))
+		name_ = pool.intern(std::move(name));
+	else
+		name_ = std::move(name);
+}
+
+auto link_name::intern(bool on) -> void {
+	name_pool::get().enabled_ = on;
+}
+
+auto link_name::interned() -> bool {
+	return name_pool::get().enabled_;
+}
+
+auto link::intern_names(bool on) -> void {
+	link_name::intern(on);
+}
+
+auto link::interning_names() -> bool {
+	return link_name::interned();
+}
+
 /*-----------------------------------------------------------------------------
  *  misc
  *-----------------------------------------------------------------------------*/
@@ -31,7 +106,11 @@ auto link::id() const -> const id_type& {
 
 /// obtain link's symbolic name
 auto link::name() const -> std::string {
-	return pimpl_->name_;
+	return pimpl_->name_.str();
+}
+
+auto link::name_ref() const -> const std::string& {
+	return pimpl_->name_.str();
 }
 
 /// get link's container
@@ -40,8 +119,13 @@ auto link::owner() const -> sp_node {
 }
 
 void link::reset_owner(const sp_node& new_owner) {
-	std::lock_guard<std::mutex> g(pimpl_->solo_);
-	pimpl_->owner_ = new_owner;
+	sp_node prev_owner;
+	{
+		std::lock_guard<std::mutex> g(pimpl_->solo_);
+		prev_owner = pimpl_->owner_.lock();
+		pimpl_->owner_ = new_owner;
+	}
+	path_cache::on_owner_changed(*this, prev_owner);
 }
 
 auto link::info() const -> result_or_err<inode> {
@@ -120,8 +204,9 @@ result_or_err<sp_node> link::data_node_impl() const {
 }
 
 result_or_err<sp_obj> link::data_ex(bool wait_if_busy) const {
+	const auto prev_rs = pimpl_->req_status(Req::Data);
 	// never returns NULL object
-	return link_invoke(
+	auto res = link_invoke(
 		this,
 		[](const link* lnk) { return lnk->data_impl(); },
 		pimpl_->status_[0], wait_if_busy
@@ -130,11 +215,14 @@ result_or_err<sp_obj> link::data_ex(bool wait_if_busy) const {
 			result_or_err<sp_obj>(std::move(obj)) :
 			tl::make_unexpected(error::quiet(Error::EmptyData));
 	});
+	pimpl_->notify_status(*this, Req::Data, prev_rs);
+	return res;
 }
 
 result_or_err<sp_node> link::data_node_ex(bool wait_if_busy) const {
+	const auto prev_rs = pimpl_->req_status(Req::DataNode);
 	// never returns NULL node
-	return link_invoke(
+	auto res = link_invoke(
 		this,
 		[](const link* lnk) { return lnk->data_node_impl(); },
 		pimpl_->status_[1], wait_if_busy
@@ -143,6 +231,8 @@ result_or_err<sp_node> link::data_node_ex(bool wait_if_busy) const {
 			result_or_err<sp_node>(std::move(N)) :
 			tl::make_unexpected(error::quiet(Error::EmptyData));
 	});
+	pimpl_->notify_status(*this, Req::DataNode, prev_rs);
+	return res;
 }
 
 void link::self_handle_node(const sp_node& N) {
@@ -165,31 +255,390 @@ auto link::req_status(Req request) const -> ReqStatus {
 }
 
 auto link::rs_reset(Req request, ReqStatus new_rs) const -> ReqStatus {
-	return pimpl_->rs_reset(request, new_rs);
+	return pimpl_->notify_status(*this, request, pimpl_->rs_reset(request, new_rs));
 }
 
 auto link::rs_reset_if_eq(Req request, ReqStatus self, ReqStatus new_rs) const -> ReqStatus {
-	return pimpl_->rs_reset_if_eq(request, self, new_rs);
+	return pimpl_->notify_status(*this, request, pimpl_->rs_reset_if_eq(request, self, new_rs));
 }
 
 auto link::rs_reset_if_neq(Req request, ReqStatus self, ReqStatus new_rs) const -> ReqStatus {
-	return pimpl_->rs_reset_if_neq(request, self, new_rs);
+	return pimpl_->notify_status(*this, request, pimpl_->rs_reset_if_neq(request, self, new_rs));
+}
+
+auto link::notify_data_changed() const -> void {
+	if(auto O = owner())
+		O->on_data_changed(std::const_pointer_cast<link>(shared_from_this()));
 }
 
 auto link::data(process_data_cb f, bool high_priority) const -> void {
+	data(std::move(f), cancel_token::none(), high_priority);
+}
+
+auto link::data_node(process_data_cb f, bool high_priority) const -> void {
+	data_node(std::move(f), cancel_token::none(), high_priority);
+}
+
+auto link::data(process_data_cb f, cancel_token token, bool high_priority) const -> void {
+	if(!pimpl_->enqueue(*this, impl::Queued::Data, f, token)) return;
 	pimpl_->send(
 		high_priority ? caf::message_priority::high : caf::message_priority::normal,
-		lnk_data_atom(), shared_from_this(), std::move(f)
+		lnk_data_atom(), shared_from_this(), std::move(f), std::move(token)
 	);
 }
 
-auto link::data_node(process_data_cb f, bool high_priority) const -> void {
+auto link::data_node(process_data_cb f, cancel_token token, bool high_priority) const -> void {
+	if(!pimpl_->enqueue(*this, impl::Queued::DataNode, f, token)) return;
 	pimpl_->send(
 		high_priority ? caf::message_priority::high : caf::message_priority::normal,
-		lnk_dnode_atom(), shared_from_this(), std::move(f)
+		lnk_dnode_atom(), shared_from_this(), std::move(f), std::move(token)
 	);
 }
 
+/*-----------------------------------------------------------------------------
+ *  bounded queue of async requests
+ *-----------------------------------------------------------------------------*/
+NAMESPACE_BEGIN()
+
+struct request_queues {
+	using Overflow = link::Overflow;
+
+	std::atomic<std::size_t> per_link_ = 0, total_ = 0;
+	std::atomic<Overflow> policy_ = Overflow::Reject;
+	// requests queued to all links
+	std::atomic<std::size_t> depth_ = 0;
+
+	// callbacks joined to queued requests, key is address of link's counter for request kind
+	std::unordered_map<const void*, std::vector<link::impl::joined_request>> coalesced_;
+	std::mutex guard_;
+
+	// senders waiting for room in queue
+	std::atomic<std::size_t> n_blocked_ = 0;
+	std::condition_variable room_cv_;
+	std::mutex room_guard_;
+
+	// queues are never destructed, because links can outlive static objects
+	static auto get() -> request_queues& {
+		static auto self = new request_queues;
+		return *self;
+	}
+
+	auto wake_blocked() -> void {
+		if(!n_blocked_.load()) return;
+		{ auto guard = std::lock_guard{room_guard_}; }
+		room_cv_.notify_all();
+	}
+};
+
+NAMESPACE_END()
+
+auto detail::wake_blocked_senders() -> void {
+	request_queues::get().wake_blocked();
+}
+
+auto link::set_queue_limits(queue_limits limits) -> void {
+	auto& Q = request_queues::get();
+	Q.per_link_ = limits.per_link;
+	Q.total_ = limits.total;
+	Q.policy_ = limits.policy;
+	// limits could be relaxed
+	Q.wake_blocked();
+}
+
+auto link::get_queue_limits() -> queue_limits {
+	auto& Q = request_queues::get();
+	return { Q.per_link_, Q.total_, Q.policy_ };
+}
+
+auto link::queue_depth() const -> std::size_t {
+	return pimpl_->queue_depth();
+}
+
+auto link::total_queue_depth() -> std::size_t {
+	return request_queues::get().depth_;
+}
+
+auto link::blocked_senders() -> std::size_t {
+	return request_queues::get().n_blocked_;
+}
+
+auto link::impl::queue_depth() const -> std::size_t {
+	std::size_t res = 0;
+	for(const auto& counter : queued_)
+		res += counter.load(std::memory_order_relaxed) & count_mask;
+	return res;
+}
+
+auto link::impl::enqueue(const link& self, Queued q, process_data_cb& f, const cancel_token& token) -> bool {
+	auto& Q = request_queues::get();
+	auto& counter = queued_[unsigned(q)];
+	// [NOTE] bounds are soft: concurrent senders can slightly overrun them
+	const auto fits = [&] {
+		const auto per_link = Q.per_link_.load(std::memory_order_relaxed);
+		const auto total = Q.total_.load(std::memory_order_relaxed);
+		return (!per_link || queue_depth() < per_link) && (!total || Q.depth_.load() < total);
+	};
+	// join `f` to request of same kind that is queued and not started yet
+	const auto coalesce = [&] {
+		auto guard = std::lock_guard{Q.guard_};
+		for(auto cur = counter.load(std::memory_order_relaxed); cur & count_mask;) {
+			if(counter.compare_exchange_weak(cur, cur | coalesced_bit, std::memory_order_acq_rel)) {
+				Q.coalesced_[&counter].push_back({std::move(f), token});
+				return true;
+			}
+		}
+		return false;
+	};
+
+	if(!fits()) {
+		auto policy = Q.policy_.load(std::memory_order_relaxed);
+		// actor that blocks waiting for room may be the one that must drain queue
+		if(policy == Overflow::Block && in_actor_) policy = Overflow::Reject;
+		switch(policy) {
+		case Overflow::Block : {
+			// sender gives up if token is cancelled or expires, `cancel_token::cancel()` wakes it
+			const auto ready = [&] {
+				return fits() || Q.policy_ != Overflow::Block || token.is_cancelled();
+			};
+			const auto deadline = token.deadline();
+			++Q.n_blocked_;
+			auto guard = std::unique_lock{Q.room_guard_};
+			if(deadline == cancel_token::clock::time_point::max())
+				Q.room_cv_.wait(guard, ready);
+			else
+				Q.room_cv_.wait_until(guard, deadline, ready);
+			--Q.n_blocked_;
+			guard.unlock();
+			if(token.is_cancelled()) {
+				error::eval_safe([&] {
+					f(tl::make_unexpected(error::quiet(Error::RequestCancelled)), self.shared_from_this());
+				});
+				return false;
+			}
+			break;
+		}
+		case Overflow::Coalesce :
+			if(coalesce()) return false;
+			[[fallthrough]];
+		default :
+			error::eval_safe([&] {
+				f(tl::make_unexpected(error::quiet(Error::QueueOverflow)), self.shared_from_this());
+			});
+			return false;
+		}
+	}
+	counter.fetch_add(1);
+	++Q.depth_;
+	return true;
+}
+
+auto link::impl::dequeue(Queued q) -> std::vector<joined_request> {
+	auto& Q = request_queues::get();
+	auto& counter = queued_[unsigned(q)];
+	const auto prev = counter.fetch_sub(1);
+	--Q.depth_;
+	Q.wake_blocked();
+
+	// pick up joined callbacks
+	auto res = std::vector<joined_request>{};
+	if(prev & coalesced_bit) {
+		auto guard = std::lock_guard{Q.guard_};
+		counter.fetch_and(count_mask);
+		if(auto pos = Q.coalesced_.find(&counter); pos != Q.coalesced_.end()) {
+			res = std::move(pos->second);
+			Q.coalesced_.erase(pos);
+		}
+	}
+	return res;
+}
+
+/*-----------------------------------------------------------------------------
+ *  path cache
+ *-----------------------------------------------------------------------------*/
+NAMESPACE_BEGIN()
+
+// index of cached path for given path unit, -1 if unit isn't cached
+auto path_idx(node::Key path_unit) -> int {
+	switch(path_unit) {
+	case node::Key::ID : return 0;
+	case node::Key::Name : return 1;
+	case node::Key::Type : return 2;
+	default : return -1;
+	}
+}
+
+auto path_unit_str(const link& L, node::Key path_unit) -> std::string {
+	switch(path_unit) {
+	default:
+	case node::Key::ID : return boost::uuids::to_string(L.id());
+	case node::Key::Name : return L.name();
+	case node::Key::Type : return L.type_id();
+	}
+}
+
+NAMESPACE_END()
+
+auto detail::path_cache::get(const link& L) -> slot& {
+	return L.pimpl_->path_;
+}
+
+auto detail::path_cache::get_entry(const link& L) -> entry& {
+	auto& S = get(L);
+	auto E = S.E.load(std::memory_order_acquire);
+	if(E) return *E;
+	auto fresh = std::make_unique<entry>();
+	if(S.E.compare_exchange_strong(E, fresh.get(), std::memory_order_acq_rel))
+		return *fresh.release();
+	return *E;
+}
+
+auto detail::path_cache::bump_tree(const sp_node& N) -> void {
+	if(!N) return;
+	auto R = N;
+	if(const auto N_h = N->handle(); N_h && N_h->owner()) {
+		if(auto top = root(*N_h).first) R = std::move(top);
+	}
+	gen(*R).fetch_add(1, std::memory_order_acq_rel);
+}
+
+auto detail::path_cache::cached_nolock(const entry& E, const sp_node& owner) -> std::optional<root_info> {
+	if(!E.gen || E.owner.lock() != owner) return {};
+	auto res = root_info{ E.root.lock(), E.root_h.lock(), E.gen };
+	if(!res.root || !res.root_h || gen(*res.root).load(std::memory_order_acquire) != E.gen)
+		return {};
+	// root could get an owner without changing it's own generation
+	if(const auto R_h = res.root->handle(); R_h && R_h->owner()) return {};
+	return res;
+}
+
+auto detail::path_cache::sync(const link& L) -> root_info {
+	if(!L.owner()) return { nullptr, L.shared_from_this(), 0 };
+
+	// climb up to first ancestor handle with valid cache or to the top
+	std::vector<std::pair<sp_clink, sp_node>> chain;
+	auto res = root_info{};
+	while(true) {
+		chain.clear();
+		auto cur = L.shared_from_this();
+		while(true) {
+			auto owner = cur->owner();
+			auto& E = get_entry(*cur);
+			{
+				std::lock_guard<std::mutex> g(E.guard);
+				if(auto cached = cached_nolock(E, owner)) {
+					res = std::move(*cached);
+					break;
+				}
+			}
+			auto owner_h = owner->handle();
+			chain.emplace_back(std::move(cur), std::move(owner));
+			const auto& top = chain.back().second;
+			if(!owner_h || !owner_h->owner()) {
+				res.root = top;
+				res.root_h = owner_h ? std::move(owner_h) : chain.back().first;
+				res.gen = gen(*top).load(std::memory_order_acquire);
+				break;
+			}
+			cur = std::move(owner_h);
+		}
+
+		// changes made after generation is read will bump it, verify that none happened before
+		const auto unchanged = [&] {
+			for(std::size_t i = 0; i < chain.size(); ++i) {
+				const auto& [lnk, owner] = chain[i];
+				if(lnk->owner() != owner) return false;
+				if(i + 1 < chain.size() && owner->handle() != chain[i + 1].first) return false;
+			}
+			return true;
+		};
+		if(unchanged()) break;
+	}
+
+	for(const auto& [lnk, owner] : chain) {
+		auto& E = get_entry(*lnk);
+		std::lock_guard<std::mutex> g(E.guard);
+		E.owner = owner;
+		E.root = res.root;
+		E.root_h = res.root_h;
+		E.gen = res.gen;
+		for(auto& P : E.paths) P.reset();
+	}
+	return res;
+}
+
+auto detail::path_cache::on_rename(slot& S, const sp_node& owner) -> void {
+	if(S.is_handle)
+		bump_tree(owner);
+	else if(const auto E = S.E.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> g(E->guard);
+		E->gen = 0;
+	}
+}
+
+auto detail::path_cache::on_owner_changed(const link& L, const sp_node& prev_owner) -> void {
+	// entry of link itself is checked against current owner,
+	// handle without owner was a root handle and it's tree finds out that it's root got an owner
+	if(get(L).is_handle && L.owner() != prev_owner) bump_tree(prev_owner);
+}
+
+auto detail::path_cache::on_handle_changed(
+	const sp_link& prev_handle, const sp_link& new_handle, gen_t& node_gen
+) -> void {
+	if(prev_handle == new_handle) return;
+	if(prev_handle) get(*prev_handle).is_handle = false;
+	if(new_handle) get(*new_handle).is_handle = true;
+	// invalidate tree that contained node and node's own tree (if node was a root)
+	if(prev_handle) bump_tree(prev_handle->owner());
+	node_gen.fetch_add(1, std::memory_order_acq_rel);
+}
+
+auto detail::path_cache::on_destroyed(slot& S, const sp_node& owner) -> void {
+	if(S.is_handle) bump_tree(owner);
+}
+
+auto detail::path_cache::abspath(const link& L, Key path_unit) -> std::string {
+	const auto i = path_idx(path_unit);
+	if(i < 0) return {};
+	const auto info = sync(L);
+	if(!info.root) return "/";
+
+	// collect links up to first one with cached path
+	// [NOTE] root ID is irrelevant => abs path always starts with '/'
+	std::vector<sp_clink> chain;
+	auto res = std::string{};
+	for(auto cur = L.shared_from_this(); cur;) {
+		auto& E = get_entry(*cur);
+		{
+			std::lock_guard<std::mutex> g(E.guard);
+			if(E.gen == info.gen && E.root.lock() == info.root && E.paths[i]) {
+				res = *E.paths[i];
+				break;
+			}
+		}
+		const auto owner = cur->owner();
+		auto owner_h = owner ? owner->handle() : nullptr;
+		chain.push_back(std::move(cur));
+		if(owner_h && owner_h->owner()) cur = std::move(owner_h);
+	}
+
+	// fill paths top down
+	for(auto pos = chain.rbegin(); pos != chain.rend(); ++pos) {
+		res += '/';
+		res += path_unit_str(**pos, path_unit);
+		// if tree changed meanwhile, path isn't saved
+		auto& E = get_entry(**pos);
+		std::lock_guard<std::mutex> g(E.guard);
+		if(E.gen == info.gen && E.root.lock() == info.root)
+			E.paths[i] = res;
+	}
+	return res;
+}
+
+auto detail::path_cache::root(const link& L) -> std::pair<sp_node, sp_clink> {
+	auto info = sync(L);
+	return { std::move(info.root), std::move(info.root_h) };
+}
+
 /*-----------------------------------------------------------------------------
  *  ilink
  *-----------------------------------------------------------------------------*/
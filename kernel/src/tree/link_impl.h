@@ -9,6 +9,7 @@
 #pragma once
 
 #include "link_invoke.h"
+#include "path_cache.h"
 #include <bs/tree/node.h>
 #include <bs/atoms.h>
 #include <bs/detail/async_api_mixin.h>
@@ -19,7 +20,13 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
 CAF_ALLOW_UNSAFE_MESSAGE_TYPE(blue_sky::tree::link::process_data_cb)
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(blue_sky::tree::cancel_token)
 
 NAMESPACE_BEGIN(blue_sky::tree)
 
@@ -38,18 +45,62 @@ static boost::uuids::random_generator gen;
 
 // link's actor type for async API
 using link_actor_t = caf::typed_actor<
-	caf::reacts_to<lnk_data_atom, sp_clink, link::process_data_cb>,
-	caf::reacts_to<lnk_dnode_atom, sp_clink, link::process_data_cb>
+	caf::reacts_to<lnk_data_atom, sp_clink, link::process_data_cb, cancel_token>,
+	caf::reacts_to<lnk_dnode_atom, sp_clink, link::process_data_cb, cancel_token>
 >;
 
 } // eof hidden namespace
 
+/*-----------------------------------------------------------------------------
+ *  link name that can be interned in global pool
+ *-----------------------------------------------------------------------------*/
+class BS_HIDDEN_API link_name {
+public:
+	using interned_t = std::shared_ptr<const std::string>;
+
+	// if names interning is on, equal names share single string instance
+	link_name(std::string name = {});
+
+	auto str() const -> const std::string& {
+		if(auto p = std::get_if<interned_t>(&name_)) return **p;
+		return std::get<std::string>(name_);
+	}
+
+	// serialized as plain string
+	template<typename Archive>
+	auto save_minimal(const Archive&) const -> std::string {
+		if(saved_as_.first == this) return *saved_as_.second;
+		return str();
+	}
+	template<typename Archive>
+	auto load_minimal(const Archive&, const std::string& name) -> void {
+		*this = link_name(name);
+	}
+
+	// turn names interning on/off
+	static auto intern(bool on) -> void;
+	static auto interned() -> bool;
+
+	// while scope is alive, given name is saved instead of current one (name from snapshot)
+	struct save_as_scope {
+		std::pair<const link_name*, const std::string*> prev_;
+
+		save_as_scope(const link_name& N, const std::string& saved_name)
+			: prev_(std::exchange(saved_as_, {&N, &saved_name})) {}
+		~save_as_scope() { saved_as_ = prev_; }
+	};
+
+private:
+	std::variant<std::string, interned_t> name_;
+	inline static thread_local std::pair<const link_name*, const std::string*> saved_as_ = {};
+};
+
 /*-----------------------------------------------------------------------------
  *  link::impl
  *-----------------------------------------------------------------------------*/
 struct BS_HIDDEN_API link::impl : public blue_sky::detail::anon_async_api_mixin<link_actor_t> {
 	id_type id_;
-	std::string name_;
+	link_name name_;
 	Flags flags_;
 	/// owner node
 	std::weak_ptr<node> owner_;
@@ -57,29 +108,53 @@ struct BS_HIDDEN_API link::impl : public blue_sky::detail::anon_async_api_mixin<
 	status_handle status_[2];
 	// sync access to link's essentail data
 	std::mutex solo_;
+	/// cached info about ancestors
+	path_cache::slot path_;
+
+	/// kinds of async requests counted in link's queue
+	enum class Queued : unsigned { Data, DataNode, Populate };
+	/// number of queued requests of every kind, `coalesced_bit` marks callbacks joined to them
+	static constexpr std::uint32_t coalesced_bit = 1u << 31;
+	static constexpr std::uint32_t count_mask = coalesced_bit - 1;
+	std::atomic<std::uint32_t> queued_[3] = {};
 
 	impl(std::string&& name, Flags f)
 		: anon_async_api_mixin(async_behavior), id_(gen()), name_(std::move(name)), flags_(f)
 	{}
 
+	~impl() {
+		path_cache::on_destroyed(path_, owner_.lock());
+	}
+
 	auto rename_silent(std::string&& new_name) -> void {
 		solo_.lock();
-		name_ = std::move(new_name);
+		name_ = link_name(std::move(new_name));
 		solo_.unlock();
+		path_cache::on_rename(path_, owner_.lock());
 	}
 
 	auto rename(std::string&& new_name) -> void {
+		const auto old_name = name_.str();
 		rename_silent(std::move(new_name));
 		// [TODO] send message instead
 		if(auto O = owner_.lock()) {
-			O->on_rename(id_);
+			O->on_rename(id_, old_name);
+		}
+	}
+
+	// notify owner if status of request differs from `prev`, returns `prev`
+	auto notify_status(const link& self, Req request, ReqStatus prev) const -> ReqStatus {
+		if(req_status(request) != prev) {
+			if(auto O = owner_.lock())
+				O->on_status_changed(std::const_pointer_cast<link>(self.shared_from_this()), request, prev);
 		}
+		return prev;
 	}
 
 	auto req_status(Req request) const -> ReqStatus {
 		const auto i = (unsigned)request;
 		if(i < 2){
-			return status_[i].value;
+			return status_[i].value();
 		}
 		return ReqStatus::Void;
 	}
@@ -87,34 +162,72 @@ struct BS_HIDDEN_API link::impl : public blue_sky::detail::anon_async_api_mixin<
 	auto rs_reset(Req request, ReqStatus new_rs) {
 		const auto i = (unsigned)request;
 		if(i >= 2) return ReqStatus::Error;
-
-		// atomic set value
-		auto S = scope_atomic_flag(status_[i].flag);
-		const auto self = status_[i].value;
-		status_[i].value = new_rs;
-		return self;
+		return status_[i].reset(new_rs);
 	}
 
 	auto rs_reset_if_eq(Req request, ReqStatus self_rs, ReqStatus new_rs) {
 		const auto i = (unsigned)request;
 		if(i >= 2) return ReqStatus::Error;
-
-		// atomic set value
-		auto S = scope_atomic_flag(status_[i].flag);
-		const auto self = status_[i].value;
-		if(status_[i].value == self_rs) status_[i].value = new_rs;
-		return self;
+		return status_[i].update([=](ReqStatus self) { return self == self_rs ? new_rs : self; });
 	}
 
 	auto rs_reset_if_neq(Req request, ReqStatus self_rs, ReqStatus new_rs) {
 		const auto i = (unsigned)request;
 		if(i >= 2) return ReqStatus::Error;
+		return status_[i].update([=](ReqStatus self) { return self != self_rs ? new_rs : self; });
+	}
 
-		// atomic set value
-		auto S = scope_atomic_flag(status_[i].flag);
-		const auto self = status_[i].value;
-		if(status_[i].value != self_rs) status_[i].value = new_rs;
-		return self;
+	///////////////////////////////////////////////////////////////////////////////
+	//  bounded queue of async requests
+	//
+	auto queue_depth() const -> std::size_t;
+
+	/// callback joined to queued request together with it's own token
+	struct joined_request {
+		process_data_cb f;
+		cancel_token token;
+	};
+
+	/// reserve place in queue for request of kind `q` according to queue limits & overflow policy
+	/// returns false if request must not be sent: `f` is either coalesced or called with error
+	auto enqueue(const link& self, Queued q, process_data_cb& f, const cancel_token& token) -> bool;
+
+	/// called by actor when request starts, returns callbacks coalesced with it
+	auto dequeue(Queued q) -> std::vector<joined_request>;
+
+	/// set while link actor processes request in this thread, such thread must never block on queue
+	inline static thread_local bool in_actor_ = false;
+
+	/// execute started request `op` with `token` and pass result to it's callback and to all
+	/// callbacks joined to it, every joined callback is cancelled by it's own token only
+	template<typename Op>
+	static auto deliver(
+		Op&& op, const cancel_token& token, const sp_clink& lnk, const process_data_cb& f,
+		const std::vector<joined_request>& joined
+	) -> void {
+		struct actor_scope {
+			actor_scope() { in_actor_ = true; }
+			~actor_scope() { in_actor_ = false; }
+		} mark_actor;
+
+		auto res = token_invoke(token, op);
+		const auto cancelled = [](const auto& r) {
+			return !r && r.error().code == Error::RequestCancelled;
+		};
+		// if request was cancelled by token of it's sender, it's executed again for joined ones
+		auto joined_res = std::optional<decltype(res)>{};
+		for(const auto& J : joined) {
+			error::eval_safe([&] {
+				if(auto er = J.token.check())
+					return J.f(tl::make_unexpected(std::move(er)), lnk);
+				if(!cancelled(res))
+					return J.f(res, lnk);
+				if(!joined_res || cancelled(*joined_res))
+					joined_res = token_invoke(J.token, op);
+				J.f(*joined_res, lnk);
+			});
+		}
+		error::eval_safe([&] { f(std::move(res), lnk); });
 	}
 
 	///////////////////////////////////////////////////////////////////////////////
@@ -122,11 +235,15 @@ struct BS_HIDDEN_API link::impl : public blue_sky::detail::anon_async_api_mixin<
 	//
 	static auto async_behavior(link_actor_t::pointer self) -> link_actor_t::behavior_type {
 		return {
-			[](lnk_data_atom, const sp_clink& lnk, const process_data_cb& f) {
-				error::eval_safe([&] { f(lnk->data_ex(true), lnk); });
+			[](lnk_data_atom, const sp_clink& lnk, const process_data_cb& f, const cancel_token& token) {
+				deliver(
+					[&] { return lnk->data_ex(true); }, token, lnk, f, lnk->pimpl()->dequeue(Queued::Data)
+				);
 			},
-			[](lnk_dnode_atom, const sp_clink& lnk, const process_data_cb& f) {
-				error::eval_safe([&] { f(lnk->data_node_ex(true), lnk); });
+			[](lnk_dnode_atom, const sp_clink& lnk, const process_data_cb& f, const cancel_token& token) {
+				deliver(
+					[&] { return lnk->data_node_ex(true); }, token, lnk, f, lnk->pimpl()->dequeue(Queued::DataNode)
+				);
 			}
 		};
 	}
@@ -12,63 +12,129 @@
 #include <bs/error.h>
 #include <bs/tree/link.h>
 #include <bs/tree/errors.h>
+#include <bs/tree/cancel_token.h>
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
-#include <boost/smart_ptr/detail/yield_k.hpp>
 
 NAMESPACE_BEGIN(blue_sky) NAMESPACE_BEGIN(tree) NAMESPACE_BEGIN(detail)
 
-// microsleep until flag is released by someone else
-inline auto raise_atomic_flag(std::atomic_flag& flag) -> void {
-	for(unsigned k = 0; flag.test_and_set(std::memory_order_acquire); ++k)
-		boost::detail::yield(k);
-}
+using Req = link::Req;
+using ReqStatus = link::ReqStatus;
 
-inline auto drop_atomic_flag(std::atomic_flag& flag) {
-	flag.clear(std::memory_order_release);
-}
+// Threads waiting for Busy status to end sleep in one of shared parking slots selected by
+// address of status word (the way futex does). So links don't carry own mutex & condvar
+// and threads are woken only if someone is actually sleeping.
+struct parking_lot {
+	struct slot {
+		std::mutex guard;
+		std::condition_variable cv;
+	};
 
-// RAII raise-drop atomic flag that keeps track of raised state
-struct scope_atomic_flag {
-	explicit scope_atomic_flag(std::atomic_flag& flag, bool raise_now = true)
-		: f_(flag)
-	{
-		if(raise_now) raise();
+	static auto slots() -> std::array<slot, 64>& {
+		static std::array<slot, 64> slots_;
+		return slots_;
 	}
 
-	~scope_atomic_flag() {
-		drop();
+	static auto slot_of(const void* addr) -> slot& {
+		auto& S = slots();
+		return S[(reinterpret_cast<std::uintptr_t>(addr) >> 4) % S.size()];
 	}
 
-	inline void raise() {
-		if(!flag_set_) {
-			raise_atomic_flag(f_);
-			flag_set_ = true;
+	// wake all sleeping threads, so that they check their cancel tokens
+	static auto wake_everyone() -> void {
+		for(auto& S : slots()) {
+			{ auto guard = std::lock_guard{S.guard}; }
+			S.cv.notify_all();
 		}
 	}
+};
+
+// wake senders waiting for room in requests queue (`link::Overflow::Block`),
+// so that they check their cancel tokens
+auto wake_blocked_senders() -> void;
+
+// request status packed into single atomic word
+// lower bits hold `ReqStatus` value, `waiters_bit` is raised by thread that is going to sleep on Busy
+// status (it's raised before status is checked, so it can stay set with any status until next change)
+struct status_handle {
+	static constexpr std::uint32_t waiters_bit = 1u << 31;
+	static constexpr std::uint32_t status_mask = waiters_bit - 1;
+
+	auto value() const -> ReqStatus {
+		return ReqStatus(state_.load(std::memory_order_acquire) & status_mask);
+	}
 
-	inline void drop() {
-		if(flag_set_) {
-			drop_atomic_flag(f_);
-			flag_set_ = false;
+	// atomically apply `f(cur_status) -> new_status`, returns previous status
+	// all sleeping waiters are woken up if status was changed
+	template<typename F>
+	auto update(F&& f) -> ReqStatus {
+		auto cur = state_.load(std::memory_order_relaxed);
+		while(true) {
+			const auto cur_rs = ReqStatus(cur & status_mask);
+			const auto new_rs = f(cur_rs);
+			if(new_rs == cur_rs) return cur_rs;
+			if(state_.compare_exchange_weak(
+				cur, std::uint32_t(new_rs), std::memory_order_acq_rel, std::memory_order_relaxed
+			)) {
+				if(cur & waiters_bit) wake_all();
+				return cur_rs;
+			}
 		}
 	}
 
-private:
-	std::atomic_flag& f_;
-	bool flag_set_ = false;
-};
+	auto reset(ReqStatus new_rs) -> ReqStatus {
+		return update([=](ReqStatus) { return new_rs; });
+	}
 
-using Req = link::Req;
-using ReqStatus = link::ReqStatus;
+	// switch status to `new_rs` only if it equals to `expected`, returns true on success
+	auto reset_if_eq(ReqStatus expected, ReqStatus new_rs) -> bool {
+		auto cur = std::uint32_t(expected);
+		// waiters bit can accompany any status (see `wait_not_busy()`), so try both variants
+		if(state_.compare_exchange_strong(cur, std::uint32_t(new_rs), std::memory_order_acq_rel))
+			return true;
+		if(cur == (std::uint32_t(expected) | waiters_bit) && state_.compare_exchange_strong(
+			cur, std::uint32_t(new_rs), std::memory_order_acq_rel
+		)) {
+			wake_all();
+			return true;
+		}
+		return false;
+	}
 
-// helper struct that contain all status-related bits together
-struct status_handle {
-	volatile ReqStatus value = ReqStatus::Void;
-	std::atomic_flag flag = ATOMIC_FLAG_INIT;
-	// mutex is required to implement sleep while Busy status is set
-	std::mutex busy_wait;
+	// sleep (without spinning) until status isn't Busy or `token` is cancelled or expired,
+	// returns status observed after wakeup
+	auto wait_not_busy(const cancel_token& token = cancel_token::none()) -> ReqStatus {
+		auto& S = parking_lot::slot_of(this);
+		auto guard = std::unique_lock{S.guard};
+		const auto deadline = token.deadline();
+		while(true) {
+			// waiters bit is (re)raised under slot lock, so status change can't slip between
+			// check below and going to sleep -- `wake_all()` must grab same lock first
+			const auto cur = state_.fetch_or(waiters_bit, std::memory_order_acq_rel);
+			if(ReqStatus(cur & status_mask) != ReqStatus::Busy)
+				return ReqStatus(cur & status_mask);
+			// same for token: `cancel_token::cancel()` wakes everyone after grabbing slot lock
+			if(token.is_cancelled())
+				return ReqStatus::Busy;
+			if(deadline == cancel_token::clock::time_point::max())
+				S.cv.wait(guard);
+			else if(S.cv.wait_until(guard, deadline) == std::cv_status::timeout)
+				return value();
+		}
+	}
+
+private:
+	std::atomic<std::uint32_t> state_ = std::uint32_t(ReqStatus::Void);
+
+	auto wake_all() -> void {
+		auto& S = parking_lot::slot_of(this);
+		{ auto guard = std::lock_guard{S.guard}; }
+		S.cv.notify_all();
+	}
 };
 
 template<typename L, typename F>
@@ -77,52 +143,40 @@ static auto link_invoke(
 ) -> decltype(f(lnk)) {
 	using ret_t = decltype(f(lnk));
 
-	// make scoped atomic flag and raise it immediately
-	auto status_flag = scope_atomic_flag(status.flag);
-	// local flag indicating that we have locked busy mutex
-	bool busy_waiting = false;
+	// token of executing async request (if any)
+	const auto& token = cancel_token::current();
+	auto prev = status.value();
 
-	const auto set_status = [&status, &status_flag, &busy_waiting](ret_t&& res) {
-		// set flag depending on result
-		status_flag.raise();
-		status.value = res ?
+	const auto set_status = [&status, &prev](ret_t&& res) {
+		// set status depending on result, this also wakes up all threads waiting for result
+		// cancelled request rolls status back to value it had before the call
+		status.reset(res ?
 			res.value() ?
 				ReqStatus::OK :
 				ReqStatus::Void :
-			ReqStatus::Error;
-		// unlock busy mutex if it is locked
-		if(busy_waiting) {
-			status.busy_wait.unlock();
-			busy_waiting = false;
-		}
-		// and return
+			res.error().code == Error::RequestCancelled ?
+				prev :
+				ReqStatus::Error
+		);
 		return std::move(res);
 	};
 
-	// 1. check Busy state: return error or wait until we can capture the flag in non-Busy state
-	// [NOTE] flag is in raised state here
-	while(status.value == ReqStatus::Busy) {
-		if(!wait_if_busy) return tl::make_unexpected(error::quiet(Error::LinkBusy));
-		status_flag.drop();
-		const std::lock_guard<std::mutex> wait(status.busy_wait);
-		status_flag.raise();
+	// 1. capture non-Busy state: return error or sleep until Busy status is cleared
+	// [NOTE] if status is OK, then we don't switch it to Busy (readers aren't blocked)
+	for(;; prev = status.value()) {
+		if(auto er = token.check()) return tl::make_unexpected(std::move(er));
+		if(prev == ReqStatus::Busy) {
+			if(!wait_if_busy) return tl::make_unexpected(error::quiet(Error::LinkBusy));
+			status.wait_not_busy(token);
+		}
+		else if(prev == ReqStatus::OK || status.reset_if_eq(prev, ReqStatus::Busy))
+			break;
 	}
-	// here we always have: status is non-busy, flag is raised, busy mutex is unlocked
 
-	// 2. invoke link::f
+	// 2. invoke link::f, set status and return result
+	// [NOTE] owner node is notified about status change by caller
 	try {
-		// set Busy status (if status is OK, then we don't lock busy mutex)
-		if(status.value == ReqStatus::Void || status.value == ReqStatus::Error) {
-			status.value = ReqStatus::Busy;
-			status.busy_wait.lock();
-			busy_waiting = true;
-		}
-
-		// release status flag before possibly long operation
-		status_flag.drop();
-		// invoke operation, set status and return result
 		return set_status(f(lnk));
-		// [TODO] we have to notify parent node that content changed
 	}
 	catch(const error& e) {
 		return set_status( tl::make_unexpected(e) );
@@ -135,5 +189,14 @@ static auto link_invoke(
 	}
 }
 
+// invoke async request `op` making `token` current for calling thread
+// cancelled or expired request is dropped without execution
+template<typename Op>
+static auto token_invoke(const cancel_token& token, Op&& op) -> decltype(op()) {
+	if(auto er = token.check()) return tl::make_unexpected(std::move(er));
+	const auto S = cancel_token::scope(token);
+	return op();
+}
+
 NAMESPACE_END(detail) NAMESPACE_END(tree) NAMESPACE_END(blue_sky)
 
@@ -0,0 +1,480 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Implementation of subtree mutations log
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/log.h>
+#include <bs/tree/mutation_log.h>
+#include <bs/tree/tree.h>
+#include <bs/serialize/serialize.h>
+#include <bs/serialize/tree.h>
+#include <bs/serialize/boost_uuid.h>
+#include "node_impl.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+namespace fs = std::filesystem;
+using Key = node::Key;
+
+NAMESPACE_BEGIN()
+/*-----------------------------------------------------------------------------
+ *  log format
+ *  header: magic, version, seq of last record folded into base snapshot
+ *  records: u32 size followed by record packed with portable binary archive
+ *  all integers are little endian
+ *-----------------------------------------------------------------------------*/
+constexpr std::array<char, 4> log_magic = {'B', 'S', 'M', 'L'};
+constexpr std::uint32_t log_version = 2;
+constexpr std::size_t header_size = 16;
+
+enum class Mutation : std::uint8_t { Insert, Erase, Rename, Move, Data, Reset, Reorder };
+
+struct record {
+	std::uint64_t seq = 0;
+	Mutation kind = Mutation::Insert;
+	// path (by IDs) of node relative to logged root, destination node for move
+	std::string path;
+	// source node for move
+	std::string src_path;
+	link::id_type lid;
+	// new name for rename
+	std::string name;
+	// position of link in node
+	std::uint64_t idx = 0;
+	// inserted or changed link, all links of root for reset
+	std::vector<sp_link> links;
+	// IDs of links in new custom order
+	std::vector<link::id_type> order;
+
+	template<typename Archive>
+	auto serialize(Archive& ar) -> void {
+		ar(seq, kind, path, src_path, lid, name, idx, links, order);
+	}
+};
+
+template<typename T>
+auto put_le(std::ostream& os, T x) -> void {
+	char buf[sizeof(T)];
+	for(std::size_t i = 0; i < sizeof(T); ++i, x >>= 8)
+		buf[i] = char(x & 0xff);
+	os.write(buf, sizeof(T));
+}
+
+template<typename T>
+auto get_le(const char* buf) -> T {
+	T x = 0;
+	for(std::size_t i = sizeof(T); i > 0; --i)
+		x = (x << 8) | T((unsigned char)buf[i - 1]);
+	return x;
+}
+
+auto write_header(std::ostream& os, std::uint64_t base_seq) -> void {
+	os.write(log_magic.data(), log_magic.size());
+	put_le(os, log_version);
+	put_le(os, base_seq);
+}
+
+// write empty log to temp file and atomically replace `filename` with it
+auto restart_log(const std::string& filename, std::uint64_t base_seq) -> error {
+	const auto tmp_name = filename + ".tmp";
+	{
+		std::ofstream os(tmp_name, std::ios::out | std::ios::trunc | std::ios::binary);
+		if(!os) return error(std::string("Cannot create file ") + tmp_name);
+		write_header(os, base_seq);
+	}
+	std::error_code ec;
+	fs::rename(tmp_name, filename, ec);
+	return ec ? error(ec.message()) : perfect;
+}
+
+// reads complete records only, so it can be used on log that is being written
+class log_reader {
+public:
+	std::uint64_t base_seq = 0;
+
+	auto open(const std::string& filename) -> error {
+		is_.open(filename, std::ios::in | std::ios::binary);
+		if(!is_) return error(std::string("Cannot open file ") + filename);
+		char buf[header_size];
+		if(!is_.read(buf, header_size) || std::memcmp(buf, log_magic.data(), log_magic.size()))
+			return error(std::string("Not a mutations log: ") + filename);
+		if(get_le<std::uint32_t>(buf + 4) != log_version)
+			return error(std::string("Unsupported mutations log version: ") + filename);
+		base_seq = get_le<std::uint64_t>(buf + 8);
+		return perfect;
+	}
+
+	// continue reading from given position
+	auto seek(std::uint64_t offset) -> void {
+		offset_ = std::max<std::uint64_t>(offset, header_size);
+		is_.clear();
+		is_.seekg(offset_);
+	}
+
+	// returns false if there's no complete record
+	auto next(record& r) -> bool {
+		char sz_buf[4];
+		if(!is_.read(sz_buf, 4)) return false;
+		std::string payload(get_le<std::uint32_t>(sz_buf), '\0');
+		if(!is_.read(payload.data(), payload.size())) return false;
+
+		// damaged record is treated as end of log
+		try {
+			std::istringstream ss(payload);
+			cereal::PortableBinaryInputArchive ar(ss);
+			ar(r);
+		}
+		catch(const cereal::Exception&) {
+			return false;
+		}
+		offset_ += 4 + payload.size();
+		return true;
+	}
+
+	// position right after last complete record
+	auto offset() const -> std::uint64_t {
+		return offset_;
+	}
+
+private:
+	std::ifstream is_;
+	std::uint64_t offset_ = header_size;
+};
+
+// apply single record to subtree
+auto apply(const record& r, const sp_node& root) -> error {
+	const auto find_node = [&](const std::string& path) -> sp_node {
+		if(path.empty()) return root;
+		const auto L = deref_path(path, root, Key::ID);
+		return L ? L->data_node() : nullptr;
+	};
+	const auto N = find_node(r.path);
+	if(!N) return error::quiet(Error::KeyMismatch);
+
+	switch(r.kind) {
+	case Mutation::Insert :
+	case Mutation::Data :
+		// link with same ID is replaced, that makes replay idempotent
+		for(const auto& L : r.links) {
+			N->erase(L->id());
+			if(!N->insert(L, std::min<std::size_t>(r.idx, N->size())).second)
+				return error::quiet(Error::LinkRejected);
+		}
+		break;
+	case Mutation::Erase :
+		N->erase(r.lid);
+		break;
+	case Mutation::Rename :
+		N->rename(r.lid, r.name);
+		break;
+	case Mutation::Move : {
+		const auto src = find_node(r.src_path);
+		if(!src) return error::quiet(Error::KeyMismatch);
+		if(src->find(r.lid) == src->end()) break;
+		// destination could be written with moved link inside
+		if(src != N && N->find(r.lid) != N->end())
+			src->erase(r.lid);
+		else if(!src->move(r.lid, N, std::size_t(r.idx)).second)
+			return error::quiet(Error::LinkRejected);
+		break;
+	}
+	case Mutation::Reset :
+		N->clear();
+		N->insert(r.links);
+		break;
+	case Mutation::Reorder :
+		// links are moved to the beginning preserving given order
+		N->move(r.order, N, 0);
+		break;
+	}
+	return perfect;
+}
+
+// apply records with seq > `after_seq`, returns seq of last applied record
+auto replay_impl(log_reader& R, const sp_node& root, std::uint64_t after_seq)
+-> result_or_err<std::uint64_t> {
+	auto last_seq = std::max(after_seq, R.base_seq);
+	record r;
+	while(R.next(r)) {
+		if(r.seq <= last_seq) continue;
+		if(auto er = apply(r, root)) return tl::make_unexpected(std::move(er));
+		last_seq = r.seq;
+	}
+	return last_seq;
+}
+
+NAMESPACE_END()
+
+/*-----------------------------------------------------------------------------
+ *  mutation_log::impl
+ *-----------------------------------------------------------------------------*/
+struct mutation_log::impl {
+	const sp_node root_;
+	const std::string filename_;
+	std::ofstream os_;
+	std::uint64_t last_seq_ = 0;
+	detail::sp_subscriber sub_;
+	std::mutex guard_;
+
+	// throws `error` if log can't be opened
+	impl(const sp_link& root, std::string filename)
+		: root_(root ? root->data_node() : nullptr), filename_(std::move(filename))
+	{
+		if(!root_) throw error::quiet(Error::NotANode);
+		std::error_code ec;
+		if(fs::exists(filename_, ec)) {
+			// continue existing log, incomplete record at the tail is dropped
+			auto tail = std::uint64_t(0);
+			{
+				log_reader R;
+				if(auto er = R.open(filename_)) throw er;
+				last_seq_ = R.base_seq;
+				record r;
+				while(R.next(r)) last_seq_ = r.seq;
+				tail = R.offset();
+			}
+			if(tail < fs::file_size(filename_, ec))
+				fs::resize_file(filename_, tail, ec);
+			if(ec) throw error(ec.message());
+		}
+		else if(auto er = restart_log(filename_, 0)) throw er;
+		if(auto er = reopen()) throw er;
+	}
+
+	auto reopen() -> error {
+		os_.close();
+		os_.open(filename_, std::ios::out | std::ios::app | std::ios::binary);
+		if(!os_) return error(std::string("Cannot open file ") + filename_);
+		return perfect;
+	}
+
+	// convert absolute path (by IDs) of node to path relative to logged root
+	auto node_path(const std::string& path) const -> std::optional<std::string> {
+		const auto root_h = root_ ? root_->handle() : nullptr;
+		if(path.empty() || !root_h) return {};
+		auto base = abspath(root_h, Key::ID);
+		if(path == base) return std::string{};
+		if(base == "/") base.clear();
+		if(path.size() <= base.size() + 1 || path.compare(0, base.size(), base) || path[base.size()] != '/')
+			return {};
+		return path.substr(base.size() + 1);
+	}
+
+	auto write(record&& r) -> void {
+		r.seq = last_seq_ + 1;
+		std::ostringstream ss;
+		try {
+			cereal::PortableBinaryOutputArchive ar(ss);
+			ar(r);
+		}
+		catch(const cereal::Exception& e) {
+			bserr() << log::E("mutation_log: cannot serialize record: {}") << e.what() << log::end;
+			return;
+		}
+		const auto payload = ss.str();
+		put_le(os_, std::uint32_t(payload.size()));
+		os_.write(payload.data(), payload.size());
+		last_seq_ = r.seq;
+	}
+
+	// events come synchronously in order they happened, right after mutating thread releases nodes
+	// [NOTE] nodes can change meanwhile, so paths, positions & names are taken from event,
+	// where they were captured while node was locked
+	auto on_events(const std::vector<event>& evs) -> void {
+		std::lock_guard<std::mutex> play_solo(guard_);
+
+		for(const auto& e : evs) {
+			auto r = record{};
+			if(e.kind == Event::Overflow) {
+				// events are lost, so dump whole subtree
+				r.kind = Mutation::Reset;
+				r.links.assign(root_->begin(), root_->end());
+				write(std::move(r));
+				continue;
+			}
+
+			auto path = node_path(e.origin_path);
+			if(e.kind == Event::LinkMoved) {
+				auto src_path = node_path(e.source_path);
+				// moves across logged subtree border are inserts or erases
+				if(!src_path && !path) continue;
+				if(!src_path)
+					r.kind = Mutation::Insert;
+				else if(!path) {
+					r.kind = Mutation::Erase;
+					path = std::move(src_path);
+				}
+				else {
+					r.kind = Mutation::Move;
+					r.src_path = std::move(*src_path);
+				}
+			}
+			else if(!path) continue;
+			else if(e.kind == Event::LinkInserted)
+				r.kind = Mutation::Insert;
+			else if(e.kind == Event::LinkErased)
+				r.kind = Mutation::Erase;
+			else if(e.kind == Event::LinkRenamed)
+				r.kind = Mutation::Rename;
+			else if(e.kind == Event::DataChanged)
+				r.kind = Mutation::Data;
+			else if(e.kind == Event::Reordered) {
+				r.kind = Mutation::Reorder;
+				if(const auto N = e.origin->data_node()) {
+					for(const auto& L : N->page(Key::AnyOrder, {}, N->size()).links)
+						r.order.push_back(L->id());
+				}
+			}
+			else continue;
+
+			r.path = std::move(*path);
+			// [NOTE] link is written as it is when record is written, so subtree inserted
+			// by other thread meanwhile can already contain changes that follow in log,
+			// replaying them again is harmless
+			if(e.link) r.lid = e.link->id();
+			switch(r.kind) {
+			case Mutation::Insert :
+			case Mutation::Data :
+				r.links.push_back(e.link);
+				[[fallthrough]];
+			case Mutation::Move :
+				r.idx = e.idx;
+				break;
+			case Mutation::Rename :
+				r.name = e.name;
+				break;
+			default :
+				break;
+			}
+			write(std::move(r));
+		}
+		os_.flush();
+	}
+};
+
+/*-----------------------------------------------------------------------------
+ *  mutation_log
+ *-----------------------------------------------------------------------------*/
+mutation_log::mutation_log(sp_link root, std::string filename, std::size_t capacity)
+	: pimpl_(std::make_shared<impl>(root, std::move(filename)))
+{
+	constexpr auto filter = Event::LinkInserted | Event::LinkErased | Event::LinkRenamed |
+		Event::LinkMoved | Event::DataChanged | Event::Reordered;
+	pimpl_->sub_ = detail::node_subscriber::make(
+		[self = std::weak_ptr(pimpl_)](std::vector<event> evs) {
+			if(auto pimpl = self.lock()) pimpl->on_events(evs);
+		},
+		filter, true, capacity, true
+	);
+	pimpl_->root_->pimpl_->subscribe(pimpl_->sub_);
+}
+
+mutation_log::~mutation_log() {
+	pimpl_->root_->pimpl_->unsubscribe(pimpl_->sub_->id);
+	pimpl_->sub_->flush();
+}
+
+auto mutation_log::filename() const -> const std::string& {
+	return pimpl_->filename_;
+}
+
+auto mutation_log::last_seq() const -> std::uint64_t {
+	std::lock_guard<std::mutex> play_solo(pimpl_->guard_);
+	return pimpl_->last_seq_;
+}
+
+auto mutation_log::flush() -> void {
+	pimpl_->sub_->flush();
+}
+
+auto mutation_log::compact(const std::string& snapshot) -> error {
+	flush();
+	std::lock_guard<std::mutex> play_solo(pimpl_->guard_);
+	pimpl_->os_.close();
+	auto res = compact(snapshot, pimpl_->filename_);
+	if(auto er = pimpl_->reopen(); er && res.ok()) return er;
+	return res;
+}
+
+auto mutation_log::replay(const std::string& filename, const sp_link& root, std::uint64_t after_seq)
+-> result_or_err<std::uint64_t> {
+	const auto N = root ? root->data_node() : nullptr;
+	if(!N) return tl::make_unexpected(error::quiet(Error::NotANode));
+	log_reader R;
+	if(auto er = R.open(filename)) return tl::make_unexpected(std::move(er));
+	return replay_impl(R, N, after_seq);
+}
+
+auto mutation_log::compact(const std::string& snapshot, const std::string& filename) -> error {
+	return error::eval_safe([&]() -> error {
+		auto root = load_tree(snapshot, TreeArchive::Binary);
+		if(!root) return std::move(root.error());
+		const auto last_seq = replay(filename, *root);
+		if(!last_seq) return last_seq.error();
+
+		// replace snapshot atomically, then start log from folded seq
+		const auto tmp_name = snapshot + ".tmp";
+		if(auto er = save_tree(*root, tmp_name, TreeArchive::Binary)) return er;
+		std::error_code ec;
+		fs::rename(tmp_name, snapshot, ec);
+		if(ec) return error(ec.message());
+		return restart_log(filename, *last_seq);
+	});
+}
+
+/*-----------------------------------------------------------------------------
+ *  log_follower
+ *-----------------------------------------------------------------------------*/
+log_follower::log_follower(std::string filename, sp_link replica, std::uint64_t after_seq)
+	: filename_(std::move(filename)), replica_(std::move(replica)), last_seq_(after_seq)
+{}
+
+auto log_follower::poll() -> result_or_err<std::size_t> {
+	const auto N = replica_ ? replica_->data_node() : nullptr;
+	if(!N) return tl::make_unexpected(error::quiet(Error::NotANode));
+
+	// file is reopened every time, because compaction replaces it
+	log_reader R;
+	if(auto er = R.open(filename_)) return tl::make_unexpected(std::move(er));
+	if(R.base_seq > last_seq_)
+		return tl::make_unexpected(error("Log is compacted past replica state, replica must be reloaded"));
+	// continue from saved position if log wasn't compacted since
+	if(R.base_seq == base_seq_) R.seek(offset_);
+
+	std::size_t n_applied = 0;
+	auto res = [&]() -> error {
+		record r;
+		while(R.next(r)) {
+			if(r.seq <= last_seq_) continue;
+			if(auto er = apply(r, N)) return er;
+			last_seq_ = r.seq;
+			++n_applied;
+		}
+		return perfect;
+	}();
+	// failed record will be read again on next call
+	if(res) return tl::make_unexpected(std::move(res));
+	base_seq_ = R.base_seq;
+	offset_ = R.offset();
+	return n_applied;
+}
+
+auto log_follower::last_seq() const -> std::uint64_t {
+	return last_seq_;
+}
+
+NAMESPACE_END(blue_sky::tree)
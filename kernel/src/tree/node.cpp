@@ -8,6 +8,7 @@
 /// You can obtain one at https://mozilla.org/MPL/2.0/
 
 #include "node_impl.h"
+#include "job_queue.h"
 #include <bs/kernel/types_factory.h>
 
 #include <boost/uuid/string_generator.hpp>
@@ -19,32 +20,163 @@ NAMESPACE_BEGIN() // hidden namespace
 
 static boost::uuids::string_generator uuid_from_str;
 
+// node to be filled with clones of source leafs
+struct clone_job {
+	sp_node target;
+	std::vector<sp_link> leafs;
+};
+using clone_queue = detail::job_queue<clone_job>;
+
+// Context of clone routine that is running in this thread. Node copy ctor can't take it
+// as argument (nodes are copied by types factory & links), so routine names node it's going
+// to copy (root node or node pointed by link being cloned) and only copy of that node defers
+// leafs cloning into a job. Other node copies made meanwhile (by objects copy ctors) are complete.
+struct clone_context {
+	clone_queue& Q;
+	const node* root = nullptr;
+	const link* via = nullptr;
+
+	// true if routine copies `src` right now, claim is consumed
+	auto claim(const node& src) -> bool {
+		if(&src != root && !(via && src.handle().get() == via)) return false;
+		root = nullptr;
+		via = nullptr;
+		return true;
+	}
+};
+thread_local clone_context* active_clone = nullptr;
+
+// make context active while `f()` runs
+template<typename F>
+auto with_clone_context(clone_context& ctx, F&& f) -> void {
+	const auto prev_clone = std::exchange(active_clone, &ctx);
+	auto finally = make_scope_guard([prev_clone] { active_clone = prev_clone; });
+	f();
+}
+
+// process clone jobs by `clone_leafs(target, leafs, on_clone)`, every thread has it's own context
+template<typename F>
+auto run_clone_jobs(clone_queue& Q, F clone_leafs) -> void {
+	Q.run([&](clone_job&& j) {
+		auto ctx = clone_context{Q};
+		with_clone_context(ctx, [&] {
+			clone_leafs(j.target, j.leafs, [&](const link* L) { ctx.via = L; });
+		});
+	});
+}
+
+// compare names treating digit sequences as numbers: "item_2" < "item_10"
+auto natural_less(const std::string& lhs, const std::string& rhs) -> bool {
+	const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+	const auto skip_zeros = [](auto pos, auto end) {
+		while(pos != end && *pos == '0') ++pos;
+		return pos;
+	};
+
+	auto l = lhs.begin(), r = rhs.begin();
+	while(l != lhs.end() && r != rhs.end()) {
+		if(is_digit(*l) && is_digit(*r)) {
+			// longer number (without leading zeros) is greater, numbers of same length compare lexically
+			const auto l_beg = skip_zeros(l, lhs.end()), r_beg = skip_zeros(r, rhs.end());
+			const auto l_end = std::find_if_not(l_beg, lhs.end(), is_digit);
+			const auto r_end = std::find_if_not(r_beg, rhs.end(), is_digit);
+			if(l_end - l_beg != r_end - r_beg) return l_end - l_beg < r_end - r_beg;
+			if(const auto [lm, rm] = std::mismatch(l_beg, l_end, r_beg); lm != l_end)
+				return *lm < *rm;
+			l = l_end;
+			r = r_end;
+		}
+		else {
+			if(*l != *r) return *l < *r;
+			++l;
+			++r;
+		}
+	}
+	return l == lhs.end() && r != rhs.end();
+}
+
+// modification time of link's inode, zero if link has no inode or it's data isn't loaded yet
+auto mod_time_of(const link& L) -> timestamp {
+	// links with bundled inode can be inspected without data loading
+	if(!dynamic_cast<const ilink*>(&L) && L.req_status(link::Req::Data) != link::ReqStatus::OK)
+		return {};
+	const auto I = L.info();
+	return I ? I->mod_time : timestamp{};
+}
+
 NAMESPACE_END()
 
-using links_locker_t = std::lock_guard<std::mutex>;
+using links_locker_t = std::lock_guard<links_mutex>;
 /*-----------------------------------------------------------------------------
  *  node
  *-----------------------------------------------------------------------------*/
-node::node(std::string custom_id)
-	: objbase(true, custom_id), pimpl_(std::make_unique<node_impl>())
+node::node(std::string custom_id, Indexes idx)
+	: objbase(true, custom_id), pimpl_(std::make_unique<node_impl>(idx))
 {}
 
 node::node(const node& src)
-	: objbase(src), pimpl_(std::make_unique<node_impl>(*src.pimpl_))
-{}
+	: objbase(src), pimpl_(std::make_unique<node_impl>(*src.pimpl_, node_impl::defer_leafs))
+{
+	// leafs will be cloned by job that clone routine pushes after copy is constructed
+	if(active_clone && active_clone->claim(src)) return;
+
+	// otherwise clone leafs right here, nested nodes are cloned by jobs instead of recursion
+	// [NOTE] owner of this node's leafs isn't set (nested nodes are fine)
+	// correct this by manually calling `node::propagate_owner()` after copy is constructed
+	clone_queue Q(false);
+	auto leafs = std::move(pimpl_->pending_leafs_);
+	auto ctx = clone_context{Q};
+	with_clone_context(ctx, [&] {
+		for(auto& L : leafs) {
+			ctx.via = L.get();
+			L = L->clone(true);
+		}
+	});
+	pimpl_->bulk_insert(leafs);
+	run_clone_jobs(Q, [](auto&&... args) {
+		node_impl::clone_leafs(std::forward<decltype(args)>(args)...);
+	});
+}
 
 node::~node() = default;
 
-void node::propagate_owner(bool deep) {
-	links_locker_t my_turn(pimpl_->links_guard_);
-	// properly setup owner in node's leafs
+auto node::clone(bool parallel) const -> sp_node {
+	clone_queue Q(parallel);
+	// clone root node via types factory to correctly handle derived node types
+	sp_node res;
+	auto ctx = clone_context{Q, this};
+	with_clone_context(ctx, [&] { res = kernel::tfactory::clone_object(bs_shared_this<node>()); });
+	run_clone_jobs(Q, [](auto&&... args) {
+		node_impl::clone_leafs(std::forward<decltype(args)>(args)...);
+	});
+	return res;
+}
+
+void node::propagate_owner(bool deep, bool parallel) {
+	// properly setup owner in node's leafs, returns nested nodes
+	const auto adjust = [deep](const sp_node& N) {
+		std::vector<sp_node> children;
+		links_locker_t my_turn(N->pimpl_->links_guard_);
+		for(auto& plink : N->pimpl_->links_) {
+			auto child_node = node_impl::adjust_inserted_link(plink, N);
+			if(deep && child_node)
+				children.push_back(std::move(child_node));
+		}
+		return children;
+	};
+
 	const auto self = bs_shared_this<node>();
-	sp_node child_node;
-	for(auto& plink : pimpl_->links_) {
-		child_node = node_impl::adjust_inserted_link(plink, self);
-		if(deep && child_node)
-			child_node->propagate_owner(true);
+	if(!deep) {
+		adjust(self);
+		return;
 	}
+	// every nested node is a job, so deep chains can't overflow stack
+	auto Q = detail::job_queue<sp_node>(parallel);
+	Q.push(self);
+	Q.run([&](sp_node&& N) {
+		for(auto& child : adjust(N))
+			Q.push(std::move(child));
+	});
 }
 
 sp_link node::handle() const {
@@ -88,26 +220,32 @@ iterator<Key::ID> node::end(Key_const<Key::ID>) const {
 }
 
 iterator<Key::Name> node::begin(Key_const<Key::Name>) const {
+	pimpl_->ensure_index<Key::Name>();
 	return pimpl_->begin<Key::Name>();
 }
 
 iterator<Key::Name> node::end(Key_const<Key::Name>) const {
+	pimpl_->ensure_index<Key::Name>();
 	return pimpl_->end<Key::Name>();
 }
 
 iterator<Key::OID> node::begin(Key_const<Key::OID>) const {
+	pimpl_->ensure_index<Key::OID>();
 	return pimpl_->begin<Key::OID>();
 }
 
 iterator<Key::OID> node::end(Key_const<Key::OID>) const {
+	pimpl_->ensure_index<Key::OID>();
 	return pimpl_->end<Key::OID>();
 }
 
 iterator<Key::Type> node::begin(Key_const<Key::Type>) const {
+	pimpl_->ensure_index<Key::Type>();
 	return pimpl_->begin<Key::Type>();
 }
 
 iterator<Key::Type> node::end(Key_const<Key::Type>) const {
+	pimpl_->ensure_index<Key::Type>();
 	return pimpl_->end<Key::Type>();
 }
 
@@ -127,12 +265,12 @@ iterator<Key::AnyOrder> node::find(const std::string& key, Key key_meaning) cons
 	case Key::ID:
 		return pimpl_->find<Key::ID>(uuid_from_str(key));
 	case Key::OID:
-		return pimpl_->find<Key::OID>(key);
+		return pimpl_->find_any<Key::OID>(key);
 	case Key::Type:
-		return pimpl_->find<Key::Type>(key);
+		return pimpl_->find_any<Key::Type>(key);
 	default:
 	case Key::Name:
-		return pimpl_->find<Key::Name>(key);
+		return pimpl_->find_any<Key::Name>(key);
 	}
 }
 
@@ -153,14 +291,17 @@ std::size_t node::index(const std::string& key, Key key_meaning) const {
 
 // ---- equal_range
 range<Key::Name> node::equal_range(const std::string& link_name) const {
+	pimpl_->ensure_index<Key::Name>();
 	return pimpl_->equal_range<Key::Name>(link_name);
 }
 
 range<Key::OID> node::equal_range_oid(const std::string& oid) const {
+	pimpl_->ensure_index<Key::OID>();
 	return pimpl_->equal_range<Key::OID>(oid);
 }
 
 range<Key::Type> node::equal_type(const std::string& type_id) const {
+	pimpl_->ensure_index<Key::Type>();
 	return pimpl_->equal_range<Key::Type>(type_id);
 }
 
@@ -170,6 +311,7 @@ insert_status<Key::ID> node::insert(sp_link l, InsertPolicy pol) {
 	if(res.second) {
 		// inserted link postprocessing
 		node_impl::adjust_inserted_link(*res.first, bs_shared_this<node>());
+		pimpl_->track_subtree(*res.first);
 	}
 	else if(enumval(pol & InsertPolicy::Merge) && res.first != end<Key::ID>()) {
 		// check if we need to deep merge given links
@@ -193,9 +335,13 @@ insert_status<Key::AnyOrder> node::insert(sp_link l, iterator<> pos, InsertPolic
 		// 2. reposition an element in AnyOrder index
 		links_locker_t my_turn(pimpl_->links_guard_);
 		auto src = pimpl_->project<Key::ID>(res.first);
-		if(pos != src) {
+		// sorted node has already placed link
+		if(pos != src && !pimpl_->sort_less_) {
+			pimpl_->freeze_nolock();
 			auto& ord_idx = pimpl_->links_.get<Key_tag<Key::AnyOrder>>();
 			ord_idx.relocate(pos, src);
+			// insert event is already emitted, placement comes as move inside node
+			pimpl_->emit({Event::LinkMoved, *src}, pimpl_.get());
 			return {src, true};
 		}
 	}
@@ -212,10 +358,77 @@ insert_status<Key::ID> node::insert(std::string name, sp_obj obj, InsertPolicy p
 	);
 }
 
+// ---- move
+insert_status<Key::AnyOrder> node::move(const id_type& lid, const sp_node& dst, InsertPolicy pol) {
+	return move(lid, dst, std::size_t(-1), pol);
+}
+
+insert_status<Key::AnyOrder> node::move(
+	const id_type& lid, const sp_node& dst, std::size_t idx, InsertPolicy pol
+) {
+	if(!dst) return {end<>(), false};
+	auto res = [&] {
+		auto guard = node_impl::lock_pair(*pimpl_, *dst->pimpl_);
+		auto res = node_impl::move_nolock(*pimpl_, *dst->pimpl_, dst, lid, dst->pimpl_->pos_at(idx), pol);
+		// owner is set inside transaction, like `batch` does
+		if(res.second && dst.get() != this)
+			(*res.first)->link::reset_owner(dst);
+		return res;
+	}();
+	// sym link revalidates itself on owner change, which locks nodes
+	if(res.second && dst.get() != this)
+		node_impl::refresh_moved(*res.first, dst);
+	return res;
+}
+
+std::size_t node::move(
+	const std::vector<id_type>& lids, const sp_node& dst, std::size_t idx, InsertPolicy pol
+) {
+	if(!dst) return 0;
+	std::vector<sp_link> moved;
+	moved.reserve(lids.size());
+	{
+		auto guard = node_impl::lock_pair(*pimpl_, *dst->pimpl_);
+		auto pos = dst->pimpl_->pos_at(idx);
+		for(const auto& lid : lids) {
+			auto res = node_impl::move_nolock(*pimpl_, *dst->pimpl_, dst, lid, pos, pol);
+			if(res.second) {
+				moved.push_back(*res.first);
+				if(dst.get() != this) (*res.first)->link::reset_owner(dst);
+				// next link goes right after just moved one
+				pos = std::next(res.first);
+			}
+		}
+	}
+	if(dst.get() != this) {
+		for(const auto& L : moved)
+			node_impl::refresh_moved(L, dst);
+	}
+	return moved.size();
+}
+
+// ---- paged iteration
+auto node::page(Key order, const cursor& from, std::size_t n) const -> page_t {
+	switch(order) {
+	case Key::Name:
+		return pimpl_->page<Key::Name>(from, n);
+	case Key::OID:
+		return pimpl_->page<Key::OID>(from, n);
+	case Key::Type:
+		return pimpl_->page<Key::Type>(from, n);
+	default:
+		return pimpl_->page<Key::AnyOrder>(from, n);
+	}
+}
+
 // ---- erase
 void node::erase(const std::size_t idx) {
 	links_locker_t my_turn(pimpl_->links_guard_);
-	pimpl_->links_.get<Key_tag<Key::AnyOrder>>().erase(find(idx));
+	if(idx >= size()) return;
+	auto pos = find(idx);
+	pimpl_->freeze_nolock();
+	pimpl_->track_erase(*pos);
+	pimpl_->links_.get<Key_tag<Key::AnyOrder>>().erase(pos);
 }
 
 void node::erase(const id_type& lid) {
@@ -253,8 +466,7 @@ void node::erase(const range<Key::OID>& r) {
 }
 
 void node::clear() {
-	links_locker_t my_turn(pimpl_->links_guard_);
-	pimpl_->links_.clear();
+	pimpl_->clear();
 }
 
 // ---- deep_search
@@ -321,8 +533,34 @@ std::size_t node::rename(const std::string& key, std::string new_name, Key key_m
 	}
 }
 
-auto node::on_rename(const id_type& renamed_id) const -> void {
-	pimpl_->on_rename(renamed_id);
+auto node::on_rename(const id_type& renamed_id, const std::string& old_name) const -> void {
+	pimpl_->on_rename(renamed_id, old_name);
+}
+
+auto node::on_status_changed(const sp_link& lnk, link::Req req, link::ReqStatus prev) const -> void {
+	auto e = event{Event::LinkStatusChanged, lnk};
+	e.req = req;
+	e.prev_status = prev;
+	pimpl_->emit(std::move(e));
+}
+
+auto node::on_data_changed(const sp_link& lnk) const -> void {
+	pimpl_->bump_gen();
+	// event captures position of link, so it's emitted under lock
+	links_locker_t my_turn(pimpl_->links_guard_);
+	pimpl_->resort_nolock(lnk);
+	pimpl_->emit({Event::DataChanged, lnk});
+}
+
+auto node::subscribe(events_f f, Event filter, bool deep, std::size_t capacity) -> std::uint64_t {
+	auto S = detail::node_subscriber::make(std::move(f), filter, deep, capacity);
+	const auto res = S->id;
+	pimpl_->subscribe(std::move(S));
+	return res;
+}
+
+auto node::unsubscribe(std::uint64_t subscription_id) -> bool {
+	return pimpl_->unsubscribe(subscription_id);
 }
 
 // ---- project
@@ -355,10 +593,92 @@ std::vector<std::string> node::allowed_object_types() const {
 	return pimpl_->allowed_otypes_;
 }
 
+auto node::indexes() const -> Indexes {
+	return pimpl_->active_idx_;
+}
+
+auto node::set_indexes(Indexes idx) -> void {
+	pimpl_->reset_indexes(idx & Indexes::All);
+}
+
+auto node::enable_summary(bool on) -> bool {
+	if(on)
+		pimpl_->enable_summary();
+	else if(!pimpl_->parent_summarized())
+		pimpl_->disable_summary();
+	return pimpl_->summary_on_;
+}
+
+auto node::enable_stats(bool on) -> bool {
+	if(on)
+		pimpl_->enable_stats();
+	else if(pimpl_->stats_root() == pimpl_.get())
+		pimpl_->disable_stats();
+	return pimpl_->stats_on_;
+}
+
+auto node::natural_order() -> less_f {
+	return [](const link& lhs, const link& rhs) { return natural_less(lhs.name_ref(), rhs.name_ref()); };
+}
+
+auto node::mod_time_order() -> less_f {
+	return [](const link& lhs, const link& rhs) { return mod_time_of(lhs) < mod_time_of(rhs); };
+}
+
+auto node::sort(less_f less, bool persistent) -> void {
+	pimpl_->sort(std::move(less), persistent);
+}
+
+auto node::is_sorted() const -> bool {
+	links_locker_t my_turn(pimpl_->links_guard_);
+	return bool(pimpl_->sort_less_);
+}
+
+auto node::generation() const -> std::uint64_t {
+	return pimpl_->gen_.load(std::memory_order_acquire);
+}
+
+auto node::subtree_generation() const -> std::uint64_t {
+	pimpl_->enable_subtree_gen();
+	return pimpl_->subtree_gen_.load(std::memory_order_acquire);
+}
+
+auto node::current_generation() -> std::uint64_t {
+	return node_impl::gen_clock().load(std::memory_order_acquire);
+}
+
+auto node::stats() const -> stats_t {
+	if(!pimpl_->stats_on_) return {};
+	// lazy links loaded since last read and links counted before metrics were changed are recalculated
+	pimpl_->refresh_stats();
+	return pimpl_->stats_totals();
+}
+
+auto node::register_metric(std::string name, metric_f f) -> void {
+	detail::stats_metrics::add(std::move(name), std::move(f));
+}
+
+auto node::may_contain(const std::string& key, Key key_meaning) const -> bool {
+	switch(key_meaning) {
+	case Key::ID:
+		return pimpl_->may_contain<Key::ID>(uuid_from_str(key));
+	case Key::OID:
+		return pimpl_->may_contain<Key::OID>(key);
+	case Key::Name:
+		return pimpl_->may_contain<Key::Name>(key);
+	default:
+		return true;
+	}
+}
+
 void node::set_handle(const sp_link& handle) {
 	pimpl_->set_handle(handle);
 }
 
+auto detail::path_cache::gen(const node& N) -> gen_t& {
+	return N.pimpl_->path_gen_;
+}
+
 BS_TYPE_IMPL(node, objbase, "node", "BS tree node", true, true);
 BS_TYPE_ADD_CONSTRUCTOR(node, (std::string))
 BS_REGISTER_TYPE("kernel", node)
@@ -368,9 +688,15 @@ NAMESPACE_END(tree)
 namespace detail {
 
 BS_API void adjust_cloned_node(const sp_obj& pnode) {
-	// fix owner in node's clone
-	if(pnode->is_node())
-		std::static_pointer_cast<tree::node>(pnode)->propagate_owner();
+	if(!pnode || !pnode->is_node()) return;
+	auto N = std::static_pointer_cast<tree::node>(pnode);
+	// leafs of deferred node clone will be processed in a separate job
+	// (only copy claimed by active clone routine is deferred)
+	if(tree::active_clone && !N->pimpl_->pending_leafs_.empty())
+		tree::active_clone->Q.push({ N, std::move(N->pimpl_->pending_leafs_) });
+	// otherwise fix owner in node's clone
+	else
+		N->propagate_owner();
 }
 	
 } /* namespace detail */
@@ -0,0 +1,172 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Node events subscriber implementation
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include "node_events.h"
+#include <bs/atoms.h>
+#include <bs/detail/async_api_mixin.h>
+
+#include <caf/all.hpp>
+
+#include <algorithm>
+#include <utility>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+NAMESPACE_BEGIN()
+
+std::atomic<node_subscriber::id_type> last_id = 0;
+
+// node locks held by this thread & synchronous subscribers that wait for them to be released
+thread_local std::size_t node_locks_held = 0;
+thread_local std::vector<sp_subscriber> sync_pending;
+thread_local bool sync_delivering = false;
+
+auto deliver_sync() -> void {
+	if(node_locks_held || sync_delivering) return;
+	sync_delivering = true;
+	struct reset_flag { ~reset_flag() { sync_delivering = false; } } reset_on_exit;
+	// callbacks can produce new events
+	while(!sync_pending.empty()) {
+		for(const auto& S : std::exchange(sync_pending, {}))
+			S->flush();
+	}
+}
+
+// subscriber that calls `flush()` from it's own actor
+struct actor_subscriber :
+	node_subscriber, std::enable_shared_from_this<actor_subscriber>,
+	blue_sky::detail::anon_async_api_mixin<caf::actor>
+{
+	actor_subscriber(events_f f, Event filter, bool deep, std::size_t capacity)
+		: node_subscriber(std::move(f), filter, deep, capacity, false)
+	{}
+
+	auto start() -> void {
+		// actor holds weak ref to subscriber, so unsubscribe stops delivery immediately
+		spawn([self = weak_from_this()](caf::event_based_actor*) -> caf::behavior {
+			return {
+				[self](node_flush_atom) {
+					if(auto S = self.lock()) S->flush();
+				}
+			};
+		});
+	}
+
+	auto schedule_flush() -> void override {
+		send(node_flush_atom());
+	}
+};
+
+// subscriber that is flushed by thread that produced events
+struct sync_subscriber : node_subscriber, std::enable_shared_from_this<sync_subscriber> {
+	sync_subscriber(events_f f, Event filter, bool deep, std::size_t capacity)
+		: node_subscriber(std::move(f), filter, deep, capacity, true)
+	{}
+
+	auto schedule_flush() -> void override {
+		const auto self = shared_from_this();
+		if(std::find(sync_pending.begin(), sync_pending.end(), self) == sync_pending.end())
+			sync_pending.push_back(self);
+	}
+};
+
+NAMESPACE_END()
+
+node_subscriber::node_subscriber(events_f f, Event filter_, bool deep_, std::size_t capacity, bool sync_)
+	: id(++last_id), filter(filter_), deep(deep_), sync(sync_), f_(std::move(f)),
+	capacity_(std::max<std::size_t>(capacity, 1))
+{
+	++n_active_;
+}
+
+node_subscriber::~node_subscriber() {
+	--n_active_;
+}
+
+auto node_subscriber::make(events_f f, Event filter, bool deep, std::size_t capacity, bool sync)
+-> sp_subscriber {
+	if(sync)
+		return std::make_shared<sync_subscriber>(std::move(f), filter, deep, capacity);
+	auto res = std::make_shared<actor_subscriber>(std::move(f), filter, deep, capacity);
+	res->start();
+	return res;
+}
+
+auto node_subscriber::on_node_locked() -> void {
+	++node_locks_held;
+}
+
+auto node_subscriber::on_node_unlocked() -> void {
+	if(--node_locks_held == 0) deliver_sync();
+}
+
+auto node_subscriber::push(const event& e) -> void {
+	{
+		std::lock_guard<std::mutex> guard(guard_);
+		push_nolock(e);
+	}
+	// events produced outside of node lock are delivered immediately
+	if(sync) deliver_sync();
+}
+
+auto node_subscriber::push(const std::vector<event>& es) -> void {
+	{
+		std::lock_guard<std::mutex> guard(guard_);
+		for(const auto& e : es)
+			push_nolock(e);
+	}
+	if(sync) deliver_sync();
+}
+
+auto node_subscriber::push_nolock(const event& e) -> void {
+	// merge repeating renames, status & data changes of same link
+	if(!sync && e.link && (
+		e.kind == Event::LinkRenamed || e.kind == Event::LinkStatusChanged || e.kind == Event::DataChanged
+	)) {
+		const auto key = coalesce_key{
+			e.link->id(), enumval(e.kind) | (e.kind == Event::LinkStatusChanged ? enumval(e.req) << 8 : 0)
+		};
+		if(auto pos = pending_.find(key); pos != pending_.end()) {
+			// first event already holds previous name or status
+			buf_[pos->second].origin = e.origin;
+			return;
+		}
+		if(buf_.size() < capacity_) pending_[key] = buf_.size();
+	}
+
+	if(buf_.size() < capacity_)
+		buf_.push_back(e);
+	else
+		overflow_ = true;
+
+	// every thread that produced events must flush synchronous subscriber
+	if(!flush_scheduled_ || sync) {
+		flush_scheduled_ = true;
+		schedule_flush();
+	}
+}
+
+auto node_subscriber::flush() -> void {
+	std::lock_guard<std::mutex> one_batch_at_once(flush_guard_);
+	std::vector<event> batch;
+	{
+		std::lock_guard<std::mutex> guard(guard_);
+		batch.swap(buf_);
+		pending_.clear();
+		if(overflow_) {
+			auto& E = batch.emplace_back();
+			E.kind = Event::Overflow;
+			overflow_ = false;
+		}
+		flush_scheduled_ = false;
+	}
+	if(!batch.empty()) f_(std::move(batch));
+}
+
+NAMESPACE_END(blue_sky::tree::detail)
@@ -0,0 +1,95 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Subscriber that receives node events in batches
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/tree/events.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid_hash.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+/// Events are collected into buffer and delivered to callback by subscriber's actor.
+/// Only one flush message is pending at any time, so events that arrive while subscriber
+/// is busy are coalesced into next batch (repeating renames and status changes of same link
+/// are merged into single event).
+/// Buffer size is limited: when subscriber can't keep up, new events are dropped and
+/// single `Event::Overflow` is delivered instead, so that producer is never blocked.
+///
+/// Synchronous subscriber is flushed by thread that produced events right after it releases
+/// last node lock, so events are delivered in order they happened before mutating call returns.
+/// It's events are never coalesced and aren't postponed till batch commit (rolled back batch
+/// gives it's operations followed by inverse ones). Callback is called while no node is locked,
+/// it must not throw and events produced by callback are delivered after it returns.
+class node_subscriber {
+public:
+	using id_type = std::uint64_t;
+
+	const id_type id;
+	const Event filter;
+	// receive events from whole subtree
+	const bool deep;
+	// deliver events in producer thread
+	const bool sync;
+
+	static auto make(events_f f, Event filter, bool deep, std::size_t capacity, bool sync = false)
+	-> std::shared_ptr<node_subscriber>;
+
+	// count node locks held by calling thread, pending synchronous subscribers are flushed
+	// when last lock is released
+	static auto on_node_locked() -> void;
+	static auto on_node_unlocked() -> void;
+
+	// number of alive subscribers, events aren't generated if there are none
+	static auto n_active() -> std::size_t {
+		return n_active_.load(std::memory_order_relaxed);
+	}
+
+	virtual ~node_subscriber();
+
+	auto accepts(Event kind) const -> bool {
+		return enumval(filter & kind);
+	}
+
+	// put event into buffer and schedule delivery
+	auto push(const event& e) -> void;
+	// put several events at once, they are delivered in same batch if buffer is empty
+	auto push(const std::vector<event>& es) -> void;
+
+	// deliver buffered events to callback
+	// can be called from any thread, batches are never delivered concurrently or out of order
+	auto flush() -> void;
+
+protected:
+	node_subscriber(events_f f, Event filter, bool deep, std::size_t capacity, bool sync);
+	// request `flush()` to be called asynchronously (or after node locks are released if `sync` is set)
+	virtual auto schedule_flush() -> void = 0;
+
+private:
+	auto push_nolock(const event& e) -> void;
+
+	events_f f_;
+	const std::size_t capacity_;
+	std::vector<event> buf_;
+	// position of rename or status event of link in buffer
+	using coalesce_key = std::pair<link::id_type, std::uint32_t>;
+	std::unordered_map<coalesce_key, std::size_t, boost::hash<coalesce_key>> pending_;
+	bool flush_scheduled_ = false, overflow_ = false;
+	std::mutex guard_, flush_guard_;
+
+	inline static std::atomic<std::size_t> n_active_ = 0;
+};
+using sp_subscriber = std::shared_ptr<node_subscriber>;
+
+NAMESPACE_END(blue_sky::tree::detail)
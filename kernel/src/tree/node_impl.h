@@ -10,14 +10,28 @@
 #pragma once
 
 #include <bs/tree/node.h>
+#include <bs/tree/traverse.h>
+#include "node_summary.h"
+#include "node_stats.h"
+#include "node_events.h"
+#include "snapshot_epoch.h"
+#include "path_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <optional>
 #include <set>
 #include <mutex>
+#include <vector>
 
 NAMESPACE_BEGIN(blue_sky)
 NAMESPACE_BEGIN(tree)
 
 using links_container = node::links_container;
 using Key = node::Key;
+using Indexes = node::Indexes;
 template<Key K> using iterator = typename node::iterator<K>;
 template<Key K> using Key_tag = typename node::Key_tag<K>;
 template<Key K> using Key_type = typename node::Key_type<K>;
@@ -29,6 +43,30 @@ using Flags = link::Flags;
 using Req = link::Req;
 using ReqStatus = link::ReqStatus;
 
+// mutex of node links that counts node locks held by thread,
+// synchronous event subscribers are flushed when thread releases last of them
+class links_mutex {
+public:
+	auto lock() -> void {
+		m_.lock();
+		detail::node_subscriber::on_node_locked();
+	}
+
+	auto try_lock() -> bool {
+		if(!m_.try_lock()) return false;
+		detail::node_subscriber::on_node_locked();
+		return true;
+	}
+
+	auto unlock() -> void {
+		m_.unlock();
+		detail::node_subscriber::on_node_unlocked();
+	}
+
+private:
+	std::mutex m_;
+};
+
 /*-----------------------------------------------------------------------------
  *  node_impl
  *-----------------------------------------------------------------------------*/
@@ -36,40 +74,6 @@ class node::node_impl {
 public:
 	friend struct access_node_impl;
 
-	template<Key K = Key::ID>
-	static sp_link deep_search_impl(
-		const node_impl& n, const Key_type<K>& key,
-		std::set<Key_type<Key::ID>> active_symlinks = {}
-		//std::unordered_set<Key_type<Key::ID>, boost::hash<Key_type<Key::ID>>> active_symlinks = {}
-	) {
-		// first do direct search in leafs
-		auto r = n.find<K, K>(key);
-		if(r != n.end<K>()) return *r;
-
-		// if not succeeded search in children nodes
-		for(const auto& l : n.links_) {
-			// remember symlink
-			const auto is_symlink = l->type_id() == "sym_link";
-			if(is_symlink){
-				if(active_symlinks.find(l->id()) == active_symlinks.end())
-					active_symlinks.insert(l->id());
-				else continue;
-			}
-			// check populated status before moving to next level
-			if(l->flags() & link::LazyLoad && l->req_status(Req::DataNode) != ReqStatus::OK)
-				continue;
-			// search on next level
-			if(const auto next_n = l->data_node()) {
-				auto next_l = deep_search_impl<K>(*next_n->pimpl_, key, active_symlinks);
-				if(next_l) return next_l;
-			}
-			// remove symlink
-			if(is_symlink)
-				active_symlinks.erase(l->id());
-		}
-		return nullptr;
-	}
-
 	//static deep_merge(const node_impl& n, )
 
 	template<Key K = Key::AnyOrder>
@@ -99,26 +103,108 @@ public:
 		);
 	}
 
+	// [NOTE] index of key K must be active, see `ensure_index()`
 	template<Key K = Key::ID>
-	auto equal_range(const Key_type<K>& key) const {
+	auto equal_range(const Key_type<K>& key) const -> range<K> {
 		return links_.get<Key_tag<K>>().equal_range(key);
 	}
 
+	// call `f(link)` for links with given key until it returns false
+	// key without index is searched by scanning links
+	template<Key K, typename F>
+	auto visit_equal(const Key_type<K>& key, F&& f) const -> void {
+		if(scan_needed<K>()) {
+			const auto kex = Key_tag<K>();
+			for(const auto& L : links_.get<Key_tag<Key::AnyOrder>>())
+				if(kex(*L) == key && !f(L)) return;
+		}
+		else {
+			const auto r = equal_range<K>(key);
+			for(auto pos = r.first; pos != r.second; ++pos)
+				if(!f(*pos)) return;
+		}
+	}
+
+	// same for links which name starts with given prefix
+	template<typename F>
+	auto visit_name_prefix(const std::string& prefix, F&& f) const -> void {
+		const auto has_prefix = [&](const sp_link& L) {
+			return L->name_ref().compare(0, prefix.size(), prefix) == 0;
+		};
+		if(scan_needed<Key::Name>()) {
+			for(const auto& L : links_.get<Key_tag<Key::AnyOrder>>())
+				if(has_prefix(L) && !f(L)) return;
+		}
+		else {
+			const auto& I = links_.get<Key_tag<Key::Name>>();
+			for(auto pos = I.lower_bound(prefix); pos != I.end() && has_prefix(*pos); ++pos)
+				if(!f(*pos)) return;
+		}
+	}
+
 	template<Key K = Key::ID>
 	void erase(const Key_type<K>& key) {
 		links_locker_t my_turn(links_guard_);
-		links_.get<Key_tag<K>>().erase(key);
+		freeze_nolock();
+		if(scan_needed<K>()) {
+			auto& ord = links_.get<Key_tag<Key::AnyOrder>>();
+			const auto kex = Key_tag<K>();
+			for(auto pos = ord.begin(); pos != ord.end();) {
+				if(kex(**pos) == key) {
+					track_erase(*pos);
+					pos = ord.erase(pos);
+				}
+				else ++pos;
+			}
+		}
+		else {
+			auto& I = links_.get<Key_tag<K>>();
+			const auto r = I.equal_range(key);
+			for(auto pos = r.first; pos != r.second; ++pos)
+				track_erase(*pos);
+			I.erase(r.first, r.second);
+		}
 	}
 
 	template<Key K = Key::ID>
 	void erase(const range<K>& r) {
 		links_locker_t my_turn(links_guard_);
+		freeze_nolock();
+		for(auto pos = r.first; pos != r.second; ++pos)
+			track_erase(*pos);
 		links_.get<Key_tag<K>>().erase(r.first, r.second);
 	}
 
+	auto clear() -> void {
+		links_locker_t my_turn(links_guard_);
+		freeze_nolock();
+		for(const auto& L : links_)
+			track_erase(L);
+		links_.clear();
+	}
+
 	template<Key K = Key::ID>
 	sp_link deep_search(const Key_type<K>& key) const {
-		return this->deep_search_impl<K>(*this, key);
+		sp_link res;
+		const auto search_leafs = [&](const node_impl& n) {
+			// skip subtree that can't contain key
+			if(!n.may_contain<K>(key)) return TraverseStep::Skip;
+			if(auto r = n.find_any<K>(key); r != n.end<>()) {
+				res = *r;
+				return TraverseStep::Stop;
+			}
+			return TraverseStep::Continue;
+		};
+
+		// first do direct search in leafs, then search in children nodes
+		if(search_leafs(*this) != TraverseStep::Continue) return res;
+		const auto visit = [&](traverse_frame& F) {
+			return F.node ? search_leafs(*F.node->pimpl_) : TraverseStep::Skip;
+		};
+		for(const auto& l : links_) {
+			if(!traverse(l, visit)) break;
+		}
+		return res;
 	}
 
 	insert_status<Key::ID> insert(sp_link L, const InsertPolicy pol) {
@@ -128,10 +214,19 @@ public:
 
 		// make insertion in one single transaction
 		links_locker_t my_turn(links_guard_);
+		return insert_nolock(std::move(L), pol);
+	}
+
+	// [NOTE] caller is responsible for locking `links_guard_` and checking filters
+	// `ev` is event that is emitted on success
+	insert_status<Key::ID> insert_nolock(
+		sp_link L, const InsertPolicy pol, Event ev = Event::LinkInserted
+	) {
+		freeze_nolock();
 		// check if we have duplication name
 		iterator<Key::ID> dup;
 		if(enumval(pol & 3) > 0) {
-			dup = find<Key::Name, Key::ID>(L->name());
+			dup = find_nolock<Key::Name, Key::ID>(L->name());
 			if(dup != end<Key::ID>() && (*dup)->id() != L->id()) {
 				bool unique_found = false;
 				// first check if dup names are prohibited
@@ -141,7 +236,7 @@ public:
 					std::string new_name;
 					for(int i = 0; i < 10000; ++i) {
 						new_name = L->name() + '_' + std::to_string(i);
-						if(find<Key::Name, Key::Name>(new_name) == end<Key::Name>()) {
+						if(find_nolock<Key::Name>(new_name) == end<>()) {
 							// we've found a unique name
 							L->rename_silent(std::move(new_name));
 							unique_found = true;
@@ -157,16 +252,28 @@ public:
 		// check for duplicating OID
 		auto& I = links_.get<Key_tag<Key::ID>>();
 		if( enumval(pol & (InsertPolicy::DenyDupOID | InsertPolicy::ReplaceDupOID)) ) {
-			dup = find<Key::OID, Key::ID>(L->oid());
+			dup = find_nolock<Key::OID, Key::ID>(L->oid());
 			if(dup != end<Key::ID>()) {
 				bool is_inserted = false;
-				if(enumval(pol & InsertPolicy::ReplaceDupOID))
-					is_inserted = I.replace(dup, std::move(L));
+				if(enumval(pol & InsertPolicy::ReplaceDupOID)) {
+					const auto prev = *dup;
+					if(( is_inserted = I.replace(dup, L) )) {
+						track_erase(prev);
+						resort_nolock(L);
+						track_insert(L, ev);
+					}
+				}
 				return {dup, is_inserted};
 			}
 		}
 		// try to insert given link
-		return I.insert(std::move(L));
+		auto res = I.insert(L);
+		// link is placed before event is emitted
+		if(res.second) {
+			resort_nolock(L);
+			track_insert(L, ev);
+		}
+		return res;
 	}
 
 	template<Key K>
@@ -183,38 +290,65 @@ public:
 		links_locker_t my_turn(links_guard_);
 
 		if(pos == end<K>()) return false;
-		return links_.get<Key_tag<K>>().modify(pos, [name = std::move(new_name)](sp_link& l) {
-			l->rename_silent(std::move(name));
+		freeze_nolock();
+		const auto L = *pos;
+		const auto old_name = L->name();
+		const auto res = links_.get<Key_tag<K>>().modify(pos, [&](sp_link& l) {
+			l->rename_silent(std::move(new_name));
+			track_rename(l, old_name);
 		});
+		resort_nolock(L);
+		return res;
 	}
 
 	template<Key K>
 	std::size_t rename(const Key_type<K>& key, const std::string& new_name, bool all = false) {
 		links_locker_t my_turn(links_guard_);
 
-		range<K> matched_items = equal_range<K>(key);
-		auto& storage = links_.get<Key_tag<K>>();
-		auto renamer = [&new_name](sp_link& l) {
+		freeze_nolock();
+		auto renamed = std::vector<sp_link>{};
+		auto renamer = [&](sp_link& l) {
+			const auto old_name = l->name();
 			l->rename_silent(new_name);
+			track_rename(l, old_name);
+			renamed.push_back(l);
 		};
-		int cnt = 0;
-		for(auto pos = matched_items.begin(); pos != matched_items.end(); ++pos) {
-			storage.modify(pos, renamer);
-			++cnt;
-			if(!all) break;
+		if(scan_needed<K>()) {
+			auto& ord = links_.get<Key_tag<Key::AnyOrder>>();
+			const auto kex = Key_tag<K>();
+			for(auto pos = ord.begin(); pos != ord.end(); ++pos) {
+				if(kex(**pos) != key) continue;
+				ord.modify(pos, renamer);
+				if(!all) break;
+			}
+		}
+		else {
+			range<K> matched_items = equal_range<K>(key);
+			auto& storage = links_.get<Key_tag<K>>();
+			for(auto pos = matched_items.begin(); pos != matched_items.end(); ++pos) {
+				storage.modify(pos, renamer);
+				if(!all) break;
+			}
 		}
-		return cnt;
+		for(const auto& L : renamed)
+			resort_nolock(L);
+		return renamed.size();
 	}
 
-	void on_rename(const Key_type<Key::ID>& key) {
+	void on_rename(const Key_type<Key::ID>& key, const std::string& old_name) {
 		links_locker_t my_turn(links_guard_);
 
 		// find target link by it's ID
 		auto& I = links_.get<Key_tag<Key::ID>>();
 		auto pos = I.find(key);
 		// invoke replace as most safe & easy choice
-		if(pos != I.end())
+		if(pos != I.end()) {
+			// link is already renamed, so snapshot must see old name
+			freeze_nolock(&key, &old_name);
 			I.replace(pos, *pos);
+			track_rename(*pos, old_name);
+			resort_nolock(*pos);
+		}
 	}
 
 	template<Key K>
@@ -231,28 +365,1221 @@ public:
 		return false;
 	}
 
-	// implement shallow links copy ctor
-	node_impl(const node_impl& src)
-		: allowed_otypes_(src.allowed_otypes_)
-	{
-		for(const auto& plink : src.links_.get<Key_tag<Key::AnyOrder>>()) {
-			// non-deep clone can result in unconditional moving nodes from source
-			insert(plink->clone(true), InsertPolicy::AllowDupNames);
+	// move link with given ID from `src` to `dst` just before position `pos` in `dst`
+	// [NOTE] both nodes must be locked by caller, `dst_node` is a node that owns `dst`
+	static auto move_nolock(
+		node_impl& src, node_impl& dst, const sp_node& dst_node,
+		const Key_type<Key::ID>& lid, iterator<Key::AnyOrder> pos, InsertPolicy pol
+	) -> insert_status<Key::AnyOrder> {
+		auto& src_ord = src.links_.get<Key_tag<Key::AnyOrder>>();
+		auto src_pos = src.find<Key::ID>(lid);
+		if(src_pos == src_ord.end()) return {dst.end<>(), false};
+		auto L = *src_pos;
+
+		// moving inside same node is just a relocation
+		src.freeze_nolock();
+		if(&src == &dst) {
+			if(pos != src_pos && !src.sort_less_) {
+				src_ord.relocate(pos, src_pos);
+				src.emit({Event::LinkMoved, L}, &src);
+			}
+			return {src_pos, true};
+		}
+
+		// check that link can be moved into destination
+		// node can't be moved inside it's own subtree
+		if(
+			L->flags() & Flags::Persistent || !dst.accepts(L) ||
+			is_subtree_handle(L, dst_node)
+		)
+			return {dst.end<>(), false};
+
+		// remove link from source first, because insertion can rename it
+		const auto old_name = enumval(pol & InsertPolicy::RenameDup) ?
+			std::optional<std::string>(L->name()) : std::nullopt;
+		src.track_erase(L, Event::None);
+		const auto src_next = src_ord.erase(src_pos);
+		auto res = dst.insert_nolock(L, pol, Event::None);
+		if(!res.second) {
+			// rollback, insertion could rename link before it was rejected
+			if(old_name && L->name_ref() != *old_name) L->rename_silent(*old_name);
+			src_ord.insert(src_next, L);
+			src.track_insert(L, Event::None);
+			src.track_subtree(L);
+			return {dst.project<Key::ID>(res.first), false};
+		}
+		dst.track_subtree(L);
+		// reposition moved link in AnyOrder index, sorted node has already placed it
+		auto dst_pos = dst.project<Key::ID>(res.first);
+		if(pos != dst_pos && !dst.sort_less_)
+			dst.links_.get<Key_tag<Key::AnyOrder>>().relocate(pos, dst_pos);
+		dst.emit({Event::LinkMoved, L}, &src);
+		return {dst_pos, true};
+	}
+
+	// refresh derived state of link moved into `dst` after nodes are unlocked
+	// owner is already set, so virtual `reset_owner()` only revalidates sym link
+	static auto refresh_moved(const sp_link& L, const sp_node& dst) -> void {
+		if(L->type_id() == "sym_link" && L->owner() == dst) L->reset_owner(dst);
+	}
+
+	// iterator to element at given index or end
+	auto pos_at(std::size_t idx) const -> iterator<Key::AnyOrder> {
+		return std::next(begin<>(), std::min(idx, links_.size()));
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  paged iteration
+	//
+	template<Key K>
+	auto page(const node::cursor& from, std::size_t n) const -> node::page_t {
+		links_locker_t my_turn(links_guard_);
+		if constexpr(K != Key::AnyOrder) {
+			// without index links are ordered by key in cached copy, container isn't touched
+			if(scan_needed<K>()) {
+				const auto kex = Key_tag<K>();
+				const auto& sorted = sorted_nolock<K>();
+				struct key_less {
+					Key_tag<K> kex;
+					bool operator()(const sp_link& L, const std::string& key) const { return kex(*L) < key; }
+					bool operator()(const std::string& key, const sp_link& L) const { return key < kex(*L); }
+				};
+				return make_page<K>(sorted, from, n, [&](const std::string& key) {
+					return std::equal_range(sorted.cbegin(), sorted.cend(), key, key_less{kex});
+				});
+			}
+		}
+		const auto& I = links_.get<Key_tag<K>>();
+		return make_page<K>(I, from, n, [&](const auto& key) { return I.equal_range(key); });
+	}
+
+	// links ordered by key without index, copy is made once and reused until node is changed
+	// [NOTE] caller is responsible for locking `links_guard_`
+	template<Key K>
+	auto sorted_nolock() const -> const std::vector<sp_link>& {
+		auto& S = sorted_[std::size_t(K)];
+		const auto g = gen_.load(std::memory_order_acquire);
+		if(S.gen != g || S.links.size() != links_.size()) {
+			const auto kex = Key_tag<K>();
+			S.links.assign(begin<>(), end<>());
+			std::stable_sort(S.links.begin(), S.links.end(), [&](const sp_link& x, const sp_link& y) {
+				return kex(*x) < kex(*y);
+			});
+			S.gen = g;
+		}
+		return S.links;
+	}
+
+	// make page from sequence `I` ordered by K, `key_range(key)` gives links with given key
+	template<Key K, typename Seq, typename KeyRange>
+	auto make_page(const Seq& I, const node::cursor& from, std::size_t n, KeyRange key_range) const
+	-> node::page_t {
+		// find first link after cursor
+		auto pos = I.begin();
+		if(!from.last_id.is_nil()) {
+			if constexpr(K == Key::AnyOrder) {
+				// if last link is erased, continue from link that followed it,
+				// if both are erased, from former position of last link
+				if(const auto last = find<Key::ID, Key::AnyOrder>(from.last_id); last != I.end())
+					pos = std::next(last);
+				else if(const auto next = find<Key::ID, Key::AnyOrder>(from.next_id); next != I.end())
+					pos = next;
+				else
+					pos = pos_at(from.offset ? from.offset - 1 : 0);
+			}
+			else {
+				// same for link with given key, link that followed last one is taken
+				// only if it's key isn't less than last key
+				const auto find_in_key = [&](const id_type& lid, const Key_type<K>& key) {
+					const auto [first, last] = key_range(key);
+					const auto res = std::find_if(first, last, [&](const sp_link& L) { return L->id() == lid; });
+					return res != last ? res : I.end();
+				};
+				const auto kex = Key_tag<K>();
+				const auto next = find<Key::ID, Key::ID>(from.next_id);
+				if(const auto last = find_in_key(from.last_id, from.last_key); last != I.end())
+					pos = std::next(last);
+				else if(next != end<Key::ID>() && !(kex(**next) < from.last_key))
+					pos = find_in_key(from.next_id, kex(**next));
+				else
+					pos = key_range(from.last_key).second;
+			}
+		}
+
+		auto res = node::page_t{ {}, from };
+		res.links.reserve(std::min(n, links_.size()));
+		for(; pos != I.end() && res.links.size() < n; ++pos)
+			res.links.push_back(*pos);
+
+		auto& next = res.next;
+		if(!res.links.empty()) {
+			const auto& L = *res.links.back();
+			next.last_id = L.id();
+			if constexpr(K != Key::AnyOrder)
+				next.last_key = Key_tag<K>()(L);
+		}
+		next.next_id = pos != I.end() ? (*pos)->id() : id_type{};
+		next.offset += res.links.size();
+		next.at_end = pos == I.end();
+		return res;
+	}
+
+	// lock guards of two nodes in deadlock-free manner
+	using links_ulocker_t = std::unique_lock<links_mutex>;
+	static auto lock_pair(node_impl& lhs, node_impl& rhs) -> std::pair<links_ulocker_t, links_ulocker_t> {
+		if(&lhs == &rhs) return { links_ulocker_t(lhs.links_guard_), links_ulocker_t() };
+		links_ulocker_t l1(lhs.links_guard_, std::defer_lock), l2(rhs.links_guard_, std::defer_lock);
+		std::lock(l1, l2);
+		return { std::move(l1), std::move(l2) };
+	}
+
+	// lock guards of several nodes in deadlock-free manner (ordered by address)
+	static auto lock_all(std::vector<node_impl*> nodes) -> std::vector<links_ulocker_t> {
+		std::sort(nodes.begin(), nodes.end());
+		nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+		std::vector<links_ulocker_t> res;
+		res.reserve(nodes.size());
+		for(auto N : nodes)
+			res.emplace_back(N->links_guard_);
+		return res;
+	}
+
+	// erase link with given ID, returns erased link & it's index
+	// [NOTE] caller is responsible for locking `links_guard_`
+	auto erase_nolock(const Key_type<Key::ID>& lid, Event ev = Event::LinkErased)
+	-> std::pair<sp_link, std::size_t> {
+		auto& I = links_.get<Key_tag<Key::ID>>();
+		const auto pos = I.find(lid);
+		if(pos == I.end()) return {nullptr, 0};
+		freeze_nolock();
+		auto res = std::pair{ *pos, std::size_t(std::distance(begin<>(), project<Key::ID>(pos))) };
+		track_erase(res.first, ev);
+		I.erase(pos);
+		return res;
+	}
+
+	// insert link at given index skipping any checks, used to rollback erase
+	auto insert_at_nolock(sp_link L, std::size_t idx, Event ev = Event::LinkInserted) -> void {
+		freeze_nolock();
+		auto& ord = links_.get<Key_tag<Key::AnyOrder>>();
+		if(ord.insert(pos_at(idx), L).second) {
+			track_insert(L, ev);
+			track_subtree(L);
+		}
+	}
+
+	// rename link with given ID, returns previous name
+	auto rename_nolock(const Key_type<Key::ID>& lid, std::string new_name) -> std::optional<std::string> {
+		auto& I = links_.get<Key_tag<Key::ID>>();
+		const auto pos = I.find(lid);
+		if(pos == I.end()) return {};
+		freeze_nolock();
+		auto old_name = (*pos)->name();
+		I.modify(pos, [&](sp_link& l) {
+			l->rename_silent(std::move(new_name));
+			track_rename(l, old_name);
+		});
+		resort_nolock(*pos);
+		return old_name;
+	}
+
+	// check if link is a handle of given node or any of it's parents
+	static auto is_subtree_handle(const sp_link& L, sp_node N) -> bool {
+		while(N) {
+			const auto h = N->handle();
+			if(!h) break;
+			if(h == L) return true;
+			N = h->owner();
+		}
+		return false;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  lazy secondary indexes
+	//
+	template<Key K>
+	static constexpr auto index_flag() {
+		if constexpr(K == Key::Name) return Indexes::Name;
+		else if constexpr(K == Key::OID) return Indexes::OID;
+		else if constexpr(K == Key::Type) return Indexes::Type;
+		else return Indexes::None;
+	}
+
+	// make container args with given set of active keys
+	static auto make_ctor_args(Indexes idx) {
+		auto args = links_container::ctor_args_list();
+		boost::tuples::get<0>(args.get<2>()).active = enumval(idx & Indexes::Name);
+		boost::tuples::get<0>(args.get<3>()).active = enumval(idx & Indexes::OID);
+		boost::tuples::get<0>(args.get<4>()).active = enumval(idx & Indexes::Type);
+		return args;
+	}
+
+	auto active_idx() const -> Indexes {
+		return active_idx_.load(std::memory_order_acquire);
+	}
+
+	// rebuild container such that only given indexes are active
+	// [NOTE] invalidates all iterators, caller is responsible for locking `links_guard_`
+	auto reset_indexes_nolock(Indexes idx) -> void {
+		if(idx == active_idx()) return;
+		links_container new_links(make_ctor_args(idx));
+		auto& new_ord = new_links.get<Key_tag<Key::AnyOrder>>();
+		for(const auto& L : links_.get<Key_tag<Key::AnyOrder>>())
+			new_ord.push_back(L);
+		links_.swap(new_links);
+		active_idx_.store(idx, std::memory_order_release);
+	}
+
+	auto reset_indexes(Indexes idx) -> void {
+		links_locker_t my_turn(links_guard_);
+		reset_indexes_nolock(idx);
+	}
+
+	// build switched off index of key K on first call that must return iterators of that index,
+	// index stays active after that
+	// [NOTE] invalidates all iterators if index is built, like `reset_indexes()`
+	template<Key K>
+	auto ensure_index() -> void {
+		if(!scan_needed<K>()) return;
+		links_locker_t my_turn(links_guard_);
+		reset_indexes_nolock(active_idx() | index_flag<K>());
+	}
+
+	// true if key K isn't indexed and must be searched by scanning links
+	// [NOTE] lookups that don't return iterators of K's index never build it, but scan links
+	template<Key K>
+	auto scan_needed() const -> bool {
+		constexpr auto flag = index_flag<K>();
+		if constexpr(flag == Indexes::None) return false;
+		else return !enumval(active_idx() & flag);
+	}
+
+	// linear search in custom order
+	template<Key K>
+	auto find_scan(const Key_type<K>& key) const -> iterator<Key::AnyOrder> {
+		const auto kex = Key_tag<K>();
+		return std::find_if(begin<>(), end<>(), [&](const sp_link& L) { return kex(*L) == key; });
+	}
+
+	// find link by any key, key without index is searched by linear scan
+	// [NOTE] caller is responsible for locking `links_guard_`
+	template<Key K, Key R = Key::AnyOrder>
+	auto find_nolock(const Key_type<K>& key) const -> iterator<R> {
+		if(scan_needed<K>())
+			return links_.project<Key_tag<R>>(find_scan<K>(key));
+		return find<K, R>(key);
+	}
+
+	template<Key K, Key R = Key::AnyOrder>
+	auto find_any(const Key_type<K>& key) const -> iterator<R> {
+		if(scan_needed<K>())
+			return links_.project<Key_tag<R>>(find_scan<K>(key));
+		return find<K, R>(key);
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  subtree summary
+	//
+	using node_summary = detail::node_summary;
+	using SKind = node_summary::Kind;
+	using summary_locker_t = std::lock_guard<std::mutex>;
+
+	template<Key K>
+	auto may_contain(const Key_type<K>& key) const -> bool {
+		if constexpr(K == Key::ID || K == Key::Name || K == Key::OID) {
+			const auto h = [&] {
+				if constexpr(K == Key::ID) return node_summary::hash(key);
+				else return node_summary::hash(K == Key::Name ? SKind::Name : SKind::OID, key);
+			}();
+			summary_locker_t my_turn(summary_guard_);
+			return !summary_ || summary_->may_contain(h);
+		}
+		else return true;
+	}
+
+	// node that is owned by link (link is node's handle)
+	static auto owned_node(const sp_link& L) -> sp_node {
+		if(L->req_status(Req::DataNode) != ReqStatus::OK) return nullptr;
+		auto N = L->data_node_ex(false).value_or(nullptr);
+		return N && N->handle() == L ? N : nullptr;
+	}
+
+	// how link's keys are summarized
+	enum class LinkKind { Hard, Escape };
+
+	static auto link_kind(const link& L) -> LinkKind {
+		// other links (sym, weak, fusion, etc) can lead outside of subtree or change pointee,
+		// so their OID & subtree aren't summarized and summary of parent can't prune anything
+		return L.type_id() == "hard_link" ? LinkKind::Hard : LinkKind::Escape;
+	}
+
+	// nested node which keys are summarized together with hard link `L`
+	// `S` is summary of node that contains `L`, if it's null link is classified from scratch
+	// hard link to node that it doesn't own is marked as opaque (it's counted as escape)
+	static auto summarized_subtree(const sp_link& L, const node_summary* S, bool& opaque) -> sp_node {
+		opaque = false;
+		if(link_kind(*L) != LinkKind::Hard) return nullptr;
+		if(S && S->is_opaque(L->id())) {
+			opaque = true;
+			return nullptr;
 		}
-		// [NOTE] links are in invalid state (no owner set) now
-		// correct this by manually calling `node::propagate_owner()` after copy is constructed
+		auto N = owned_node(L);
+		if(!N && !S) opaque = L->req_status(Req::DataNode) == ReqStatus::OK;
+		return N;
+	}
+
+	// hashed keys of single link
+	struct link_keys {
+		std::uint64_t id, name, oid;
+		LinkKind kind;
+
+		link_keys(const link& L)
+			: id(node_summary::hash(L.id())), name(node_summary::hash(SKind::Name, L.name_ref())),
+			oid(0), kind(link_kind(L))
+		{
+			if(kind == LinkKind::Hard) oid = node_summary::hash(SKind::OID, L.oid());
+		}
+
+		auto apply(node_summary& S, int sign) const -> void {
+			S.add(id, sign);
+			S.add(name, sign);
+			if(kind == LinkKind::Hard)
+				S.add(oid, sign);
+			else
+				S.add_escape(sign);
+		}
+	};
+
+	// keys of links in subtree
+	struct subtree_keys {
+		std::vector<link_keys> keys;
+		// number of opaque links
+		int escapes = 0;
+
+		auto apply(node_summary& S, int sign) const -> void {
+			for(const auto& k : keys)
+				k.apply(S, sign);
+			S.add_escape(sign * escapes);
+		}
+	};
+
+	// collect keys of links in node `N` and all nested nodes, summary of every node is locked while read
+	// opaque links of `N` are recorded in `record` if `N` has no summary yet
+	// [NOTE] links are read without locking, like in other readers of tree
+	static auto collect_keys(
+		const node_impl& N, subtree_keys& res, bool root_locked = false, node_summary* record = nullptr
+	) -> void {
+		std::vector<sp_node> nested;
+		const auto visit = [&](const node_impl& n, node_summary* rec) {
+			const auto S = n.summary_.get();
+			for(const auto& L : n.links_) {
+				res.keys.emplace_back(*L);
+				bool opaque;
+				if(auto sub = summarized_subtree(L, S, opaque))
+					nested.push_back(std::move(sub));
+				else if(opaque) {
+					++res.escapes;
+					if(rec) rec->mark_opaque(L->id());
+				}
+			}
+		};
+
+		if(root_locked)
+			visit(N, record);
+		else {
+			summary_locker_t my_turn(N.summary_guard_);
+			visit(N, record);
+		}
+		while(!nested.empty()) {
+			const auto sub = std::move(nested.back());
+			nested.pop_back();
+			const auto& n = *sub->pimpl_;
+			summary_locker_t my_turn(n.summary_guard_);
+			visit(n, nullptr);
+		}
+	}
+
+	// apply `f` to summaries of this node and all it's ancestors
+	// every summary is updated under it's lock, overloaded summary is rebuilt with larger capacity
+	template<typename F>
+	auto update_summary(F&& f) const -> void {
+		auto cur = this;
+		// keep ancestor alive while updating
+		sp_node cur_node;
+		while(true) {
+			{
+				summary_locker_t my_turn(cur->summary_guard_);
+				if(!cur->summary_) break;
+				f(*cur->summary_);
+				if(cur->summary_->overloaded()) cur->rebuild_summary_nolock();
+			}
+			const auto h = cur->handle_.lock();
+			if(!h || !(cur_node = h->owner())) break;
+			cur = cur_node->pimpl_.get();
+		}
+	}
+
+	// fill summary from scratch with doubled capacity
+	// [NOTE] caller is responsible for locking `summary_guard_`
+	auto rebuild_summary_nolock() const -> void {
+		auto keys = subtree_keys{};
+		collect_keys(*this, keys, true);
+		summary_->reset(2 * keys.keys.size());
+		keys.apply(*summary_, 1);
+	}
+
+	// add (sign = 1) or remove (sign = -1) keys of link itself
+	auto summary_add_keys(const link& L, int sign) const -> void {
+		if(!summary_on_) return;
+		const auto keys = link_keys(L);
+		update_summary([&](node_summary& S) { keys.apply(S, sign); });
+	}
+
+	// add keys of subtree that link leads to, added node starts maintaining summary
+	auto summary_add_subtree(const sp_link& L) const -> void {
+		if(!summary_on_) return;
+		auto keys = subtree_keys{};
+		bool opaque;
+		if(const auto N = summarized_subtree(L, nullptr, opaque)) {
+			N->pimpl_->enable_summary();
+			collect_keys(*N->pimpl_, keys);
+		}
+		else if(opaque) {
+			// link leads to subtree which changes aren't tracked, so anything may be there
+			summary_locker_t my_turn(summary_guard_);
+			if(!summary_) return;
+			summary_->mark_opaque(L->id());
+			keys.escapes = 1;
+		}
+		else return;
+		update_summary([&](node_summary& S) { keys.apply(S, 1); });
+	}
+
+	// remove keys of link and it's subtree, must be called before link is erased
+	auto summary_remove(const sp_link& L) const -> void {
+		if(!summary_on_) return;
+		auto keys = subtree_keys{};
+		keys.keys.emplace_back(*L);
+		{
+			summary_locker_t my_turn(summary_guard_);
+			if(!summary_) return;
+			if(summary_->unmark_opaque(L->id())) keys.escapes = 1;
+		}
+		if(!keys.escapes && link_kind(*L) == LinkKind::Hard) {
+			if(const auto N = owned_node(L))
+				collect_keys(*N->pimpl_, keys);
+		}
+		update_summary([&](node_summary& S) { keys.apply(S, -1); });
+	}
+
+	auto summary_rename(const std::string& old_name, const std::string& new_name) const -> void {
+		if(!summary_on_) return;
+		const auto h_old = node_summary::hash(SKind::Name, old_name);
+		const auto h_new = node_summary::hash(SKind::Name, new_name);
+		update_summary([&](node_summary& S) {
+			S.add(h_old, -1);
+			S.add(h_new, 1);
+		});
+	}
+
+	// nodes of owned subtree in breadth-first order, starting from this node
+	auto subtree_nodes() const -> std::vector<sp_node> {
+		auto res = std::vector<sp_node>{};
+		const auto add_nested = [&](const node_impl& n) {
+			for(const auto& L : n.links_) {
+				if(link_kind(*L) != LinkKind::Hard) continue;
+				if(auto N = owned_node(L)) res.push_back(std::move(N));
+			}
+		};
+		add_nested(*this);
+		for(std::size_t i = 0; i < res.size(); ++i)
+			add_nested(*res[i]->pimpl_);
+		return res;
+	}
+
+	// build summary of this node and whole subtree
+	// summaries are built bottom-up, so that ready nested summaries give opaque links of their nodes
+	auto enable_summary() -> void {
+		if(summary_on_) return;
+		const auto nested = subtree_nodes();
+		const auto build = [](node_impl& n) {
+			if(n.summary_on_) return;
+			auto S = std::make_unique<node_summary>();
+			auto keys = subtree_keys{};
+			collect_keys(n, keys, false, S.get());
+			S->reset(keys.keys.size());
+			keys.apply(*S, 1);
+
+			summary_locker_t my_turn(n.summary_guard_);
+			n.summary_ = std::move(S);
+			n.summary_on_ = true;
+		};
+		for(auto pos = nested.rbegin(); pos != nested.rend(); ++pos)
+			build(*(*pos)->pimpl_);
+		build(*this);
+	}
+
+	// drop summary of this node and whole subtree
+	auto disable_summary() -> void {
+		if(!summary_on_) return;
+		const auto drop = [](node_impl& n) {
+			summary_locker_t my_turn(n.summary_guard_);
+			n.summary_on_ = false;
+			n.summary_.reset();
+		};
+		drop(*this);
+		for(const auto& N : subtree_nodes())
+			drop(*N->pimpl_);
+	}
+
+	// true if parent node maintains summary
+	auto parent_summarized() const -> bool {
+		const auto h = handle_.lock();
+		const auto parent = h ? h->owner() : nullptr;
+		return parent && parent->pimpl_->summary_on_;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  subtree stats
+	//
+	using node_stats = detail::node_stats;
+	using stats_locker_t = std::unique_lock<std::mutex>;
+
+	// hard & fusion links hold their objects, others only refer to objects owned elsewhere
+	static auto owns_object(const link& L) -> bool {
+		const auto ltype = L.type_id();
+		return ltype == "hard_link" || ltype == "fusion_link";
+	}
+
+	// add stats delta to ancestors of node `cur` that count it as their child
+	// `cur_lock` holds stats of `cur`, stats are locked hand-over-hand from child to parent,
+	// so delta can't be added twice or lost when child is counted by parent concurrently
+	// ancestors' version is lowered to `version` (min version of subtree)
+	static auto propagate_stats(
+		const node_impl* cur, stats_locker_t cur_lock, const stats_t& delta, int sign,
+		std::size_t version = std::size_t(-1)
+	) -> void {
+		if(detail::is_zero(delta) && version == std::size_t(-1)) return;
+		// keep ancestor alive while it's locked
+		sp_node cur_node;
+		while(true) {
+			const auto h = cur->handle_.lock();
+			auto parent = h ? h->owner() : nullptr;
+			if(!parent) break;
+			auto& P = *parent->pimpl_;
+			auto parent_lock = stats_locker_t(P.stats_guard_);
+			if(!P.stats_) break;
+			if(const auto C = P.stats_->child(h->id()); !C || C->pimpl_.get() != cur) break;
+			cur_lock = std::move(parent_lock);
+			P.stats_->add(delta, sign);
+			P.stats_->lower_version(version);
+			cur_node = std::move(parent);
+			cur = &P;
+		}
+	}
+
+	// apply stats delta to this node and all it's ancestors
+	auto update_stats(const stats_t& delta, int sign) const -> void {
+		auto my_lock = stats_locker_t(stats_guard_);
+		if(!stats_) return;
+		stats_->add(delta, sign);
+		propagate_stats(this, std::move(my_lock), delta, sign);
+	}
+
+	// (re)calc contribution of link itself
+	auto stats_add_link(const sp_link& L) const -> void {
+		if(!stats_on_) return;
+		auto own = node_stats::link_stats(L, owns_object(*L));
+		auto my_lock = stats_locker_t(stats_guard_);
+		if(!stats_) return;
+		const auto delta = stats_->set_own(L->id(), std::move(own));
+		stats_->add(delta, 1);
+		propagate_stats(this, std::move(my_lock), delta, 1);
+	}
+
+	// count stats of node `N` owned by link `lid` in stats of this node
+	// child is locked before this node, like in `propagate_stats()`
+	auto stats_attach(const link::id_type& lid, const sp_node& N) const -> void {
+		const auto& C = *N->pimpl_;
+		auto child_lock = stats_locker_t(C.stats_guard_);
+		if(!C.stats_) return;
+		auto my_lock = stats_locker_t(stats_guard_);
+		// link can be erased or it's node can be counted meanwhile
+		if(!stats_ || !stats_->has_link(lid) || stats_->child(lid)) return;
+		auto delta = C.stats_->totals();
+		delta.nodes += 1;
+		const auto version = C.stats_->version();
+		stats_->set_child(lid, N);
+		child_lock.unlock();
+		stats_->add(delta, 1);
+		stats_->lower_version(version);
+		propagate_stats(this, std::move(my_lock), delta, 1, version);
+	}
+
+	// add stats of node owned by link, added node starts maintaining stats
+	auto stats_add_subtree(const sp_link& L) const -> void {
+		if(!stats_on_) return;
+		if(const auto N = owned_node(L)) {
+			N->pimpl_->enable_stats();
+			stats_attach(L->id(), N);
+		}
+	}
+
+	// must be called before link is erased
+	auto stats_remove(const sp_link& L) const -> void {
+		if(!stats_on_) return;
+		// lock child node (if link has one) before this node, like in `propagate_stats()`
+		auto my_lock = stats_locker_t(stats_guard_, std::defer_lock);
+		auto child_lock = stats_locker_t();
+		sp_node child;
+		while(true) {
+			my_lock.lock();
+			if(!stats_) return;
+			auto cur_child = stats_->child(L->id());
+			if(cur_child == child) break;
+			my_lock.unlock();
+			child_lock = cur_child ? stats_locker_t(cur_child->pimpl_->stats_guard_) : stats_locker_t();
+			child = std::move(cur_child);
+		}
+
+		auto E = stats_->remove(L->id());
+		if(child && child->pimpl_->stats_) {
+			detail::add_stats(E.own, child->pimpl_->stats_->totals(), 1);
+			E.own.nodes += 1;
+		}
+		if(child_lock) child_lock.unlock();
+		stats_->add(E.own, -1);
+		propagate_stats(this, std::move(my_lock), E.own, -1);
+	}
+
+	// calc stats of this node and whole subtree
+	// nodes are counted bottom-up, every node is locked only while it's own links are counted
+	auto enable_stats() -> void {
+		if(stats_on_) return;
+		// nested nodes that don't maintain stats yet, breadth-first
+		auto nested = std::vector<sp_node>{};
+		const auto add_nested = [&](const node_impl& n) {
+			links_locker_t my_turn(n.links_guard_);
+			for(const auto& L : n.links_) {
+				if(auto N = owned_node(L); N && !N->pimpl_->stats_on_)
+					nested.push_back(std::move(N));
+			}
+		};
+		add_nested(*this);
+		for(std::size_t i = 0; i < nested.size(); ++i)
+			add_nested(*nested[i]->pimpl_);
+
+		for(auto pos = nested.rbegin(); pos != nested.rend(); ++pos)
+			(*pos)->pimpl_->build_stats();
+		build_stats();
+	}
+
+	// count links of this node and add stats of nested nodes
+	auto build_stats() -> void {
+		links_locker_t my_turn(links_guard_);
+		if(stats_on_) return;
+		auto S = std::make_unique<node_stats>();
+		auto totals = stats_t{};
+		auto children = std::vector<sp_link>{};
+		for(const auto& L : links_) {
+			auto own = node_stats::link_stats(L, owns_object(*L));
+			detail::add_stats(totals, own, 1);
+			S->set_own(L->id(), std::move(own));
+			if(owned_node(L)) children.push_back(L);
+		}
+		S->add(totals, 1);
+		{
+			auto my_lock = stats_locker_t(stats_guard_);
+			stats_ = std::move(S);
+			stats_on_ = true;
+		}
+		// nodes inserted after subtree was scanned start maintaining stats here
+		for(const auto& L : children)
+			stats_add_subtree(L);
+	}
+
+	// drop stats of this node and whole subtree
+	auto disable_stats() -> void {
+		const auto drop = [](node_impl& n, std::vector<sp_node>& children) {
+			auto my_lock = stats_locker_t(n.stats_guard_);
+			if(!n.stats_) return;
+			auto nested = n.stats_->children();
+			children.insert(children.end(), nested.begin(), nested.end());
+			n.stats_on_ = false;
+			n.stats_.reset();
+		};
+		auto nested = std::vector<sp_node>{};
+		drop(*this, nested);
+		for(std::size_t i = 0; i < nested.size(); ++i)
+			drop(*nested[i]->pimpl_, nested);
+	}
+
+	auto stats_totals() const -> stats_t {
+		auto my_lock = stats_locker_t(stats_guard_);
+		return stats_ ? stats_->totals() : stats_t{};
+	}
+
+	// topmost ancestor that maintains stats
+	auto stats_root() -> node_impl* {
+		auto res = this;
+		while(true) {
+			const auto h = res->handle_.lock();
+			const auto parent = h ? h->owner() : nullptr;
+			if(!parent || !parent->pimpl_->stats_on_) return res;
+			res = parent->pimpl_.get();
+		}
+	}
+
+	// recalc outdated contributions of links in subtree: lazy links that are loaded since stats
+	// were calculated and all links of nodes which stats were calculated with other set of metrics
+	// only subtrees that contain such links are visited, nodes are updated bottom-up in place
+	auto refresh_stats() -> void {
+		const auto version = detail::stats_metrics::version();
+		// subtree version is min version of it's nodes, so current subtree can be skipped
+		const auto outdated = [&](const node_impl& n, std::vector<sp_node>& children) {
+			auto my_lock = stats_locker_t(n.stats_guard_);
+			if(!n.stats_ || (n.stats_->version() == version && !n.stats_->n_unloaded())) return false;
+			auto nested = n.stats_->children();
+			children.insert(children.end(), nested.begin(), nested.end());
+			return true;
+		};
+		auto nested = std::vector<sp_node>{};
+		if(!outdated(*this, nested)) return;
+		auto visited = std::vector<sp_node>{};
+		for(std::size_t i = 0; i < nested.size(); ++i) {
+			if(outdated(*nested[i]->pimpl_, nested))
+				visited.push_back(nested[i]);
+		}
+
+		for(auto pos = visited.rbegin(); pos != visited.rend(); ++pos)
+			(*pos)->pimpl_->recalc_stats(version);
+		recalc_stats(version);
+	}
+
+	// recalc contributions of lazy links loaded since stats were calculated
+	// or contributions of all links if stats were calculated with metrics of other version
+	auto recalc_stats(std::size_t version) -> void {
+		links_locker_t my_turn(links_guard_);
+		auto lids = std::vector<link::id_type>{};
+		bool all;
+		{
+			auto my_lock = stats_locker_t(stats_guard_);
+			if(!stats_) return;
+			all = stats_->version() != version;
+			if(!all) lids = stats_->unloaded().first;
+		}
+
+		auto links = std::vector<sp_link>{};
+		if(all)
+			links.assign(begin(), end());
+		else {
+			for(const auto& lid : lids) {
+				const auto pos = find<Key::ID, Key::ID>(lid);
+				if(pos != end<Key::ID>() && !node_stats::is_unloaded(**pos)) links.push_back(*pos);
+			}
+		}
+		// metrics are calculated outside of stats lock
+		auto owns = std::vector<stats_t>{};
+		owns.reserve(links.size());
+		for(const auto& L : links)
+			owns.push_back(node_stats::link_stats(L, owns_object(*L)));
+		{
+			auto my_lock = stats_locker_t(stats_guard_);
+			if(!stats_) return;
+			auto delta = stats_t{};
+			for(std::size_t i = 0; i < links.size(); ++i)
+				detail::add_stats(delta, stats_->set_own(links[i]->id(), std::move(owns[i])), 1);
+			stats_->add(delta, 1);
+			if(all) stats_->set_version(version);
+			propagate_stats(this, std::move(my_lock), delta, 1);
+		}
+		// nodes of just loaded links are counted now
+		for(const auto& L : links)
+			stats_add_subtree(L);
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  snapshots
+	//
+	using epoch_t = snapshot::epoch_t;
+	using snapshot_epochs = detail::snapshot_epochs;
+
+	// copy of current links list
+	auto make_leafs_nolock(
+		const Key_type<Key::ID>* renamed = nullptr, const std::string* old_name = nullptr
+	) const -> snapshot::leafs_t {
+		auto res = std::make_shared<std::vector<snapshot::leaf>>();
+		res->reserve(links_.size());
+		for(const auto& L : links_) {
+			res->push_back({
+				L, renamed && L->id() == *renamed ? *old_name : L->name()
+			});
+		}
+		return res;
+	}
+
+	// save links list before first change after snapshot is taken
+	// `renamed` link is already renamed & it's name in saved version is set to `old_name`
+	// [NOTE] must be called before every change of links list
+	auto freeze_nolock(
+		const Key_type<Key::ID>* renamed = nullptr, const std::string* old_name = nullptr
+	) -> void {
+		// list shared with readers & sorted copies become outdated
+		auto shared = std::move(shared_leafs_);
+		for(auto& S : sorted_) {
+			if(!S.links.empty()) S.links.clear();
+		}
+		// saved lists are dropped when snapshots that can see them are released
+		const auto last = snapshot_epochs::last_alive();
+		if(!last || last <= frozen_epoch_) return;
+
+		// list that readers already got is saved as is, it was made before link was renamed
+		auto leafs = shared && !renamed ? std::move(shared) : make_leafs_nolock(renamed, old_name);
+		std::vector<snapshot::leafs_t> dropped;
+		{
+			std::lock_guard<std::mutex> guard(frozen_->guard);
+			dropped = frozen_->prune_nolock();
+			frozen_->list.emplace_back(last, std::move(leafs));
+		}
+		frozen_epoch_ = last;
+		snapshot_epochs::track(last, frozen_);
+	}
+
+	// links list visible from snapshot taken in epoch `e`
+	// list of unchanged node is made once and shared by all readers until node is changed
+	auto snapshot_leafs(epoch_t e) const -> snapshot::leafs_t {
+		links_locker_t my_turn(links_guard_);
+		{
+			std::lock_guard<std::mutex> guard(frozen_->guard);
+			for(const auto& [v_epoch, v_leafs] : frozen_->list) {
+				if(v_epoch >= e) return v_leafs;
+			}
+		}
+		if(!shared_leafs_) shared_leafs_ = make_leafs_nolock();
+		return shared_leafs_;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  events
+	//
+	using sp_subscriber = detail::sp_subscriber;
+
+	auto subscribe(sp_subscriber S) -> void {
+		std::lock_guard<std::mutex> guard(subs_guard_);
+		subscribers_.push_back(std::move(S));
+	}
+
+	auto unsubscribe(detail::node_subscriber::id_type sid) -> bool {
+		std::lock_guard<std::mutex> guard(subs_guard_);
+		const auto pos = std::find_if(
+			subscribers_.begin(), subscribers_.end(), [&](const auto& S) { return S->id == sid; }
+		);
+		if(pos == subscribers_.end()) return false;
+		subscribers_.erase(pos);
+		return true;
+	}
+
+	// pass event to subscribers of this node and deep subscribers of all ancestors
+	// move event is also passed to source node `src` & it's ancestors, but only once to every subscriber
+	auto emit(event&& e, const node_impl* src = nullptr) const -> void {
+		if(e.kind == Event::None || !detail::node_subscriber::n_active()) return;
+		e.origin = handle_.lock();
+		if(src) e.source = src->handle_.lock();
+
+		std::vector<sp_subscriber> targets;
+		const auto collect = [&](const node_impl* start) {
+			auto cur = start;
+			sp_node cur_node;
+			while(true) {
+				{
+					std::lock_guard<std::mutex> guard(cur->subs_guard_);
+					for(const auto& S : cur->subscribers_) {
+						if(
+							(cur == start || S->deep) && S->accepts(e.kind) &&
+							std::find(targets.begin(), targets.end(), S) == targets.end()
+						)
+							targets.push_back(S);
+					}
+				}
+				const auto h = cur->handle_.lock();
+				if(!h || !(cur_node = h->owner())) break;
+				cur = cur_node->pimpl_.get();
+			}
+		};
+		collect(this);
+		if(src) collect(src);
+		if(std::any_of(targets.begin(), targets.end(), [](const auto& S) { return S->sync; }))
+			capture_nolock(e);
+		for(const auto& S : targets) {
+			// synchronous subscribers get events in order they happen, even inside batch
+			if(deferred_events_ && !S->sync)
+				deferred_events_->emplace_back(S, e);
+			else
+				S->push(e);
+		}
+	}
+
+	// fill event with current state of origin node
+	// [NOTE] caller is responsible for locking `links_guard_`, except for status change
+	auto capture_nolock(event& e) const -> void {
+		if(e.origin) e.origin_path = detail::path_cache::abspath(*e.origin, Key::ID);
+		if(e.source) e.source_path = detail::path_cache::abspath(*e.source, Key::ID);
+		if(!e.link || e.kind == Event::LinkStatusChanged) return;
+		e.name = e.link->name();
+		if(enumval(e.kind & (Event::LinkInserted | Event::LinkMoved | Event::DataChanged)))
+			e.idx = std::distance(begin<>(), find<Key::ID, Key::AnyOrder>(e.link->id()));
+	}
+
+	// while set, events emitted by this thread are collected here instead of delivery
+	using deferred_events_t = std::vector<std::pair<sp_subscriber, event>>;
+	inline static thread_local deferred_events_t* deferred_events_ = nullptr;
+
+	// deliver collected events, every subscriber receives it's events at once
+	static auto deliver_deferred(deferred_events_t& evs) -> void {
+		std::vector<std::pair<sp_subscriber, std::vector<event>>> batches;
+		for(auto& [S, e] : evs) {
+			auto pos = std::find_if(
+				batches.begin(), batches.end(), [&S = S](const auto& b) { return b.first == S; }
+			);
+			if(pos == batches.end())
+				pos = batches.insert(batches.end(), {S, {}});
+			pos->second.push_back(std::move(e));
+		}
+		evs.clear();
+		for(const auto& [S, es] : batches)
+			S->push(es);
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  generation counters
+	//
+	using gen_t = std::uint64_t;
+
+	// generations are taken from global clock, so they can be compared between nodes
+	static auto gen_clock() -> std::atomic<gen_t>& {
+		static auto clock_ = std::atomic<gen_t>{0};
+		return clock_;
+	}
+
+	// raise counter to `g` unless it's already newer
+	static auto raise_gen(std::atomic<gen_t>& cnt, gen_t g) -> void {
+		auto cur = cnt.load(std::memory_order_relaxed);
+		while(cur < g && !cnt.compare_exchange_weak(cur, g, std::memory_order_release)) {}
+	}
+
+	// mark node as changed and propagate change to ancestors that track subtree generation
+	auto bump_gen() const -> void {
+		const auto g = gen_clock().fetch_add(1, std::memory_order_acq_rel) + 1;
+		raise_gen(gen_, g);
+		auto cur = this;
+		sp_node cur_node;
+		while(cur->subtree_gen_on_.load(std::memory_order_acquire)) {
+			raise_gen(cur->subtree_gen_, g);
+			const auto h = cur->handle_.lock();
+			if(!h || !(cur_node = h->owner())) break;
+			cur = cur_node->pimpl_.get();
+		}
+	}
+
+	// start tracking generation of this node and whole subtree
+	// subtree is scanned top-down with explicit work list, every node is locked only while it's links
+	// are read, then generations of nested nodes are collected bottom-up
+	auto enable_subtree_gen() -> void {
+		// flag is set first, so that changes made while subtree is scanned aren't lost
+		if(subtree_gen_on_.exchange(true)) return;
+		// nested node and index of it's parent in work list (npos for this node)
+		constexpr auto npos = std::size_t(-1);
+		struct item { sp_node N; std::size_t parent; };
+		auto nested = std::vector<item>{};
+		const auto scan = [&](node_impl& n, std::size_t idx) {
+			links_locker_t my_turn(n.links_guard_);
+			raise_gen(n.subtree_gen_, n.gen_.load(std::memory_order_acquire));
+			for(const auto& L : n.links_) {
+				if(auto N = owned_node(L)) nested.push_back({std::move(N), idx});
+			}
+		};
+		scan(*this, npos);
+		for(std::size_t i = 0; i < nested.size(); ++i) {
+			auto& n = *nested[i].N->pimpl_;
+			if(!n.subtree_gen_on_.exchange(true)) scan(n, i);
+		}
+
+		for(auto i = nested.size(); i-- > 0;) {
+			const auto& [N, parent] = nested[i];
+			auto& P = parent == npos ? *this : *nested[parent].N->pimpl_;
+			raise_gen(P.subtree_gen_, N->pimpl_->subtree_gen_.load(std::memory_order_acquire));
+		}
+	}
+
+	// inserted node starts tracking subtree generation
+	auto subtree_gen_add(const sp_link& L) const -> void {
+		if(!subtree_gen_on_.load(std::memory_order_acquire)) return;
+		if(const auto N = owned_node(L)) {
+			N->pimpl_->enable_subtree_gen();
+			raise_gen(subtree_gen_, N->pimpl_->subtree_gen_.load(std::memory_order_acquire));
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  persistent sort of custom order
+	//
+	// stable sort of custom order, comparator is remembered if order is persistent
+	auto sort(node::less_f less, bool persistent) -> void {
+		links_locker_t my_turn(links_guard_);
+		if(less) {
+			freeze_nolock();
+			links_.get<Key_tag<Key::AnyOrder>>().sort(
+				[&](const sp_link& lhs, const sp_link& rhs) { return less(*lhs, *rhs); }
+			);
+			bump_gen();
+			emit({Event::Reordered});
+		}
+		sort_less_ = persistent ? std::move(less) : nullptr;
+	}
+
+	// move link to it's sorted position (after all links that aren't greater than it)
+	// [NOTE] caller is responsible for locking `links_guard_`
+	auto resort_nolock(const sp_link& L) -> void {
+		if(!sort_less_ || !L) return;
+		auto& ord = links_.get<Key_tag<Key::AnyOrder>>();
+		const auto pos = find<Key::ID, Key::AnyOrder>(L->id());
+		if(pos == ord.end()) return;
+
+		// check if link is already in place
+		const auto next = std::next(pos);
+		if(
+			(pos == ord.begin() || !sort_less_(*L, **std::prev(pos))) &&
+			(next == ord.end() || !sort_less_(**next, *L))
+		)
+			return;
+
+		// move link to the end, then binary search it's place among the rest links,
+		// so user comparator is called O(log N) times (sequenced index still steps iterators)
+		freeze_nolock();
+		ord.relocate(ord.end(), pos);
+		const auto last = std::prev(ord.end());
+		const auto dst = std::upper_bound(
+			ord.begin(), last, L, [&](const sp_link& lhs, const sp_link& rhs) { return sort_less_(*lhs, *rhs); }
+		);
+		if(dst != last) ord.relocate(dst, last);
+	}
+
+	// hooks that update summary, stats & generation and emit event
+	auto track_insert(const sp_link& L, Event ev = Event::LinkInserted) const -> void {
+		summary_add_keys(*L, 1);
+		stats_add_link(L);
+		bump_gen();
+		emit({ev, L});
+	}
+
+	auto track_subtree(const sp_link& L) const -> void {
+		summary_add_subtree(L);
+		if(deferred_subtrees_)
+			deferred_subtrees_->push_back(L);
+		else
+			track_nested(L);
+	}
+
+	// nested node starts maintaining stats & generation, that locks it
+	auto track_nested(const sp_link& L) const -> void {
+		stats_add_subtree(L);
+		subtree_gen_add(L);
+	}
+
+	// while set, links which nested nodes must be tracked are collected here, because
+	// thread holds locks of nodes (batch) that can be nested nodes themselves
+	inline static thread_local std::vector<sp_link>* deferred_subtrees_ = nullptr;
+
+	// track nested nodes of collected links that are still contained in their owners
+	// [NOTE] must be called after nodes are unlocked
+	static auto track_deferred(const std::vector<sp_link>& links) -> void {
+		for(const auto& L : links) {
+			const auto N = L->owner();
+			if(!N) continue;
+			auto& n = *N->pimpl_;
+			links_locker_t my_turn(n.links_guard_);
+			if(n.find<Key::ID, Key::ID>(L->id()) != n.end<Key::ID>())
+				n.track_nested(L);
+		}
+	}
+
+	auto track_erase(const sp_link& L, Event ev = Event::LinkErased) const -> void {
+		summary_remove(L);
+		stats_remove(L);
+		bump_gen();
+		emit({ev, L});
+	}
+
+	auto track_rename(const sp_link& L, const std::string& old_name) const -> void {
+		summary_rename(old_name, L->name_ref());
+		bump_gen();
+		auto e = event{Event::LinkRenamed, L};
+		e.old_name = old_name;
+		emit(std::move(e));
+	}
+
+	// copy ctor that only remembers source leafs, they are cloned later by queue of clone jobs
+	struct defer_leafs_t {};
+	static constexpr auto defer_leafs = defer_leafs_t{};
+
+	node_impl(const node_impl& src, defer_leafs_t)
+		: links_(make_ctor_args(src.active_idx())), active_idx_(src.active_idx()),
+		allowed_otypes_(src.allowed_otypes_),
+		pending_leafs_(src.links_.get<Key_tag<Key::AnyOrder>>().begin(), src.links_.get<Key_tag<Key::AnyOrder>>().end()),
+		sort_less_(src.sort_less_)
+	{}
+
+	// clone leafs of target node and insert clones with owner fixed
+	// nested nodes aren't cloned recursively, they push their own jobs to active clone queue
+	// `on_clone(L)` is called before every link is cloned and with nullptr after all
+	template<typename F>
+	static auto clone_leafs(const sp_node& target, std::vector<sp_link>& leafs, F&& on_clone) -> void {
+		for(auto& L : leafs) {
+			on_clone(L.get());
+			L = L->clone(true);
+		}
+		on_clone(nullptr);
+		target->pimpl_->bulk_insert(leafs);
+		for(const auto& L : leafs)
+			adjust_inserted_link(L, target);
+	}
+
+	// insert already cloned links in one transaction, skipping any checks except filters
+	// only successfully inserted links are left in `leafs`
+	auto bulk_insert(std::vector<sp_link>& leafs) -> void {
+		links_locker_t my_turn(links_guard_);
+		freeze_nolock();
+		auto& ord_idx = links_.get<Key_tag<Key::AnyOrder>>();
+		leafs.erase(std::remove_if(leafs.begin(), leafs.end(), [&](const sp_link& L) {
+			return !L || !accepts(L) || !ord_idx.push_back(L).second;
+		}), leafs.end());
 	}
 
 	void set_handle(const sp_link& new_handle) {
 		// remove node from existing owner if it differs from owner of new handle
-		if(const auto old_handle = handle_.lock()) {
+		const auto old_handle = handle_.lock();
+		if(old_handle) {
 			const auto owner = old_handle->owner();
 			if(owner && (!new_handle || owner != new_handle->owner()))
 				owner->erase(old_handle->id());
 		}
 
-		// set new handle link
+		exchange_handle(new_handle);
+	}
+
+	// set new handle without touching owner of previous one, returns previous handle
+	auto exchange_handle(const sp_link& new_handle) -> sp_link {
+		auto old_handle = handle_.lock();
 		handle_ = new_handle;
+		detail::path_cache::on_handle_changed(old_handle, new_handle, path_gen_);
+		return old_handle;
+	}
+
+	// node which handle is switched to `L` when it's inserted, if it can be obtained without loading
+	// other links (sym, weak, remote, etc) resolve their node via `propagate_handle()`
+	static auto handled_node(const sp_link& L) -> sp_node {
+		if(!owns_object(*L) || L->req_status(Req::DataNode) != ReqStatus::OK) return nullptr;
+		return L->data_node_ex(false).value_or(nullptr);
 	}
 
 	// postprocessing of just inserted link
@@ -274,14 +1601,85 @@ public:
 		return lnk->propagate_handle().value_or(nullptr);
 	}
 
-	node_impl() = default;
+	node_impl(Indexes idx = Indexes::All)
+		: links_(make_ctor_args(idx)), active_idx_(idx)
+	{}
+
+	// links of nested nodes are handed to work list of outermost destructor instead of
+	// being destroyed recursively, so that deep chains can't overflow stack
+	~node_impl() {
+		auto dying = std::vector<sp_link>(begin(), end());
+		{
+			// saved lists can be pruned by released snapshot meanwhile
+			std::lock_guard<std::mutex> guard(frozen_->guard);
+			for(const auto& [epoch, leafs] : frozen_->list) {
+				for(const auto& leaf : *leafs)
+					dying.push_back(leaf.link);
+			}
+			frozen_->list.clear();
+		}
+		links_.clear();
+		shared_leafs_.reset();
+		if(graveyard_) {
+			graveyard_->insert(
+				graveyard_->end(), std::make_move_iterator(dying.begin()), std::make_move_iterator(dying.end())
+			);
+			return;
+		}
+
+		graveyard_ = &dying;
+		while(!dying.empty()) {
+			// destroying last link to nested node appends its links to `dying`
+			auto L = std::move(dying.back());
+			dying.pop_back();
+		}
+		graveyard_ = nullptr;
+	}
 
 	std::weak_ptr<link> handle_;
+	// generation of cached paths in tree this node is root of
+	detail::path_cache::gen_t path_gen_ = 1;
 	links_container links_;
+	// set of maintained secondary indexes
+	std::atomic<Indexes> active_idx_;
 	std::vector<std::string> allowed_otypes_;
+	// source leafs that are waiting to be cloned into this node
+	std::vector<sp_link> pending_leafs_;
+	// links left by nodes destroyed in this thread, see `~node_impl()`
+	inline static thread_local std::vector<sp_link>* graveyard_ = nullptr;
+	// comparator that custom order is kept sorted by, null if order is arbitrary
+	node::less_f sort_less_;
+	// summary of keys in subtree, maintained if not null, protected by `summary_guard_`
+	std::unique_ptr<node_summary> summary_;
+	// set when summary is maintained, checked before locking summary
+	std::atomic<bool> summary_on_ = false;
+	mutable std::mutex summary_guard_;
+	// stats of subtree, maintained if not null, protected by `stats_guard_`
+	std::unique_ptr<node_stats> stats_;
+	// set when stats are maintained, checked before locking stats
+	std::atomic<bool> stats_on_ = false;
+	mutable std::mutex stats_guard_;
+	// generation of last change of this node & whole subtree (latter is maintained if flag is set)
+	mutable std::atomic<gen_t> gen_ = 0, subtree_gen_ = 0;
+	std::atomic<bool> subtree_gen_on_ = false;
+	// links ordered by keys without index, see `sorted_nolock()`
+	struct sorted_links {
+		gen_t gen = 0;
+		std::vector<sp_link> links;
+	};
+	mutable std::array<sorted_links, 4> sorted_;
+	// links lists saved for alive snapshots
+	const detail::sp_frozen_versions frozen_ = std::make_shared<detail::frozen_versions>();
+	// epoch when links list was saved last time
+	epoch_t frozen_epoch_ = snapshot_epochs::current();
+	// current links list given to snapshot readers, reset on every change
+	mutable snapshot::leafs_t shared_leafs_;
+	// event subscribers
+	std::vector<sp_subscriber> subscribers_;
+	mutable std::mutex subs_guard_;
 	// temp guard until caf-based tree implementation is ready
-	std::mutex links_guard_;
-	using links_locker_t = std::lock_guard<std::mutex>;
+	mutable links_mutex links_guard_;
+	using links_locker_t = std::lock_guard<links_mutex>;
 };
 
 NAMESPACE_END(tree)
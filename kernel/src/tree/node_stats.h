@@ -0,0 +1,226 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Aggregated statistics of node's subtree (counts, per-type stats, additive metrics)
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/tree/node.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid_hash.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+using stats_t = node::stats_t;
+
+// add (sign = 1) or subtract (sign = -1) stats
+// [NOTE] counters are unsigned, but modulo arithmetic gives correct result if total is non-negative
+inline auto add_stats(stats_t& lhs, const stats_t& rhs, int sign) -> void {
+	const auto usign = std::size_t(sign);
+	lhs.links += usign * rhs.links;
+	lhs.nodes += usign * rhs.nodes;
+	lhs.unloaded += usign * rhs.unloaded;
+	for(const auto& [type_id, cnt] : rhs.types) {
+		const auto pos = lhs.types.try_emplace(type_id, 0).first;
+		if(!(pos->second += usign * cnt)) lhs.types.erase(pos);
+	}
+	for(const auto& [name, value] : rhs.metrics)
+		lhs.metrics[name] += sign * value;
+}
+
+// true if adding stats changes nothing
+inline auto is_zero(const stats_t& s) -> bool {
+	return !s.links && !s.nodes && !s.unloaded && s.types.empty() && std::all_of(
+		s.metrics.begin(), s.metrics.end(), [](const auto& m) { return m.second == 0; }
+	);
+}
+
+/// Registry of user-defined additive metrics, every registration bumps version
+/// so that stats calculated earlier are recalculated on next read.
+class stats_metrics {
+public:
+	static auto add(std::string name, node::metric_f f) -> void {
+		auto& self = instance();
+		std::unique_lock<std::shared_mutex> guard(self.guard_);
+		if(f)
+			self.metrics_[std::move(name)] = std::move(f);
+		else
+			self.metrics_.erase(name);
+		++self.version_;
+	}
+
+	static auto version() -> std::size_t {
+		return instance().version_.load(std::memory_order_acquire);
+	}
+
+	// calc all registered metrics of given link
+	static auto calc(const sp_link& L, stats_t& dst) -> void {
+		auto& self = instance();
+		std::shared_lock<std::shared_mutex> guard(self.guard_);
+		for(const auto& [name, f] : self.metrics_)
+			dst.metrics[name] = f(L);
+	}
+
+private:
+	std::unordered_map<std::string, node::metric_f> metrics_;
+	std::atomic<std::size_t> version_ = 0;
+	std::shared_mutex guard_;
+
+	static auto instance() -> stats_metrics& {
+		static stats_metrics self;
+		return self;
+	}
+};
+
+/// Stats of subtree = sum of contributions of node's links and stats of child nodes.
+/// Contribution of every link is remembered, so link is subtracted exactly as it was added,
+/// even if pointed object or lazy load status had changed since then.
+class node_stats {
+public:
+	// contribution of single link
+	struct link_entry {
+		stats_t own;
+		// child node which stats were added
+		sp_node child;
+	};
+
+	node_stats() : version_(stats_metrics::version()) {}
+
+	// true if link is lazy and pointed data (or node) isn't loaded yet
+	static auto is_unloaded(const link& L) -> bool {
+		if(!(L.flags() & link::LazyLoad)) return false;
+		const auto pending = [&](link::Req req) {
+			const auto s = L.req_status(req);
+			return s == link::ReqStatus::Void || s == link::ReqStatus::Busy;
+		};
+		if(pending(link::Req::Data)) return true;
+		if(L.req_status(link::Req::Data) != link::ReqStatus::OK || !pending(link::Req::DataNode))
+			return false;
+		// data is loaded, but node isn't extracted yet
+		const auto obj = L.data();
+		return obj && obj->is_node();
+	}
+
+	// calc contribution of link itself (without subtree)
+	// [NOTE] sym & weak links point to objects that are owned by other links, so they are only counted
+	static auto link_stats(const sp_link& L, bool owns_object) -> stats_t {
+		auto res = stats_t{};
+		res.links = 1;
+		if(is_unloaded(*L))
+			res.unloaded = 1;
+		else if(owns_object) {
+			res.types[L->obj_type_id()] = 1;
+			stats_metrics::calc(L, res);
+		}
+		return res;
+	}
+
+	auto totals() const -> stats_t {
+		std::lock_guard<std::mutex> guard(guard_);
+		return totals_;
+	}
+
+	auto n_unloaded() const -> std::size_t {
+		std::lock_guard<std::mutex> guard(guard_);
+		return totals_.unloaded;
+	}
+
+	// version of metrics registry used to calc stats of subtree (min version of subtree nodes)
+	auto version() const -> std::size_t {
+		std::lock_guard<std::mutex> guard(guard_);
+		return version_;
+	}
+
+	auto set_version(std::size_t v) -> void {
+		std::lock_guard<std::mutex> guard(guard_);
+		version_ = v;
+	}
+
+	auto lower_version(std::size_t v) -> void {
+		std::lock_guard<std::mutex> guard(guard_);
+		version_ = std::min(version_, v);
+	}
+
+	// remember link contribution & return delta for totals
+	auto set_own(const link::id_type& lid, stats_t own) -> stats_t {
+		std::lock_guard<std::mutex> guard(guard_);
+		auto& E = entries_[lid];
+		auto delta = own;
+		add_stats(delta, E.own, -1);
+		E.own = std::move(own);
+		return delta;
+	}
+
+	// remember child node which stats are added to this node
+	auto set_child(const link::id_type& lid, sp_node child) -> void {
+		std::lock_guard<std::mutex> guard(guard_);
+		entries_[lid].child = std::move(child);
+	}
+
+	auto has_link(const link::id_type& lid) const -> bool {
+		std::lock_guard<std::mutex> guard(guard_);
+		return entries_.find(lid) != entries_.end();
+	}
+
+	// child node counted for given link
+	auto child(const link::id_type& lid) const -> sp_node {
+		std::lock_guard<std::mutex> guard(guard_);
+		const auto pos = entries_.find(lid);
+		return pos != entries_.end() ? pos->second.child : nullptr;
+	}
+
+	auto children() const -> std::vector<sp_node> {
+		std::vector<sp_node> res;
+		std::lock_guard<std::mutex> guard(guard_);
+		for(const auto& [lid, E] : entries_)
+			if(E.child) res.push_back(E.child);
+		return res;
+	}
+
+	// forget link & return it's contribution
+	auto remove(const link::id_type& lid) -> link_entry {
+		std::lock_guard<std::mutex> guard(guard_);
+		auto pos = entries_.find(lid);
+		if(pos == entries_.end()) return {};
+		auto res = std::move(pos->second);
+		entries_.erase(pos);
+		return res;
+	}
+
+	// IDs of links that weren't loaded when their contribution was calculated
+	// and child nodes having such links in subtree
+	auto unloaded() const -> std::pair<std::vector<link::id_type>, std::vector<sp_node>> {
+		std::pair<std::vector<link::id_type>, std::vector<sp_node>> res;
+		std::lock_guard<std::mutex> guard(guard_);
+		for(const auto& [lid, E] : entries_) {
+			if(E.own.unloaded) res.first.push_back(lid);
+			if(E.child) res.second.push_back(E.child);
+		}
+		return res;
+	}
+
+	auto add(const stats_t& delta, int sign) -> void {
+		std::lock_guard<std::mutex> guard(guard_);
+		add_stats(totals_, delta, sign);
+	}
+
+private:
+	stats_t totals_;
+	std::unordered_map<link::id_type, link_entry, boost::hash<link::id_type>> entries_;
+	// version of metrics registry used to calc stats
+	std::size_t version_;
+	mutable std::mutex guard_;
+};
+
+NAMESPACE_END(blue_sky::tree::detail)
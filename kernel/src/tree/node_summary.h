@@ -0,0 +1,143 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Summary of keys contained in node's subtree (counting Bloom filter)
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/common.h>
+#include <bs/tree/link.h>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid_hash.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+/// Counting Bloom filter over IDs, names and OIDs of all links in subtree.
+/// If `may_contain()` returns false, key is definitely not in subtree.
+/// Filter is sized for expected number of keys and counters are allocated when first key is added.
+/// When number of keys grows far beyond capacity, filter reports every key as present
+/// until it's rebuilt with larger capacity.
+/// [NOTE] summary isn't thread-safe, owner node protects it with separate mutex
+class node_summary {
+public:
+	static constexpr std::size_t n_hashes = 3;
+	// gives ~3% false positives at full capacity
+	static constexpr std::size_t counters_per_key = 8;
+	static constexpr std::size_t min_counters = 64;
+
+	enum class Kind : std::uint64_t { ID = 1, Name = 2, OID = 3 };
+
+	static auto hash(Kind kind, std::size_t h) -> std::uint64_t {
+		// mix key hash with kind salt (splitmix64 finalizer)
+		std::uint64_t x = h ^ (std::uint64_t(kind) * 0x9e3779b97f4a7c15ULL);
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+	static auto hash(const link::id_type& id) -> std::uint64_t {
+		return hash(Kind::ID, boost::hash<link::id_type>()(id));
+	}
+	static auto hash(Kind kind, const std::string& key) -> std::uint64_t {
+		return hash(kind, std::hash<std::string>()(key));
+	}
+
+	explicit node_summary(std::size_t capacity = 0) : capacity_(capacity) {}
+
+	// drop all keys and set new capacity, opaque links are kept
+	auto reset(std::size_t capacity) -> void {
+		capacity_ = capacity;
+		counters_.clear();
+		counters_.shrink_to_fit();
+		n_keys_ = 0;
+		escapes_ = 0;
+	}
+
+	// add (sign = 1) or remove (sign = -1) key with given hash
+	auto add(std::uint64_t h, int sign) -> void {
+		if(counters_.empty()) {
+			if(sign < 0) return;
+			counters_.resize(n_counters(capacity_));
+		}
+		const auto mask = counters_.size() - 1;
+		for_each_pos(h, mask, [&](std::size_t pos) { bump(counters_[pos], sign); });
+		n_keys_ = std::max<std::ptrdiff_t>(n_keys_ + sign, 0);
+	}
+
+	// count links that can lead outside of subtree or to subtree that can't be summarized
+	auto add_escape(int sign) -> void {
+		escapes_ += sign;
+	}
+
+	// links to nodes that aren't summarized (counted as escapes)
+	auto mark_opaque(const link::id_type& lid) -> void {
+		opaque_.insert(lid);
+	}
+	auto unmark_opaque(const link::id_type& lid) -> bool {
+		return opaque_.erase(lid) > 0;
+	}
+	auto is_opaque(const link::id_type& lid) const -> bool {
+		return opaque_.find(lid) != opaque_.end();
+	}
+
+	// true if filter holds too many keys and must be rebuilt
+	auto overloaded() const -> bool {
+		return std::size_t(n_keys_) > 2 * std::max(capacity_, min_counters / counters_per_key);
+	}
+
+	auto n_keys() const -> std::size_t { return std::size_t(n_keys_); }
+
+	auto may_contain(std::uint64_t h) const -> bool {
+		if(escapes_ > 0 || overloaded()) return true;
+		if(counters_.empty()) return false;
+		bool res = true;
+		for_each_pos(h, counters_.size() - 1, [&](std::size_t pos) {
+			res = res && counters_[pos] > 0;
+		});
+		return res;
+	}
+
+private:
+	using counter_t = std::uint16_t;
+	static constexpr auto saturated = std::numeric_limits<counter_t>::max();
+
+	std::vector<counter_t> counters_;
+	std::size_t capacity_;
+	std::ptrdiff_t n_keys_ = 0;
+	int escapes_ = 0;
+	std::unordered_set<link::id_type, boost::hash<link::id_type>> opaque_;
+
+	// power of 2 that fits given number of keys
+	static auto n_counters(std::size_t capacity) -> std::size_t {
+		std::size_t res = min_counters;
+		while(res < capacity * counters_per_key) res <<= 1;
+		return res;
+	}
+
+	template<typename F>
+	static auto for_each_pos(std::uint64_t h, std::size_t mask, F&& f) -> void {
+		// double hashing
+		const auto h1 = h, h2 = (h >> 32) | 1;
+		for(std::size_t i = 0; i < n_hashes; ++i)
+			f(std::size_t(h1 + i * h2) & mask);
+	}
+
+	// saturated counter is never decremented, that can only give false positives
+	static auto bump(counter_t& c, int delta) -> void {
+		if(c == saturated) return;
+		const auto x = int(c) + delta;
+		c = x <= 0 ? 0 : x >= saturated ? saturated : counter_t(x);
+	}
+};
+
+NAMESPACE_END(blue_sky::tree::detail)
@@ -0,0 +1,88 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Cache of link's ancestor chain: root node, root handle and absolute paths
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/tree/node.h>
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+/// Link caches info about it's ancestors: root node, root handle and absolute paths.
+/// Every node holds generation of paths inside tree it is root of. Cached info is valid while
+/// link has same owner, cached root is still a root and it's generation is unchanged.
+/// Generation of tree is bumped when node inside it gets new handle or node's handle changes
+/// owner or name or is destroyed, so changes in one tree don't invalidate caches of others.
+/// Owner change or rename of other links only drop their own cache.
+/// Cache entry is allocated on first lookup, so links that are never asked for path pay
+/// only for a pointer and a flag.
+struct BS_HIDDEN_API path_cache {
+	using Key = node::Key;
+	using gen_t = std::atomic<std::uint64_t>;
+
+	// calculated info
+	struct entry {
+		// owner, root node and it's generation entry was calculated for
+		std::weak_ptr<node> owner;
+		std::weak_ptr<node> root;
+		std::uint64_t gen = 0;
+		std::weak_ptr<const link> root_h;
+		// paths by ID, Name and Type
+		// [NOTE] OID can change with pointed object, so it isn't cached
+		std::optional<std::string> paths[3];
+		std::mutex guard;
+	};
+
+	// stored inside link
+	struct slot {
+		std::atomic<entry*> E = nullptr;
+		// set if link is a handle of some node
+		std::atomic<bool> is_handle = false;
+
+		slot() = default;
+		slot(const slot&) = delete;
+		~slot() { delete E.load(std::memory_order_acquire); }
+	};
+
+	// hooks
+	static auto on_rename(slot& S, const sp_node& owner) -> void;
+	static auto on_owner_changed(const link& L, const sp_node& prev_owner) -> void;
+	// `node_gen` is generation of node that changes handle
+	static auto on_handle_changed(const sp_link& prev_handle, const sp_link& new_handle, gen_t& node_gen) -> void;
+	// called before link with given owner is destroyed
+	static auto on_destroyed(slot& S, const sp_node& owner) -> void;
+
+	/// abs path of link, empty string if `path_unit` isn't cached
+	static auto abspath(const link& L, Key path_unit) -> std::string;
+	/// top node reached by climbing owners (nullptr if link has no owner) and it's handle
+	static auto root(const link& L) -> std::pair<sp_node, sp_clink>;
+
+private:
+	struct root_info {
+		sp_node root;
+		sp_clink root_h;
+		std::uint64_t gen = 0;
+	};
+
+	static auto get(const link& L) -> slot&;
+	static auto get_entry(const link& L) -> entry&;
+	// generation stored in node
+	static auto gen(const node& N) -> gen_t&;
+	// invalidate caches of all links in tree that contains `N`
+	static auto bump_tree(const sp_node& N) -> void;
+	// valid root info of link with given owner, climbs only up to first ancestor with valid cache
+	static auto sync(const link& L) -> root_info;
+	// returns cached root info if it's valid for given owner
+	// [NOTE] caller is responsible for locking `E.guard`
+	static auto cached_nolock(const entry& E, const sp_node& owner) -> std::optional<root_info>;
+};
+
+NAMESPACE_END(blue_sky::tree::detail)
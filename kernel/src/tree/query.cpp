@@ -0,0 +1,199 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Implementation of tree query
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/query.h>
+#include "node_impl.h"
+#include "tree_impl.h"
+#include "job_queue.h"
+
+#include <atomic>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+using detail::can_call_dnode;
+
+/*-----------------------------------------------------------------------------
+ *  query execution
+ *-----------------------------------------------------------------------------*/
+struct query::runner {
+	// node to process & it's depth
+	using job = std::pair<sp_node, std::size_t>;
+
+	const query& q;
+	const consumer_f& f;
+	detail::job_queue<job> jobs;
+
+	std::mutex consumer_guard;
+	std::size_t n_found = 0;
+	std::atomic<bool> stop = false;
+
+	runner(const query& q_, const consumer_f& f_)
+		: q(q_), f(f_), jobs(q_.parallel_)
+	{}
+
+	auto run() -> std::size_t {
+		if(!q.root_ || !q.limit_) return 0;
+		jobs.push({q.root_, 0});
+		jobs.run([this](job&& j) { process(j.first->pimpl_.get(), j.second); });
+		return n_found;
+	}
+
+	// check all filters
+	auto match(const link& L) const -> bool {
+		if(q.name_ && L.name_ref() != *q.name_) return false;
+		if(q.name_glob_ && !detail::glob_match(*q.name_glob_, L.name_ref())) return false;
+		if(q.oid_ && L.oid() != *q.oid_) return false;
+		if(q.type_ && L.obj_type_id() != *q.type_) return false;
+		return true;
+	}
+
+	// pass matched link to consumer, returns false if query must stop
+	auto deliver(const sp_link& L) -> bool {
+		if(!match(*L)) return true;
+		for(const auto& pred : q.where_)
+			if(!pred(L)) return true;
+
+		std::lock_guard<std::mutex> my_turn(consumer_guard);
+		if(stop) return false;
+		++n_found;
+		if(!f(L) || n_found >= q.limit_) stop = true;
+		return !stop;
+	}
+
+	auto process(const node::node_impl* N, std::size_t depth) -> void {
+		if(stop) return;
+		// skip subtree that can't contain required name or OID
+		if(
+			(q.name_ && !N->may_contain<Key::Name>(*q.name_)) ||
+			(q.oid_ && !N->may_contain<Key::OID>(*q.oid_))
+		)
+			return;
+
+		// links are copied under node lock, filters & consumer are called and child nodes are
+		// obtained after node is unlocked, so tree can be changed concurrently (or by consumer)
+		std::vector<sp_link> candidates, nested;
+		{
+			node::node_impl::links_locker_t my_turn(N->links_guard_);
+			// push down most selective filter into node's index
+			const auto collect = [&](const sp_link& L) {
+				candidates.push_back(L);
+				return true;
+			};
+			if(q.oid_)
+				N->visit_equal<Key::OID>(*q.oid_, collect);
+			else if(q.name_)
+				N->visit_equal<Key::Name>(*q.name_, collect);
+			else if(q.type_)
+				N->visit_equal<Key::Type>(*q.type_, collect);
+			else if(q.name_glob_)
+				N->visit_name_prefix(std::string(detail::glob_prefix(*q.name_glob_)), collect);
+			else
+				candidates.assign(N->begin<>(), N->end<>());
+
+			// reverse order makes sequential query visit children in natural order
+			if(depth < q.max_depth_) {
+				const auto& ord = N->links_.get<Key_tag<Key::AnyOrder>>();
+				for(auto pos = ord.rbegin(); pos != ord.rend(); ++pos) {
+					if((*pos)->type_id() != "sym_link") nested.push_back(*pos);
+				}
+			}
+		}
+
+		for(const auto& L : candidates)
+			if(!deliver(L)) break;
+		if(stop) return;
+
+		// schedule child nodes owned by links of this node
+		for(const auto& L : nested) {
+			if(!(q.follow_lazy_ || can_call_dnode(*L))) continue;
+			if(auto child = L->data_node(); child && child->handle() == L)
+				jobs.push({std::move(child), depth + 1});
+		}
+	}
+};
+
+/*-----------------------------------------------------------------------------
+ *  query
+ *-----------------------------------------------------------------------------*/
+query::query(sp_node root) : root_(std::move(root)) {}
+
+query::query(const sp_link& root) : root_(root ? root->data_node() : nullptr) {}
+
+auto query::name(std::string link_name) -> query& {
+	name_ = std::move(link_name);
+	return *this;
+}
+
+auto query::name_glob(std::string pattern) -> query& {
+	name_glob_ = std::move(pattern);
+	return *this;
+}
+
+auto query::type(std::string obj_type_id) -> query& {
+	type_ = std::move(obj_type_id);
+	return *this;
+}
+
+auto query::oid(std::string obj_id) -> query& {
+	oid_ = std::move(obj_id);
+	return *this;
+}
+
+auto query::where(predicate_f pred) -> query& {
+	if(pred) where_.push_back(std::move(pred));
+	return *this;
+}
+
+auto query::limit(std::size_t n) -> query& {
+	limit_ = n;
+	return *this;
+}
+
+auto query::max_depth(std::size_t depth) -> query& {
+	max_depth_ = depth;
+	return *this;
+}
+
+auto query::follow_lazy_links(bool on) -> query& {
+	follow_lazy_ = on;
+	return *this;
+}
+
+auto query::parallel(bool on) -> query& {
+	parallel_ = on;
+	return *this;
+}
+
+auto query::for_each(consumer_f f) const -> std::size_t {
+	return runner(*this, f).run();
+}
+
+auto query::collect() const -> std::vector<sp_link> {
+	std::vector<sp_link> res;
+	for_each([&](const sp_link& L) {
+		res.push_back(L);
+		return true;
+	});
+	return res;
+}
+
+auto query::first() const -> sp_link {
+	sp_link res;
+	auto q = *this;
+	q.limit(1).for_each([&](const sp_link& L) {
+		res = L;
+		return false;
+	});
+	return res;
+}
+
+auto query::count() const -> std::size_t {
+	return for_each([](const sp_link&) { return true; });
+}
+
+NAMESPACE_END(blue_sky::tree)
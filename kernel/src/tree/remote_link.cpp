@@ -0,0 +1,564 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Remote link and server of published subtree
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/atoms.h>
+#include <bs/kernel/config.h>
+#include <bs/tree/remote_link.h>
+#include <bs/tree/tree.h>
+#include <bs/serialize/serialize.h>
+#include <bs/serialize/base_types.h>
+#include <bs/serialize/tree.h>
+#include "tree_impl.h"
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+#include <caf/all.hpp>
+#include <caf/io/all.hpp>
+
+#include <boost/algorithm/string/join.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include <map>
+#include <mutex>
+#include <sstream>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+using Key = node::Key;
+
+NAMESPACE_BEGIN()
+/*-----------------------------------------------------------------------------
+ *  protocol
+ *-----------------------------------------------------------------------------*/
+// metadata of link sent by server
+struct leaf_info {
+	// path by IDs relative to published root
+	std::string path;
+	std::string name, oid, obj_type_id;
+	std::uint32_t flags = 0;
+	bool is_node = false;
+
+	template<typename Archive>
+	auto serialize(Archive& ar) -> void {
+		ar(path, name, oid, obj_type_id, flags, is_node);
+	}
+};
+using leafs_info = std::vector<leaf_info>;
+
+// all replies are packed into single binary string: error box followed by values (if no error)
+// so that only builtin CAF types travel over the wire
+template<typename... Ts>
+auto pack(const error& er, const Ts&... xs) -> std::string {
+	std::ostringstream ss;
+	{
+		cereal::PortableBinaryOutputArchive ar(ss);
+		ar(er.pack());
+		if constexpr(sizeof...(Ts) > 0) {
+			if(er.ok()) ar(xs...);
+		}
+	}
+	return ss.str();
+}
+
+template<typename... Ts>
+auto unpack(const std::string& payload, Ts&... xs) -> error {
+	return error::eval_safe([&]() -> error {
+		std::istringstream ss(payload);
+		cereal::PortableBinaryInputArchive ar(ss);
+		error::box er;
+		ar(er);
+		auto res = error::unpack(std::move(er));
+		if(res.ok()) ar(xs...);
+		return res;
+	});
+}
+
+// actor that serves published subtree
+using rtree_actor_t = caf::typed_actor<
+	// list children of node
+	caf::replies_to<rtree_ls_atom, std::string>::with<std::string>,
+	// pull object
+	caf::replies_to<rtree_data_atom, std::string>::with<std::string>,
+	// resolve path relative to link
+	caf::replies_to<rtree_deref_atom, std::string, std::string, int>::with<std::string>
+>;
+
+/*-----------------------------------------------------------------------------
+ *  server
+ *-----------------------------------------------------------------------------*/
+auto make_info(const link& L, std::string path) -> leaf_info {
+	const auto is_node = detail::can_call_dnode(L) ?
+		bool(L.data_node()) : L.obj_type_id() == node::bs_type().name;
+	return { std::move(path), L.name(), L.oid(), L.obj_type_id(), std::uint32_t(L.flags()), is_node };
+}
+
+// path by IDs from published root node to `L`, nullopt if `L` is outside of published subtree
+auto relpath(const sp_link& L, const sp_node& root) -> std::optional<std::string> {
+	std::vector<std::string> ids;
+	for(auto cur = L; cur; ) {
+		ids.push_back(boost::uuids::to_string(cur->id()));
+		const auto parent = cur->owner();
+		if(!parent) return {};
+		if(parent == root)
+			return boost::join(std::vector<std::string>(ids.rbegin(), ids.rend()), "/");
+		cur = parent->handle();
+	}
+	return {};
+}
+
+// worker serves requests on it's own thread, because resolving links can block
+// (lazy links are loaded, nested remote links reach their servers)
+auto rtree_worker(rtree_actor_t::pointer, sp_link root) -> rtree_actor_t::behavior_type {
+	// empty path addresses published root itself
+	const auto resolve = [root](const std::string& path) -> sp_link {
+		if(path.empty()) return root;
+		auto N = root->data_node();
+		return N ? deref_path(path, std::move(N), Key::ID) : nullptr;
+	};
+
+	return {
+		// listing contains info about node's handle and all children
+		[=](rtree_ls_atom, const std::string& path) -> std::string {
+			const auto L = resolve(path);
+			if(!L) return pack(error::quiet(Error::KeyMismatch));
+			const auto N = L->data_node();
+			if(!N) return pack(error::quiet(Error::NotANode));
+
+			leafs_info leafs;
+			leafs.reserve(N->size());
+			const auto prefix = path.empty() ? path : path + '/';
+			for(const auto& C : *N)
+				leafs.push_back(make_info(*C, prefix + boost::uuids::to_string(C->id())));
+			return pack(perfect, make_info(*L, path), leafs);
+		},
+
+		// nodes are listed and never transferred as a whole
+		[=](rtree_data_atom, const std::string& path) -> std::string {
+			const auto L = resolve(path);
+			if(!L) return pack(error::quiet(Error::KeyMismatch));
+			auto obj = L->data_ex();
+			if(!obj) return pack(obj.error());
+			if((*obj)->is_node()) return pack(error::quiet(Error::NotANode));
+			return pack(perfect, make_info(*L, path), *obj);
+		},
+
+		[=](rtree_deref_atom, const std::string& start, const std::string& path, int path_unit)
+		-> std::string {
+			const auto S = resolve(start);
+			const auto L = S ? deref_path(path, S, Key(path_unit)) : nullptr;
+			const auto L_path = L ? relpath(L, root->data_node()) : std::nullopt;
+			// targets outside of published subtree are hidden
+			if(!L_path) return pack(error::quiet(Error::KeyMismatch));
+			return pack(perfect, make_info(*L, *L_path));
+		}
+	};
+}
+
+// server only delegates requests to detached workers, so CAF scheduler threads are never blocked
+constexpr std::size_t rtree_n_workers = 4;
+
+struct rtree_server_state {
+	std::vector<rtree_actor_t> workers;
+	std::size_t next = 0;
+};
+
+auto rtree_server(rtree_actor_t::stateful_pointer<rtree_server_state> self, sp_link root)
+-> rtree_actor_t::behavior_type {
+	// workers are linked to server and exit together with it
+	for(std::size_t i = 0; i < rtree_n_workers; ++i)
+		self->state.workers.push_back(self->spawn<caf::linked + caf::detached>(rtree_worker, root));
+	const auto worker = [self] {
+		auto& S = self->state;
+		return S.workers[S.next++ % S.workers.size()];
+	};
+
+	return {
+		[=](rtree_ls_atom a, const std::string& path) {
+			return self->delegate(worker(), a, path);
+		},
+
+		[=](rtree_data_atom a, const std::string& path) {
+			return self->delegate(worker(), a, path);
+		},
+
+		[=](rtree_deref_atom a, const std::string& start, const std::string& path, int path_unit) {
+			return self->delegate(worker(), a, start, path, path_unit);
+		}
+	};
+}
+
+// published servers by port
+struct servers_registry {
+	std::map<std::uint16_t, rtree_actor_t> servers;
+	std::mutex guard;
+
+	static auto self() -> servers_registry& {
+		static servers_registry self_;
+		return self_;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+ *  client
+ *-----------------------------------------------------------------------------*/
+// connection to server shared by all remote links of one mount
+class remote_conn {
+public:
+	const std::string host;
+	const std::uint16_t port;
+	const timespan timeout;
+
+	remote_conn(std::string host_, std::uint16_t port_, timespan timeout_)
+		: host(std::move(host_)), port(port_), timeout(timeout_)
+	{}
+
+	// send all requests at once and then wait for replies, so that network latency
+	// is paid once per batch, not once per request
+	template<typename Atom, typename... Args>
+	auto request(const std::vector<std::tuple<Args...>>& reqs) -> std::vector<result_or_err<std::string>> {
+		auto S = server();
+		if(!S) return std::vector<result_or_err<std::string>>(reqs.size(), tl::make_unexpected(S.error()));
+
+		auto& sys = kernel::config::actor_system();
+		caf::scoped_actor self{sys};
+		const auto send_req = [&](const Args&... args) {
+			return self->request(*S, timeout, Atom(), args...);
+		};
+		std::vector<decltype(std::apply(send_req, reqs[0]))> pending;
+		pending.reserve(reqs.size());
+		for(const auto& r : reqs)
+			pending.push_back(std::apply(send_req, r));
+
+		std::vector<result_or_err<std::string>> res;
+		res.reserve(reqs.size());
+		for(auto& p : pending) {
+			p.receive(
+				[&](std::string& reply) { res.emplace_back(std::move(reply)); },
+				[&](caf::error& er) {
+					res.emplace_back(tl::make_unexpected(
+						error::quiet(sys.render(er), Error::RemoteUnreachable)
+					));
+					// reconnect on next request
+					disconnect();
+				}
+			);
+		}
+		return res;
+	}
+
+	template<typename Atom, typename... Args>
+	auto request_one(Args... args) -> result_or_err<std::string> {
+		return std::move(request<Atom>(std::vector{ std::make_tuple(std::move(args)...) })[0]);
+	}
+
+private:
+	rtree_actor_t server_;
+	std::mutex guard_;
+
+	auto server() -> result_or_err<rtree_actor_t> {
+		std::lock_guard<std::mutex> play_solo(guard_);
+		if(!server_) {
+			auto& sys = kernel::config::actor_system();
+			auto S = caf::io::remote_actor<rtree_actor_t>(sys, host, port);
+			if(!S) return tl::make_unexpected(error::quiet(sys.render(S.error()), Error::RemoteUnreachable));
+			server_ = std::move(*S);
+		}
+		return server_;
+	}
+
+	auto disconnect() -> void {
+		std::lock_guard<std::mutex> play_solo(guard_);
+		server_ = nullptr;
+	}
+};
+using sp_remote_conn = std::shared_ptr<remote_conn>;
+
+NAMESPACE_END()
+
+/*-----------------------------------------------------------------------------
+ *  publish
+ *-----------------------------------------------------------------------------*/
+auto publish(sp_link root, std::uint16_t port, const std::string& host, bool reuse_addr)
+-> result_or_err<std::uint16_t> {
+	if(!root) return tl::make_unexpected(error::quiet(Error::EmptyData));
+
+	auto& sys = kernel::config::actor_system();
+	auto server = sys.spawn(rtree_server, std::move(root));
+	auto res = caf::io::publish(server, port, host.empty() ? nullptr : host.c_str(), reuse_addr);
+	if(!res) {
+		caf::anon_send_exit(server, caf::exit_reason::user_shutdown);
+		return tl::make_unexpected(error::quiet(sys.render(res.error()), Error::RemoteUnreachable));
+	}
+
+	auto& R = servers_registry::self();
+	std::lock_guard<std::mutex> play_solo(R.guard);
+	R.servers[*res] = std::move(server);
+	return *res;
+}
+
+auto unpublish(std::uint16_t port) -> error {
+	auto& R = servers_registry::self();
+	rtree_actor_t server;
+	{
+		std::lock_guard<std::mutex> play_solo(R.guard);
+		auto pos = R.servers.find(port);
+		if(pos == R.servers.end()) return error::quiet(Error::KeyMismatch);
+		server = std::move(pos->second);
+		R.servers.erase(pos);
+	}
+	caf::io::unpublish(server, port);
+	caf::anon_send_exit(server, caf::exit_reason::user_shutdown);
+	return perfect;
+}
+
+/*-----------------------------------------------------------------------------
+ *  remote_link::impl
+ *-----------------------------------------------------------------------------*/
+struct BS_HIDDEN_API remote_link::impl {
+	const sp_remote_conn conn_;
+	// path by IDs relative to published root
+	const std::string path_;
+	// cached metadata, object and listing
+	leaf_info meta_;
+	bool has_meta_ = false;
+	sp_obj data_;
+	sp_node node_;
+	std::mutex guard_;
+
+	impl(sp_remote_conn conn, leaf_info meta, bool has_meta = true)
+		: conn_(std::move(conn)), path_(meta.path), meta_(std::move(meta)), has_meta_(has_meta)
+	{}
+
+	auto make_link(leaf_info info) const -> sp_link {
+		auto name = info.name;
+		const auto f = Flags(info.flags);
+		return std::shared_ptr<remote_link>(new remote_link(
+			std::make_unique<impl>(conn_, std::move(info)), std::move(name), f
+		));
+	}
+
+	auto meta() -> std::optional<leaf_info> {
+		std::lock_guard<std::mutex> play_solo(guard_);
+		return has_meta_ ? std::optional{meta_} : std::nullopt;
+	}
+
+	auto update_meta(leaf_info info) -> void {
+		std::lock_guard<std::mutex> play_solo(guard_);
+		meta_ = std::move(info);
+		has_meta_ = true;
+	}
+
+	auto node() -> sp_node {
+		std::lock_guard<std::mutex> play_solo(guard_);
+		return node_;
+	}
+
+	// make local node filled with remote links from server's listing
+	auto apply_listing(const remote_link& self, const result_or_err<std::string>& reply)
+	-> result_or_err<sp_node> {
+		if(!reply) return tl::make_unexpected(reply.error());
+		leaf_info self_info;
+		leafs_info leafs;
+		if(auto er = unpack(*reply, self_info, leafs)) {
+			// remember that pointee isn't a node
+			if(er.code == Error::NotANode) {
+				std::lock_guard<std::mutex> play_solo(guard_);
+				if(has_meta_) meta_.is_node = false;
+			}
+			return tl::make_unexpected(std::move(er));
+		}
+		update_meta(std::move(self_info));
+
+		std::vector<sp_link> children;
+		children.reserve(leafs.size());
+		for(auto& info : leafs)
+			children.push_back(make_link(std::move(info)));
+		auto N = std::make_shared<tree::node>();
+		N->insert(std::move(children));
+
+		{
+			std::lock_guard<std::mutex> play_solo(guard_);
+			node_ = N;
+		}
+		const_cast<remote_link&>(self).self_handle_node(N);
+		return N;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+ *  remote_link
+ *-----------------------------------------------------------------------------*/
+remote_link::remote_link(
+	std::string name, std::string host, std::uint16_t port, timespan timeout, Flags f
+) :
+	// set LazyLoad flag by default, so that remote tree isn't crawled implicitly
+	link(std::move(name), Flags(f | link::LazyLoad)),
+	pimpl_(std::make_unique<impl>(
+		std::make_shared<remote_conn>(std::move(host), port, timeout), leaf_info{}, false
+	))
+{}
+
+remote_link::remote_link(
+	std::string name, std::string host, std::uint16_t port, std::string remote_path,
+	timespan timeout, Flags f
+) :
+	link(std::move(name), Flags(f | link::LazyLoad)),
+	pimpl_(std::make_unique<impl>(
+		std::make_shared<remote_conn>(std::move(host), port, timeout),
+		leaf_info{ std::move(remote_path) }, false
+	))
+{}
+
+remote_link::remote_link(std::unique_ptr<impl> pimpl, std::string name, Flags f)
+	: link(std::move(name), Flags(f | link::LazyLoad)), pimpl_(std::move(pimpl))
+{}
+
+remote_link::~remote_link() {}
+
+auto remote_link::clone(bool) const -> sp_link {
+	auto meta = pimpl_->meta();
+	const auto has_meta = bool(meta);
+	if(!meta) meta.emplace().path = pimpl_->path_;
+	return std::shared_ptr<remote_link>(new remote_link(
+		std::make_unique<impl>(pimpl_->conn_, std::move(*meta), has_meta), name(), flags()
+	));
+}
+
+auto remote_link::type_id() const -> std::string {
+	return "remote_link";
+}
+
+auto remote_link::oid() const -> std::string {
+	if(auto meta = pimpl_->meta())
+		return std::move(meta->oid);
+	return boost::uuids::to_string(boost::uuids::nil_uuid());
+}
+
+auto remote_link::obj_type_id() const -> std::string {
+	if(auto meta = pimpl_->meta())
+		return std::move(meta->obj_type_id);
+	return type_descriptor::nil().name;
+}
+
+auto remote_link::host() const -> const std::string& {
+	return pimpl_->conn_->host;
+}
+
+auto remote_link::port() const -> std::uint16_t {
+	return pimpl_->conn_->port;
+}
+
+auto remote_link::timeout() const -> timespan {
+	return pimpl_->conn_->timeout;
+}
+
+auto remote_link::remote_path() const -> const std::string& {
+	return pimpl_->path_;
+}
+
+auto remote_link::is_node() const -> bool {
+	const auto meta = pimpl_->meta();
+	return meta && meta->is_node;
+}
+
+auto remote_link::cache() const -> sp_obj {
+	std::lock_guard<std::mutex> play_solo(pimpl_->guard_);
+	return pimpl_->node_ ? pimpl_->node_ : pimpl_->data_;
+}
+
+auto remote_link::refresh() -> void {
+	{
+		std::lock_guard<std::mutex> play_solo(pimpl_->guard_);
+		pimpl_->data_.reset();
+		pimpl_->node_.reset();
+	}
+	rs_reset(Req::Data);
+	rs_reset(Req::DataNode);
+}
+
+auto remote_link::data_node_impl() const -> result_or_err<sp_node> {
+	if(auto N = pimpl_->node(); N && req_status(Req::DataNode) == ReqStatus::OK)
+		return N;
+	if(auto meta = pimpl_->meta(); meta && !meta->is_node)
+		return tl::make_unexpected(error::quiet(Error::NotANode));
+
+	return pimpl_->apply_listing(
+		*this, pimpl_->conn_->request_one<rtree_ls_atom>(pimpl_->path_)
+	);
+}
+
+auto remote_link::data_impl() const -> result_or_err<sp_obj> {
+	if(req_status(Req::Data) == ReqStatus::OK) {
+		if(auto obj = cache()) return obj;
+	}
+	// nodes are represented by local node filled with remote links
+	if(auto meta = pimpl_->meta(); !meta || meta->is_node) {
+		auto N = data_node_ex();
+		if(N) return *N;
+		if(N.error().code != Error::NotANode) return tl::make_unexpected(std::move(N.error()));
+	}
+
+	auto reply = pimpl_->conn_->request_one<rtree_data_atom>(pimpl_->path_);
+	if(!reply) return tl::make_unexpected(std::move(reply.error()));
+	leaf_info info;
+	sp_obj obj;
+	if(auto er = unpack(*reply, info, obj)) return tl::make_unexpected(std::move(er));
+
+	pimpl_->update_meta(std::move(info));
+	std::lock_guard<std::mutex> play_solo(pimpl_->guard_);
+	pimpl_->data_ = obj;
+	return obj;
+}
+
+auto remote_link::propagate_handle() -> result_or_err<sp_node> {
+	// [NOTE] inserting remote link into node must not reach server
+	auto N = pimpl_->node();
+	self_handle_node(N);
+	return N ? result_or_err<sp_node>(std::move(N)) : tl::make_unexpected(error::quiet(Error::EmptyData));
+}
+
+auto remote_link::deref_path(const std::string& path, Key path_unit) const -> result_or_err<sp_link> {
+	auto reply = pimpl_->conn_->request_one<rtree_deref_atom>(pimpl_->path_, path, int(path_unit));
+	if(!reply) return tl::make_unexpected(std::move(reply.error()));
+	leaf_info info;
+	if(auto er = unpack(*reply, info)) return tl::make_unexpected(std::move(er));
+	return pimpl_->make_link(std::move(info));
+}
+
+auto remote_link::populate(std::size_t depth) const -> error {
+	std::vector<sp_cremote_link> level{ std::static_pointer_cast<const remote_link>(shared_from_this()) };
+	for(std::size_t i = 0; i < depth && !level.empty(); ++i) {
+		// request listings of all nodes at current level at once
+		std::vector<std::tuple<std::string>> reqs;
+		reqs.reserve(level.size());
+		for(const auto& L : level)
+			reqs.emplace_back(L->pimpl_->path_);
+		const auto replies = pimpl_->conn_->request<rtree_ls_atom>(reqs);
+
+		std::vector<sp_cremote_link> next_level;
+		for(std::size_t j = 0; j < level.size(); ++j) {
+			const auto& L = level[j];
+			auto N = L->pimpl_->apply_listing(*L, replies[j]);
+			if(!N) {
+				// leafs that aren't nodes are skipped, other errors are fatal
+				if(N.error().code == Error::NotANode) continue;
+				return std::move(N.error());
+			}
+			L->rs_reset_if_neq(Req::DataNode, ReqStatus::Busy, ReqStatus::OK);
+			for(const auto& C : **N) {
+				auto RC = std::static_pointer_cast<const remote_link>(C);
+				if(RC->is_node()) next_level.push_back(std::move(RC));
+			}
+		}
+		level = std::move(next_level);
+	}
+	return perfect;
+}
+
+NAMESPACE_END(blue_sky::tree)
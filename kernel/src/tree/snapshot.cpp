@@ -0,0 +1,65 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Implementation of subtree snapshot
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/snapshot.h>
+#include "node_impl.h"
+#include "tree_impl.h"
+
+NAMESPACE_BEGIN(blue_sky::tree)
+using detail::snapshot_epochs;
+
+/*-----------------------------------------------------------------------------
+ *  snapshot
+ *-----------------------------------------------------------------------------*/
+struct snapshot::state {
+	const sp_node root;
+	const epoch_t epoch;
+
+	state(sp_node root_) : root(std::move(root_)), epoch(snapshot_epochs::acquire()) {}
+	// links lists that nodes saved only for this snapshot are dropped here
+	~state() { snapshot_epochs::release(epoch); }
+};
+
+snapshot::snapshot(sp_node root) : state_(std::make_shared<state>(std::move(root))) {}
+
+snapshot::snapshot(const sp_link& root) : snapshot(root ? root->data_node() : nullptr) {}
+
+auto snapshot::root() const -> const sp_node& {
+	return state_->root;
+}
+
+auto snapshot::epoch() const -> epoch_t {
+	return state_->epoch;
+}
+
+auto snapshot::leafs(const sp_node& N) const -> leafs_t {
+	return N ? N->pimpl_->snapshot_leafs(state_->epoch) : std::make_shared<std::vector<leaf>>();
+}
+
+auto snapshot::walk(step_f f) const -> void {
+	if(!state_->root || !f) return;
+	// explicit stack, so that deep trees can't overflow call stack
+	std::vector<sp_node> todo{ state_->root };
+	while(!todo.empty()) {
+		const auto N = std::move(todo.back());
+		todo.pop_back();
+		const auto N_leafs = leafs(N);
+		f(N, *N_leafs);
+
+		// push children in reverse order to visit them in natural order
+		for(auto pos = N_leafs->rbegin(); pos != N_leafs->rend(); ++pos) {
+			const auto& L = pos->link;
+			if(L->type_id() == "sym_link" || !detail::can_call_dnode(*L)) continue;
+			if(auto child = L->data_node())
+				todo.push_back(std::move(child));
+		}
+	}
+}
+
+NAMESPACE_END(blue_sky::tree)
@@ -0,0 +1,141 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Registry of epochs of alive snapshots
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+#pragma once
+
+#include <bs/tree/snapshot.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree::detail)
+
+// links lists of node saved for alive snapshots, sorted by epoch
+// shared with epochs registry, so that lists are dropped when snapshots are released
+struct frozen_versions {
+	using epoch_t = snapshot::epoch_t;
+
+	std::vector<std::pair<epoch_t, snapshot::leafs_t>> list;
+	std::mutex guard;
+
+	// drop lists that aren't visible from any alive snapshot, they are returned
+	// to be destroyed after `guard` is unlocked
+	// [NOTE] caller is responsible for locking `guard`
+	inline auto prune_nolock() -> std::vector<snapshot::leafs_t>;
+
+	// [NOTE] caller is responsible for locking `guard`
+	auto has_nolock(epoch_t e) const -> bool {
+		return std::any_of(list.begin(), list.end(), [&](const auto& v) { return v.first == e; });
+	}
+};
+using sp_frozen_versions = std::shared_ptr<frozen_versions>;
+
+class snapshot_epochs {
+public:
+	using epoch_t = snapshot::epoch_t;
+
+	// start new epoch & register snapshot in it
+	static auto acquire() -> epoch_t {
+		auto& self = instance();
+		std::lock_guard<std::mutex> guard(self.guard_);
+		const auto res = ++self.current_;
+		self.alive_.insert(res);
+		self.last_alive_ = res;
+		return res;
+	}
+
+	// unregister snapshot & drop links lists that only it could see
+	static auto release(epoch_t e) -> void {
+		auto& self = instance();
+		// only lists saved in epochs not before `e` can be visible from released snapshot
+		std::vector<std::pair<epoch_t, std::vector<std::weak_ptr<frozen_versions>>>> candidates;
+		{
+			std::lock_guard<std::mutex> guard(self.guard_);
+			if(auto pos = self.alive_.find(e); pos != self.alive_.end())
+				self.alive_.erase(pos);
+			self.last_alive_ = self.alive_.empty() ? 0 : *self.alive_.rbegin();
+			const auto from = self.frozen_.lower_bound(e);
+			candidates.assign(
+				std::make_move_iterator(from), std::make_move_iterator(self.frozen_.end())
+			);
+			self.frozen_.erase(from, self.frozen_.end());
+		}
+
+		for(const auto& [v, nodes] : candidates) {
+			for(const auto& wV : nodes) {
+				const auto V = wV.lock();
+				if(!V) continue;
+				std::vector<snapshot::leafs_t> dropped;
+				std::lock_guard<std::mutex> V_guard(V->guard);
+				dropped = V->prune_nolock();
+				// list that is still visible is checked again on next release
+				if(V->has_nolock(v)) track(v, V);
+			}
+		}
+	}
+
+	// remember that node saved links list in epoch `e`
+	static auto track(epoch_t e, const sp_frozen_versions& V) -> void {
+		auto& self = instance();
+		std::lock_guard<std::mutex> guard(self.guard_);
+		self.frozen_[e].push_back(V);
+	}
+
+	// latest epoch, nodes created now are never visible in previous snapshots
+	static auto current() -> epoch_t {
+		return instance().current_.load(std::memory_order_acquire);
+	}
+
+	// epoch of latest alive snapshot, 0 if there are no alive snapshots
+	static auto last_alive() -> epoch_t {
+		return instance().last_alive_.load(std::memory_order_acquire);
+	}
+
+	// check if there is alive snapshot with epoch in (lo, hi]
+	static auto any_alive(epoch_t lo, epoch_t hi) -> bool {
+		auto& self = instance();
+		std::lock_guard<std::mutex> guard(self.guard_);
+		const auto pos = self.alive_.upper_bound(lo);
+		return pos != self.alive_.end() && *pos <= hi;
+	}
+
+private:
+	std::atomic<epoch_t> current_ = 0, last_alive_ = 0;
+	std::set<epoch_t> alive_;
+	// nodes that saved links lists in given epoch
+	std::map<epoch_t, std::vector<std::weak_ptr<frozen_versions>>> frozen_;
+	std::mutex guard_;
+
+	static auto instance() -> snapshot_epochs& {
+		static snapshot_epochs self;
+		return self;
+	}
+};
+
+// version saved in epoch `e` is visible from snapshots taken after previous saved version
+auto frozen_versions::prune_nolock() -> std::vector<snapshot::leafs_t> {
+	std::vector<snapshot::leafs_t> res;
+	decltype(list) kept;
+	epoch_t lo = 0;
+	for(auto& [hi, leafs] : list) {
+		if(snapshot_epochs::any_alive(lo, hi))
+			kept.emplace_back(hi, std::move(leafs));
+		else
+			res.push_back(std::move(leafs));
+		lo = hi;
+	}
+	list = std::move(kept);
+	return res;
+}
+
+NAMESPACE_END(blue_sky::tree::detail)
@@ -0,0 +1,353 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Weak links sweeper implementation
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/sweeper.h>
+#include <bs/tree/query.h>
+#include <bs/tree/batch.h>
+#include <bs/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+using clock_t = std::chrono::steady_clock;
+
+auto sweep_stats::operator+=(const sweep_stats& rhs) -> sweep_stats& {
+	scans += rhs.scans;
+	sweeps += rhs.sweeps;
+	links_scanned += rhs.links_scanned;
+	erased += rhs.erased;
+	tombstoned += rhs.tombstoned;
+	batches += rhs.batches;
+	time_spent += rhs.time_spent;
+	return *this;
+}
+
+NAMESPACE_BEGIN()
+
+auto is_dead(const link& L) -> bool {
+	const auto W = dynamic_cast<const weak_link*>(&L);
+	return W && W->expired();
+}
+
+auto is_tombstone(const link& L) -> bool {
+	return L.flags() & link::Tombstone;
+}
+
+// remove links from their owners by batches of given size
+auto erase_links(const std::vector<sp_link>& links, std::size_t batch_size, sweep_stats& S) -> void {
+	batch_size = std::max<std::size_t>(batch_size, 1);
+	std::vector<std::pair<sp_node, link::id_type>> ops;
+	for(std::size_t i = 0; i < links.size(); i += batch_size) {
+		auto b = batch{};
+		ops.clear();
+		for(auto k = i; k < std::min(i + batch_size, links.size()); ++k) {
+			if(auto N = links[k]->owner()) {
+				b.erase(N, links[k]->id());
+				ops.emplace_back(std::move(N), links[k]->id());
+			}
+		}
+		if(ops.empty()) continue;
+
+		++S.batches;
+		if(b.commit().ok())
+			S.erased += ops.size();
+		else {
+			// some links were removed concurrently, erase the rest one by one
+			for(const auto& [N, lid] : ops) {
+				if(N->find(lid) == N->end()) continue;
+				N->erase(lid);
+				++S.erased;
+			}
+		}
+	}
+}
+
+NAMESPACE_END()
+
+/*-----------------------------------------------------------------------------
+ *  impl
+ *-----------------------------------------------------------------------------*/
+struct weak_sweeper::impl : std::enable_shared_from_this<impl> {
+	const sp_link root_;
+	sweep_policy policy_;
+	sweep_stats stats_;
+	// links reported by expiry notifications
+	std::vector<std::weak_ptr<const link>> suspects_;
+	clock_t::time_point next_scan_;
+	bool stop_ = false, rearm_ = false;
+	mutable std::mutex guard_;
+	std::condition_variable wake_;
+	// only one pass runs at a time
+	std::mutex pass_guard_;
+	std::thread worker_;
+
+	impl(sp_link root, sweep_policy policy)
+		: root_(std::move(root)), policy_(std::move(policy)), next_scan_(clock_t::now() + policy_.period)
+	{}
+
+	auto policy() const -> sweep_policy {
+		auto guard = std::lock_guard{guard_};
+		return policy_;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  sweep passes
+	//
+	auto apply(const std::vector<sp_link>& dead, const sweep_policy& pol, sweep_stats& S) -> void {
+		if(pol.action == SweepAction::Erase)
+			erase_links(dead, pol.batch_size, S);
+		else {
+			for(const auto& L : dead)
+				L->set_flags(link::Flags(L->flags() | link::Tombstone));
+			S.tombstoned += dead.size();
+		}
+	}
+
+	// find links matching `pred` in whole subtree
+	// [NOTE] query copies links of every node under node's lock and calls `pred` after unlocking,
+	// so nodes can be modified while scan runs
+	template<typename F>
+	auto scan(F pred, const sweep_policy& pol, sweep_stats& S) const -> std::vector<sp_link> {
+		std::atomic<std::size_t> n_scanned = 0;
+		std::vector<sp_link> res;
+		query(root_).parallel(pol.parallel).where([&](const sp_link& L) {
+			++n_scanned;
+			return pred(*L);
+		}).for_each([&](const sp_link& L) {
+			res.push_back(L);
+			return true;
+		});
+		S.links_scanned += n_scanned;
+		return res;
+	}
+
+	auto sweep() -> sweep_stats {
+		return pass([&](const sweep_policy& pol, sweep_stats& S) {
+			++S.scans;
+			// scan covers all reported links
+			{
+				auto guard = std::lock_guard{guard_};
+				suspects_.clear();
+			}
+			apply(scan([](const link& L) { return !is_tombstone(L) && is_dead(L); }, pol, S), pol, S);
+		});
+	}
+
+	auto sweep_suspects() -> sweep_stats {
+		return pass([&](const sweep_policy& pol, sweep_stats& S) {
+			++S.sweeps;
+			auto suspects = std::vector<std::weak_ptr<const link>>{};
+			{
+				auto guard = std::lock_guard{guard_};
+				std::swap(suspects, suspects_);
+			}
+			S.links_scanned += suspects.size();
+
+			// same link can be reported several times
+			auto dead = std::vector<sp_link>{};
+			for(const auto& s : suspects) {
+				if(auto L = s.lock(); L && !is_tombstone(*L) && is_dead(*L) && in_subtree(*L))
+					dead.push_back(std::const_pointer_cast<link>(std::move(L)));
+			}
+			std::sort(dead.begin(), dead.end());
+			dead.erase(std::unique(dead.begin(), dead.end()), dead.end());
+			apply(dead, pol, S);
+		});
+	}
+
+	auto compact() -> sweep_stats {
+		return pass([&](const sweep_policy& pol, sweep_stats& S) {
+			++S.scans;
+			erase_links(scan(is_tombstone, pol, S), pol.batch_size, S);
+		});
+	}
+
+	template<typename F>
+	auto pass(F&& f) -> sweep_stats {
+		const auto pol = policy();
+		auto S = sweep_stats{};
+		{
+			auto solo = std::lock_guard{pass_guard_};
+			const auto start = clock_t::now();
+			f(pol, S);
+			S.time_spent = clock_t::now() - start;
+		}
+		{
+			auto guard = std::lock_guard{guard_};
+			stats_ += S;
+		}
+		if(pol.log_stats)
+			bsout() << log::I("weak_sweeper: {} links scanned, {} erased, {} tombstoned in {} batches, {} ms")
+				<< S.links_scanned << S.erased << S.tombstoned << S.batches
+				<< std::chrono::duration_cast<std::chrono::milliseconds>(S.time_spent).count() << log::end;
+		return S;
+	}
+
+	auto in_subtree(const link& L) const -> bool {
+		const auto R = root_->data_node();
+		for(auto N = L.owner(); N;) {
+			if(N == R) return true;
+			const auto H = N->handle();
+			N = H ? H->owner() : nullptr;
+		}
+		return false;
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  background thread
+	//
+	auto start() -> void {
+		registry().add(weak_from_this());
+		worker_ = std::thread([this] { run(); });
+	}
+
+	auto stop() -> void {
+		{
+			auto guard = std::lock_guard{guard_};
+			stop_ = true;
+		}
+		wake_.notify_one();
+		if(worker_.joinable()) worker_.join();
+	}
+
+	auto run() -> void {
+		auto guard = std::unique_lock{guard_};
+		while(!stop_) {
+			const auto woken = [this] {
+				return stop_ || rearm_ || suspects_.size() >= std::max<std::size_t>(policy_.batch_size, 1);
+			};
+			const bool periodic = policy_.period.count() > 0;
+			if(periodic)
+				wake_.wait_until(guard, next_scan_, woken);
+			else
+				wake_.wait(guard, woken);
+			if(stop_) break;
+			if(std::exchange(rearm_, false)) continue;
+
+			const bool do_scan = periodic && clock_t::now() >= next_scan_;
+			const bool do_sweep = !suspects_.empty();
+			guard.unlock();
+			if(do_scan) sweep();
+			else if(do_sweep) sweep_suspects();
+			guard.lock();
+			if(do_scan) next_scan_ = clock_t::now() + policy_.period;
+		}
+	}
+
+	auto report(const link& L) -> void {
+		{
+			auto guard = std::lock_guard{guard_};
+			if(!policy_.on_expiry) return;
+			// don't grow without limit if thread can't keep up -- next scan will find dropped links
+			const auto limit = std::max<std::size_t>(policy_.batch_size, 1);
+			if(suspects_.size() >= 16 * limit) return;
+			suspects_.push_back(L.weak_from_this());
+			if(suspects_.size() < limit) return;
+		}
+		wake_.notify_one();
+	}
+
+	///////////////////////////////////////////////////////////////////////////////
+	//  alive sweepers that receive expiry notifications
+	//
+	struct sweepers {
+		std::vector<std::weak_ptr<impl>> items_;
+		std::mutex guard_;
+		std::atomic<std::size_t> n_active_ = 0;
+
+		auto add(std::weak_ptr<impl> S) -> void {
+			auto solo = std::lock_guard{guard_};
+			items_.push_back(std::move(S));
+			n_active_ = items_.size();
+		}
+
+		auto remove(const impl* S) -> void {
+			auto solo = std::lock_guard{guard_};
+			items_.erase(std::remove_if(items_.begin(), items_.end(), [S](const auto& s) {
+				const auto ps = s.lock();
+				return !ps || ps.get() == S;
+			}), items_.end());
+			n_active_ = items_.size();
+		}
+
+		auto report(const link& L) -> void {
+			if(!n_active_.load(std::memory_order_relaxed)) return;
+			auto solo = std::lock_guard{guard_};
+			for(const auto& s : items_)
+				if(auto ps = s.lock()) ps->report(L);
+		}
+	};
+
+	// registry is never destructed, because links can outlive static objects
+	static auto registry() -> sweepers& {
+		static auto self = new sweepers;
+		return *self;
+	}
+};
+
+/*-----------------------------------------------------------------------------
+ *  weak_sweeper
+ *-----------------------------------------------------------------------------*/
+weak_sweeper::weak_sweeper(sp_link root, sweep_policy policy)
+	: pimpl_(std::make_shared<impl>(std::move(root), std::move(policy)))
+{
+	pimpl_->start();
+}
+
+weak_sweeper::~weak_sweeper() {
+	impl::registry().remove(pimpl_.get());
+	pimpl_->stop();
+}
+
+auto weak_sweeper::policy() const -> sweep_policy {
+	return pimpl_->policy();
+}
+
+auto weak_sweeper::set_policy(sweep_policy policy) -> void {
+	{
+		auto guard = std::lock_guard{pimpl_->guard_};
+		pimpl_->policy_ = std::move(policy);
+		pimpl_->next_scan_ = clock_t::now() + pimpl_->policy_.period;
+		pimpl_->rearm_ = true;
+	}
+	pimpl_->wake_.notify_one();
+}
+
+auto weak_sweeper::sweep() -> sweep_stats {
+	return pimpl_->sweep();
+}
+
+auto weak_sweeper::compact() -> sweep_stats {
+	return pimpl_->compact();
+}
+
+auto weak_sweeper::stats() const -> sweep_stats {
+	auto guard = std::lock_guard{pimpl_->guard_};
+	return pimpl_->stats_;
+}
+
+auto weak_sweeper::reset_stats() -> void {
+	auto guard = std::lock_guard{pimpl_->guard_};
+	pimpl_->stats_ = {};
+}
+
+auto weak_sweeper::sweep(const sp_link& root, const sweep_policy& policy) -> sweep_stats {
+	return impl(root, policy).sweep();
+}
+
+auto weak_sweeper::on_expired(const link& L) -> void {
+	impl::registry().report(L);
+}
+
+NAMESPACE_END(blue_sky::tree)
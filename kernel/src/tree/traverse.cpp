@@ -0,0 +1,144 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Iterative tree traversal implementation
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#include <bs/tree/traverse.h>
+#include "tree_impl.h"
+
+#include <deque>
+#include <optional>
+#include <set>
+
+NAMESPACE_BEGIN(blue_sky::tree)
+using detail::can_call_dnode;
+
+NAMESPACE_BEGIN()
+
+struct traverser {
+	traverse_fv f;
+	const traverse_opts& opts;
+	// entered sym links: ones on current path for DFS, all for BFS
+	std::set<link::id_type> active_symlinks = {};
+
+	auto can_enter(const link& L) const -> bool {
+		return opts.follow_lazy_links || can_call_dnode(L);
+	}
+
+	// collect links of frame's node
+	auto list(traverse_frame& F) const -> void {
+		if(!F.node) return;
+		for(const auto& L : *F.node) {
+			if(can_enter(*L) && L->data_node())
+				F.nodes.push_back(L);
+			else if(opts.list_links)
+				F.leafs.push_back(L);
+		}
+	}
+
+	// returns nothing if link must not be visited, `symlink` is set if sym link is entered
+	auto make_frame(sp_link L, std::size_t depth, bool& symlink) -> std::optional<traverse_frame> {
+		if(!L) return {};
+		symlink = L->type_id() == "sym_link";
+		if(symlink && (!opts.follow_symlinks || !active_symlinks.insert(L->id()).second))
+			return {};
+
+		auto res = traverse_frame{};
+		res.node = can_enter(*L) ? L->data_node() : nullptr;
+		res.link = std::move(L);
+		res.depth = depth;
+		if(opts.list_links) list(res);
+		return res;
+	}
+
+	auto run(std::optional<traverse_frame> root, bool symlink) -> bool {
+		if(!root) return true;
+		return opts.order == TraverseOrder::BFS ?
+			bfs(std::move(*root)) : dfs(std::move(*root), symlink);
+	}
+
+	auto dfs(traverse_frame root, bool root_symlink) -> bool {
+		const bool pre = opts.order == TraverseOrder::PreOrder;
+		struct entry {
+			traverse_frame F;
+			std::list<sp_link>::iterator next;
+			bool symlink;
+		};
+		// deque keeps references to entries valid while stack grows
+		std::deque<entry> stack;
+
+		const auto enter = [&](traverse_frame&& F, bool symlink) {
+			auto step = TraverseStep::Continue;
+			if(pre) step = f(F);
+			if(step == TraverseStep::Stop) return false;
+			if(step == TraverseStep::Skip)
+				F.nodes.clear();
+			else if(!opts.list_links)
+				list(F);
+			auto& e = stack.emplace_back(entry{ std::move(F), {}, symlink });
+			e.next = e.F.nodes.begin();
+			return true;
+		};
+
+		if(!enter(std::move(root), root_symlink)) return false;
+		while(!stack.empty()) {
+			auto& e = stack.back();
+			if(e.next != e.F.nodes.end()) {
+				bool symlink = false;
+				auto child = make_frame(*e.next++, e.F.depth + 1, symlink);
+				if(child && !enter(std::move(*child), symlink)) return false;
+			}
+			else {
+				if(!pre && f(e.F) == TraverseStep::Stop) return false;
+				if(e.symlink) active_symlinks.erase(e.F.link->id());
+				stack.pop_back();
+			}
+		}
+		return true;
+	}
+
+	auto bfs(traverse_frame root) -> bool {
+		std::deque<traverse_frame> queue;
+		queue.push_back(std::move(root));
+		while(!queue.empty()) {
+			auto F = std::move(queue.front());
+			queue.pop_front();
+			const auto step = f(F);
+			if(step == TraverseStep::Stop) return false;
+			if(step == TraverseStep::Skip) continue;
+
+			if(!opts.list_links) list(F);
+			for(auto& L : F.nodes) {
+				bool symlink = false;
+				if(auto child = make_frame(std::move(L), F.depth + 1, symlink))
+					queue.push_back(std::move(*child));
+			}
+		}
+		return true;
+	}
+};
+
+NAMESPACE_END()
+
+auto traverse(const sp_link& root, traverse_fv f, const traverse_opts& opts) -> bool {
+	auto T = traverser{f, opts};
+	bool symlink = false;
+	auto F = T.make_frame(root, 0, symlink);
+	return T.run(std::move(F), symlink);
+}
+
+auto traverse(const sp_node& root, traverse_fv f, const traverse_opts& opts) -> bool {
+	if(!root) return true;
+	auto T = traverser{f, opts};
+	auto F = traverse_frame{};
+	F.link = root->handle();
+	F.node = root;
+	if(opts.list_links) T.list(F);
+	return T.run(std::move(F), false);
+}
+
+NAMESPACE_END(blue_sky::tree)
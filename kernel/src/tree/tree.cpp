@@ -9,8 +9,11 @@
 
 #include <bs/tree/tree.h>
 #include "tree_impl.h"
+#include "job_queue.h"
+#include "path_cache.h"
 
-#include <set>
+#include <atomic>
+#include <mutex>
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -24,61 +27,6 @@ template<Key K> using Key_type = typename node::Key_type<K>;
  *-----------------------------------------------------------------------------*/
 NAMESPACE_BEGIN()
 
-template<class Callback>
-void walk_impl(
-	const std::list<sp_link>& nodes, const Callback& step_f,
-	bool topdown, bool follow_symlinks, bool follow_lazy_links,
-	std::set<Key_type<Key::ID>> active_symlinks = {}
-) {
-	using detail::can_call_dnode;
-	sp_node cur_node;
-	std::list<sp_link> next_nodes;
-	std::vector<sp_link> next_leafs;
-	// for each node
-	for(const auto& N : nodes) {
-		if(!N) continue;
-		// remember symlink
-		const auto is_symlink = N->type_id() == "sym_link";
-		if(is_symlink) {
-			if(follow_symlinks && active_symlinks.find(N->id()) == active_symlinks.end())
-				active_symlinks.insert(N->id());
-			else continue;
-		}
-
-		// obtain node from link honoring LazyLoad flag
-		cur_node = (follow_lazy_links || can_call_dnode(*N)) ? N->data_node() : nullptr;
-
-		next_nodes.clear();
-		next_leafs.clear();
-
-		if(cur_node) {
-			// for each link in node
-			for(const auto& l : *cur_node) {
-				// collect nodes
-				if((follow_lazy_links || can_call_dnode(*l)) && l->data_node()) {
-					next_nodes.push_back(l);
-				}
-				else
-					next_leafs.push_back(l);
-			}
-		}
-
-		// if `topdown` == true, process this node BEFORE leafs processing
-		if(topdown)
-			step_f(N, next_nodes, next_leafs);
-		// process list of next nodes
-		if(!next_nodes.empty())
-			walk_impl(next_nodes, step_f, topdown, follow_symlinks, follow_lazy_links, active_symlinks);
-		// if walking from most deep subdir, process current node after all subtree
-		if(!topdown)
-			step_f(N, next_nodes, next_leafs);
-
-		// forget symlink
-		if(is_symlink)
-			active_symlinks.erase(N->id());
-	}
-}
-
 inline std::string link2path_unit(const link& l, Key path_unit) {
 	switch(path_unit) {
 	default:
@@ -108,6 +56,18 @@ NAMESPACE_END(detail)
 //  abspath
 //
 auto abspath(const link& L, Key path_unit) -> std::string {
+	// paths by all keys except OID are cached
+	// units without own cache slot give path of IDs, like `link2path_unit()`
+	switch(path_unit) {
+	case Key::OID :
+		break;
+	case Key::Name :
+	case Key::Type :
+		return detail::path_cache::abspath(L, path_unit);
+	default :
+		return detail::path_cache::abspath(L, Key::ID);
+	}
+
 	// [NOTE] root ID is irrelevant => abs path always starts with '/'
 	auto pL = &L;
 	auto parent = L.owner();
@@ -139,14 +99,9 @@ auto abspath(const sp_clink& L, Key path_unit) -> std::string {
 //  find_root & find_root_handle
 //
 auto find_root(link& L) -> sp_node {
-	if(auto root = L.owner()) {
-		while(const auto root_h = root->handle()) {
-			if(auto parent = root_h->owner())
-				root = std::move(parent);
-			else return root;
-		}
-	}
-	// root handle is passed
+	// top node is returned only if it has a handle, root handle or link without owner is passed otherwise
+	if(auto root = detail::path_cache::root(L).first; root && root->handle())
+		return root;
 	return L.data_node();
 }
 
@@ -156,39 +111,21 @@ auto find_root(const sp_link& L) -> sp_node {
 
 // [NOTE] avoid `data_node()` call
 auto find_root(sp_node N) -> sp_node {
-	if(N) {
-		while(const auto root_h = N->handle()) {
-			if(auto parent = root_h->owner())
-				N = std::move(parent);
-			else break;
-		}
+	if(const auto N_h = N ? N->handle() : nullptr) {
+		if(auto root = detail::path_cache::root(*N_h).first)
+			return root;
 	}
 	return N;
 }
 
-NAMESPACE_BEGIN()
-
-const auto find_root_handle_impl = [](auto L) {
-	if(L) {
-		while(const auto root = L->owner()) {
-			if(auto root_h = root->handle())
-				L = std::move(root_h);
-			else break;
-		}
-	}
-	return L;
-};
-
-NAMESPACE_END()
-
 auto find_root_handle(sp_link L) -> sp_link {
-	return find_root_handle_impl(std::move(L));
+	return L ? std::const_pointer_cast<link>(detail::path_cache::root(*L).second) : L;
 }
 auto find_root_handle(sp_clink L) -> sp_clink {
-	return find_root_handle_impl(std::move(L));
+	return L ? detail::path_cache::root(*L).second : L;
 }
 auto find_root_handle(const sp_node& N) -> sp_link {
-	return find_root_handle_impl(N->handle());
+	return find_root_handle(N->handle());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -242,6 +179,96 @@ sp_link deref_path(
 	);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//  deref_paths
+//
+auto deref_paths(
+	const std::vector<std::string>& paths, sp_link start, node::Key path_unit,
+	bool follow_lazy_links, bool parallel
+) -> std::vector<sp_link> {
+	return detail::deref_paths_impl(
+		paths, std::move(start), follow_lazy_links, parallel, detail::gen_walk_down_tree(path_unit)
+	);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//  deref_glob
+//
+auto deref_glob(
+	const std::string& pattern, sp_link start, glob_process_f f, bool follow_lazy_links, bool parallel
+) -> std::size_t {
+	if(pattern.empty() || !start) return 0;
+	std::vector<std::string> parts;
+	boost::split(parts, pattern, boost::is_any_of("/"));
+
+	// state of pattern resolving: current link, node to search next level in & index of next level
+	struct job {
+		sp_link L;
+		sp_node level;
+		std::size_t part;
+	};
+	detail::job_queue<job> Q(parallel);
+	std::mutex f_guard;
+	std::atomic<bool> stop = false;
+	std::size_t n_found = 0;
+
+	const auto process = [&](job&& j) {
+		for(; !stop && j.part < parts.size(); ++j.part) {
+			const auto& part = parts[j.part];
+			if(part.empty() || part == ".") continue;
+			if(part == "..") {
+				j.level = j.L->owner();
+				continue;
+			}
+			if(!j.level)
+				j.level = follow_lazy_links || detail::can_call_dnode(*j.L) ? j.L->data_node() : nullptr;
+			if(!j.level) return;
+
+			// exact level
+			if(detail::glob_prefix(part).size() == part.size()) {
+				auto next = j.level->find(part, Key::Name);
+				if(next == j.level->end()) return;
+				j.L = *next;
+				j.level.reset();
+				continue;
+			}
+			// wildcard level - continue resolving every matched link separately
+			// matches are found using Name index range for literal prefix
+			query(j.level).name_glob(part).max_depth(0).for_each([&](const sp_link& L) {
+				Q.push({L, nullptr, j.part + 1});
+				return !stop;
+			});
+			return;
+		}
+		// all levels are resolved
+		if(stop) return;
+		std::lock_guard<std::mutex> my_turn(f_guard);
+		if(!stop) {
+			++n_found;
+			if(!f(j.L)) stop = true;
+		}
+	};
+
+	// absolute path starts from root
+	if(parts[0].empty())
+		Q.push({find_root_handle(std::move(start)), nullptr, 1});
+	else
+		Q.push({std::move(start), nullptr, 0});
+	Q.run(process);
+	return n_found;
+}
+
+auto deref_glob(
+	const std::string& pattern, sp_link start, bool follow_lazy_links, bool parallel
+) -> std::vector<sp_link> {
+	std::vector<sp_link> res;
+	deref_glob(pattern, std::move(start), [&](const sp_link& L) {
+		res.push_back(L);
+		return true;
+	}, follow_lazy_links, parallel);
+	return res;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //  walk
 //
@@ -249,7 +276,15 @@ auto walk(
 	const sp_link& root, step_process_fv step_f,
 	bool topdown, bool follow_symlinks, bool follow_lazy_links
 ) -> void {
-	walk_impl({root}, step_f, topdown, follow_symlinks, follow_lazy_links);
+	auto opts = traverse_opts{};
+	opts.order = topdown ? TraverseOrder::PreOrder : TraverseOrder::PostOrder;
+	opts.follow_symlinks = follow_symlinks;
+	opts.follow_lazy_links = follow_lazy_links;
+	opts.list_links = true;
+	traverse(root, [&](traverse_frame& F) {
+		step_f(F.link, F.nodes, F.leafs);
+		return TraverseStep::Continue;
+	}, opts);
 }
 
 auto make_root_link(
@@ -18,6 +18,8 @@
 #include <caf/all.hpp>
 
 CAF_ALLOW_UNSAFE_MESSAGE_TYPE(blue_sky::tree::deref_process_f)
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(blue_sky::tree::deref_paths_process_f)
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(blue_sky::tree::cancel_token)
 
 using walk_down_ft = decltype( blue_sky::tree::detail::gen_walk_down_tree() );
 CAF_ALLOW_UNSAFE_MESSAGE_TYPE(walk_down_ft)
@@ -31,7 +33,7 @@ NAMESPACE_BEGIN()
 
 template <typename level_process_f>
 using deref_actor_t = caf::typed_actor<
-	caf::reacts_to<std::string, sp_link, level_process_f, deref_process_f, bool>
+	caf::reacts_to<std::string, sp_link, level_process_f, deref_process_f, bool, cancel_token>
 >;
 
 template<typename level_process_f>
@@ -50,15 +52,49 @@ struct deref_actor : blue_sky::detail::anon_async_api_mixin< deref_actor_t<level
 			[](
 				const std::string& path, sp_link lnk,
 				const level_process_f& lp, const deref_process_f& f,
-				bool follow_lazy_links
+				bool follow_lazy_links, const cancel_token& token
 			) {
-				f(detail::deref_path_impl(path, std::move(lnk), nullptr, follow_lazy_links, lp));
+				// drop expired request & stop walking down as soon as token fires
+				if(token.is_cancelled()) return f(nullptr);
+				const auto S = cancel_token::scope(token);
+				f(detail::deref_path_impl(
+					path, std::move(lnk), nullptr, follow_lazy_links,
+					[&](const std::string& next_lid, const sp_node& cur_level) -> sp_link {
+						return token.is_cancelled() ? nullptr : lp(next_lid, cur_level);
+					}
+				));
 			}
 		};
 	}
 
 };
 
+// batch deref actor, paths are resolved in parallel
+using deref_paths_actor_t = caf::typed_actor<
+	caf::reacts_to<std::vector<std::string>, sp_link, walk_down_ft, deref_paths_process_f, bool>
+>;
+
+struct deref_paths_actor : blue_sky::detail::anon_async_api_mixin<deref_paths_actor_t> {
+	using actor_t = deref_paths_actor_t;
+	using base_t = blue_sky::detail::anon_async_api_mixin<actor_t>;
+
+	deref_paths_actor() : base_t(false) {
+		spawn<caf::spawn_options::lazy_init_flag>(async_behavior);
+	}
+
+	static auto async_behavior(actor_t::pointer self) -> actor_t::behavior_type {
+		return {
+			[](
+				const std::vector<std::string>& paths, sp_link lnk,
+				const walk_down_ft& lp, const deref_paths_process_f& f,
+				bool follow_lazy_links
+			) {
+				f(detail::deref_paths_impl(paths, std::move(lnk), follow_lazy_links, true, lp));
+			}
+		};
+	}
+};
+
 NAMESPACE_END()
 
 /*-----------------------------------------------------------------------------
@@ -68,6 +104,16 @@ NAMESPACE_END()
 auto deref_path(
 	deref_process_f f, std::string path, sp_link start, node::Key path_unit,
 	bool follow_lazy_links, bool high_priority
+) -> void {
+	deref_path(
+		std::move(f), cancel_token::none(), std::move(path), std::move(start), path_unit,
+		follow_lazy_links, high_priority
+	);
+}
+
+auto deref_path(
+	deref_process_f f, cancel_token token, std::string path, sp_link start, node::Key path_unit,
+	bool follow_lazy_links, bool high_priority
 ) -> void {
 	// create local temp actor
 	deref_actor<walk_down_ft> actor;
@@ -76,12 +122,25 @@ auto deref_path(
 	actor.send(
 		high_priority ? caf::message_priority::high : caf::message_priority::normal,
 		std::move(path), std::move(start), detail::gen_walk_down_tree(path_unit), std::move(f),
-		follow_lazy_links
+		follow_lazy_links, std::move(token)
 	);
 	// and forget about actor
 	// 1. message should arrive, then actor initialization is performed, then it gets executed
 	// 2. and after that actor itself dies because no more strong references to it exist
 }
 
+auto deref_paths(
+	deref_paths_process_f f, std::vector<std::string> paths, sp_link start, node::Key path_unit,
+	bool follow_lazy_links, bool high_priority
+) -> void {
+	// same as above - send single message to temp actor & forget about it
+	deref_paths_actor actor;
+	actor.send(
+		high_priority ? caf::message_priority::high : caf::message_priority::normal,
+		std::move(paths), std::move(start), detail::gen_walk_down_tree(path_unit), std::move(f),
+		follow_lazy_links
+	);
+}
+
 NAMESPACE_END(blue_sky::tree)
 
@@ -10,8 +10,12 @@
 #pragma once
 
 #include <bs/tree/tree.h>
+#include "job_queue.h"
 #include <boost/algorithm/string.hpp>
 
+#include <map>
+#include <string_view>
+
 #define CAN_CALL_DNODE(L) \
 ( !((L).flags() & link::LazyLoad) || (L).req_status(link::Req::DataNode) == link::ReqStatus::OK )
 
@@ -31,6 +35,34 @@ auto gen_walk_down_tree(node::Key path_unit = node::Key::ID) {
 
 NAMESPACE_END()
 
+// match string against glob pattern with '*' (any sequence) and '?' (any char) wildcards
+inline auto glob_match(std::string_view pattern, std::string_view s) -> bool {
+	std::size_t p = 0, i = 0, star_p = std::string_view::npos, star_i = 0;
+	while(i < s.size()) {
+		if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == s[i])) {
+			++p; ++i;
+		}
+		else if(p < pattern.size() && pattern[p] == '*') {
+			// remember star position & try to match empty sequence first
+			star_p = p++;
+			star_i = i;
+		}
+		else if(star_p != std::string_view::npos) {
+			// extend sequence matched by last star
+			p = star_p + 1;
+			i = ++star_i;
+		}
+		else return false;
+	}
+	while(p < pattern.size() && pattern[p] == '*') ++p;
+	return p == pattern.size();
+}
+
+// literal part of glob pattern before first wildcard
+inline auto glob_prefix(std::string_view pattern) -> std::string_view {
+	return pattern.substr(0, pattern.find_first_of("*?"));
+}
+
 // find out if we can call `data_node()` honoring LazyLoad flag
 inline auto can_call_dnode(const link& L) -> bool {
 	return !(L.flags() & link::LazyLoad) || L.req_status(link::Req::DataNode) == link::ReqStatus::OK;
@@ -85,4 +117,68 @@ auto deref_path_impl(
 	return L;
 }
 
+// Resolve batch of paths, each shared prefix is dereferenced only once.
+// Paths are merged into trie which edges are path parts, after walking an edge
+// every child edge is processed as separate job (in parallel if `parallel` is set).
+// Results are returned in the same order as paths.
+template<typename level_deref_f = decltype(gen_walk_down_tree())>
+auto deref_paths_impl(
+	const std::vector<std::string>& paths, sp_link start, bool follow_lazy_links = true,
+	bool parallel = true, level_deref_f deref_f = gen_walk_down_tree()
+) -> std::vector<sp_link> {
+	struct trie_node {
+		std::map<std::string, trie_node, std::less<>> children;
+		// indexes of paths that end here
+		std::vector<std::size_t> ends;
+	};
+
+	// build trie
+	trie_node trie;
+	std::vector<std::string> path_parts;
+	for(std::size_t i = 0; i < paths.size(); ++i) {
+		if(paths[i].empty()) continue;
+		boost::split(path_parts, paths[i], boost::is_any_of("/"));
+		auto* cur = &trie;
+		for(auto& part : path_parts)
+			cur = &cur->children[std::move(part)];
+		cur->ends.push_back(i);
+	}
+
+	// resolver state after walking to trie node: same as in `deref_path_impl()`
+	struct job {
+		const trie_node* tn;
+		sp_link L;
+		sp_node root;
+		bool is_top;
+	};
+	std::vector<sp_link> res(paths.size());
+	job_queue<job> Q(parallel);
+	Q.push({&trie, std::move(start), nullptr, true});
+	Q.run([&](job&& j) {
+		// every path ends in it's own trie node, so there are no concurrent writes
+		for(auto i : j.tn->ends) res[i] = j.L;
+
+		for(const auto& [part, child] : j.tn->children) {
+			auto L = j.L;
+			auto root = j.root;
+			if(part.empty()) {
+				// absolute path case
+				if(j.is_top && (root = find_root(L)))
+					L = root->handle();
+			}
+			else if(part == "..")
+				root = L ? L->owner() : nullptr;
+			else if(part != ".") {
+				if(!root)
+					root = L && (follow_lazy_links || can_call_dnode(*L)) ? L->data_node() : nullptr;
+				// all paths in child subtree are unresolved
+				if(!root || !(L = deref_f(part, root))) continue;
+				root.reset();
+			}
+			Q.push({&child, std::move(L), std::move(root), false});
+		}
+	});
+	return res;
+}
+
 NAMESPACE_END(blue_sky::tree::detail)
@@ -21,7 +21,14 @@
 #include <bs/serialize/tree.h>
 
 #include <boost/test/unit_test.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <caf/scoped_actor.hpp>
 
 using namespace blue_sky;
@@ -42,6 +49,36 @@ class fusion_client : public fusion_iface {
 	}
 };
 
+// bridge that loads data until request is cancelled
+class stalled_client : public fusion_iface {
+public:
+	// wait until `n` requests are started
+	auto wait_started(std::size_t n) -> bool {
+		std::unique_lock<std::mutex> my_turn(guard_);
+		return started_.wait_for(my_turn, std::chrono::seconds(5), [&] { return n_started_ >= n; });
+	}
+
+private:
+	std::mutex guard_;
+	std::condition_variable started_;
+	std::size_t n_started_ = 0;
+
+	auto populate(const sp_node& root, const std::string& child_type_id = "") -> error override {
+		return pull_data(root);
+	}
+
+	auto pull_data(const sp_obj& root) -> error override {
+		{
+			std::lock_guard<std::mutex> my_turn(guard_);
+			++n_started_;
+		}
+		started_.notify_all();
+		while(!cancel_token::current().is_cancelled())
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		return error::quiet("aborted", Error::EmptyData);
+	}
+};
+
 } // eof hidden namespace
 
 BOOST_AUTO_TEST_CASE(test_tree) {
@@ -123,3 +160,1381 @@ BOOST_AUTO_TEST_CASE(test_tree) {
 	//}
 }
 
+BOOST_AUTO_TEST_CASE(test_tree_clone) {
+	std::cout << "\n\n*** testing tree clone..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// make tree with several levels of nested nodes
+	auto make_level = [](const sp_node& N, int n_persons) {
+		for(int i = 0; i < n_persons; ++i) {
+			std::string p_name = "Citizen_" + std::to_string(i);
+			N->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(i + 20)));
+		}
+	};
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	make_level(N, 10);
+	for(int i = 0; i < 5; ++i) {
+		sp_node sub = kernel::tfactory::create_object("node");
+		make_level(sub, 10);
+		for(int j = 0; j < 3; ++j) {
+			sp_node subsub = kernel::tfactory::create_object("node");
+			make_level(subsub, 5);
+			sub->insert("subsub_" + std::to_string(j), subsub);
+		}
+		N->insert("sub_" + std::to_string(i), sub);
+	}
+
+	for(bool parallel : {false, true}) {
+		auto N1 = N->clone(parallel);
+		BOOST_TEST(N1);
+		BOOST_TEST(N1 != N);
+		BOOST_TEST(N1->size() == N->size());
+		// check that every link in cloned subtree has correct owner
+		// and nodes have correct handles
+		std::size_t n_links = 0;
+		walk(link::make_root<hard_link>("r1", N1), [&](
+			const sp_link& root, std::list<sp_link>&, std::vector<sp_link>&
+		) {
+			const auto root_node = root->data_node();
+			for(const auto& L : *root_node) {
+				++n_links;
+				BOOST_TEST(L->owner() == root_node);
+				if(const auto sub = L->data_node())
+					BOOST_TEST(sub->handle() == L);
+			}
+		});
+		BOOST_TEST(n_links == 10 + 5*(1 + 10 + 3*(1 + 5)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_move) {
+	std::cout << "\n\n*** testing links move..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node src = kernel::tfactory::create_object("node");
+	sp_node dst = kernel::tfactory::create_object("node");
+	N->insert("src", src);
+	N->insert("dst", dst);
+	std::vector<node::id_type> lids;
+	for(int i = 0; i < 5; ++i) {
+		std::string p_name = "Citizen_" + std::to_string(i);
+		src->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(i + 20)));
+		lids.push_back(src->find(i)->get()->id());
+	}
+	dst->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+
+	// single move keeps link instance
+	const auto L = *src->begin();
+	auto res = src->move(L->id(), dst, node::InsertPolicy::RenameDup);
+	BOOST_TEST(res.second);
+	BOOST_TEST(*res.first == L);
+	BOOST_TEST(L->owner() == dst);
+	BOOST_TEST(L->name() != "Citizen_0");
+	BOOST_TEST(src->size() == 4);
+	BOOST_TEST(dst->size() == 2);
+	// denied move leaves link in source
+	src->rename(lids[1], "Citizen_0");
+	BOOST_TEST(!src->move(lids[1], dst, node::InsertPolicy::DenyDupNames).second);
+	BOOST_TEST(src->find(lids[1]) != src->end());
+	// move rejected after link was auto-renamed restores it's name
+	dst->insert(std::make_shared<hard_link>("copy", src->find(lids[1])->get()->data()));
+	BOOST_TEST(!src->move(
+		lids[1], dst, node::InsertPolicy::RenameDup | node::InsertPolicy::DenyDupOID
+	).second);
+	BOOST_TEST(src->find(lids[1])->get()->name() == "Citizen_0");
+	BOOST_TEST(src->find("Citizen_0", node::Key::Name) != src->end());
+	// bulk move to the beginning of destination
+	BOOST_TEST(src->move({lids[3], lids[4]}, dst, 0) == 2);
+	BOOST_TEST(dst->find(std::size_t(0))->get()->id() == lids[3]);
+	BOOST_TEST(dst->find(std::size_t(1))->get()->id() == lids[4]);
+	// node can't be moved inside itself
+	BOOST_TEST(!N->move(src->handle()->id(), src).second);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_indexes) {
+	std::cout << "\n\n*** testing node without secondary indexes..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	using Indexes = node::Indexes;
+	auto N = std::make_shared<node>("", Indexes::None);
+	for(int i = 0; i < 10; ++i) {
+		std::string p_name = "Citizen_" + std::to_string(i % 5);
+		N->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(i + 20)));
+	}
+
+	// keys without index are searched by scanning links, container isn't rebuilt
+	BOOST_TEST(N->find("Citizen_3", node::Key::Name)->get()->name() == "Citizen_3");
+	BOOST_TEST(N->find("bs_person", node::Key::Type) == N->begin());
+	BOOST_TEST(N->deep_search("Citizen_4", node::Key::Name));
+	BOOST_TEST(N->keys<node::Key::Name>().size() == 5);
+	BOOST_TEST(N->rename("Citizen_1", "Citizen_5", node::Key::Name, true) == 2);
+	auto dup = kernel::tfactory::create_object("bs_person", "Citizen_5", 42.);
+	BOOST_TEST(!N->insert("Citizen_5", std::move(dup), node::InsertPolicy::DenyDupNames).second);
+	N->erase("Citizen_2", node::Key::Name);
+	BOOST_TEST(N->size() == 8);
+	BOOST_TEST(N->indexes() == Indexes::None);
+
+	// range query builds index & gives same links as scan
+	const auto r = N->equal_range("Citizen_5");
+	BOOST_TEST(std::distance(r.first, r.second) == 2);
+	BOOST_TEST(N->indexes() == Indexes::Name);
+	const auto types = N->equal_type("bs_person");
+	BOOST_TEST(std::distance(types.first, types.second) == 8);
+	BOOST_TEST(N->indexes() == (Indexes::Name | Indexes::Type));
+	BOOST_TEST(std::distance(N->begin<node::Key::OID>(), N->end<node::Key::OID>()) == 8);
+	BOOST_TEST(N->indexes() == Indexes::All);
+
+	// dropped index is kept in sync again after it's built
+	N->set_indexes(Indexes::None);
+	N->rename("Citizen_0", "Citizen_7", node::Key::Name, true);
+	const auto renamed = N->equal_range("Citizen_7");
+	BOOST_TEST(std::distance(renamed.first, renamed.second) == 2);
+	const auto old = N->equal_range("Citizen_0");
+	BOOST_TEST((old.first == old.second));
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_paths) {
+	std::cout << "\n\n*** testing cached paths..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	sp_node B = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	A->insert("B", B);
+	B->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	const auto L = *B->begin();
+
+	BOOST_TEST(abspath(hN, node::Key::Name) == "/");
+	BOOST_TEST(abspath(L, node::Key::Name) == "/A/B/Citizen_0");
+	BOOST_TEST(find_root(L) == N);
+	BOOST_TEST(find_root(B) == N);
+	BOOST_TEST(find_root_handle(L) == hN);
+	// repeating call gives same result
+	BOOST_TEST(abspath(L, node::Key::Name) == "/A/B/Citizen_0");
+
+	// cached paths are updated after rename & move of ancestors
+	L->rename("Citizen_1");
+	BOOST_TEST(abspath(L, node::Key::Name) == "/A/B/Citizen_1");
+	A->handle()->rename("AA");
+	BOOST_TEST(abspath(L, node::Key::Name) == "/AA/B/Citizen_1");
+	A->move(B->handle()->id(), N);
+	BOOST_TEST(abspath(L, node::Key::Name) == "/B/Citizen_1");
+	BOOST_TEST(abspath(L) == "/" + boost::uuids::to_string(B->handle()->id()) + '/' + boost::uuids::to_string(L->id()));
+	BOOST_TEST(abspath(L, node::Key::OID) == "/" + B->handle()->oid() + '/' + L->oid());
+	// custom order has no path units, so path of IDs is returned
+	BOOST_TEST(abspath(L, node::Key::AnyOrder) == abspath(L));
+
+	// subtree moved under another root
+	auto hM = make_root_link("hard_link", "m");
+	N->move(B->handle()->id(), hM->data_node());
+	BOOST_TEST(abspath(L, node::Key::Name) == "/B/Citizen_1");
+	BOOST_TEST(find_root(L) == hM->data_node());
+	BOOST_TEST(find_root_handle(L) == hM);
+
+	// root of another tree gets an owner
+	auto hK = make_root_link("hard_link", "K");
+	auto K = hK->data_node();
+	K->insert("Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.));
+	const auto L2 = *K->begin();
+	BOOST_TEST(abspath(L2, node::Key::Name) == "/Citizen_2");
+	BOOST_TEST(find_root(L2) == K);
+	N->insert(hK);
+	BOOST_TEST(abspath(L2, node::Key::Name) == "/K/Citizen_2");
+	BOOST_TEST(find_root(L2) == N);
+	BOOST_TEST(find_root_handle(L2) == hN);
+	// paths in other tree stay valid
+	BOOST_TEST(abspath(L, node::Key::Name) == "/B/Citizen_1");
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_summary) {
+	std::cout << "\n\n*** testing subtree summary..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	BOOST_TEST(N->enable_summary());
+	// summary can't be turned off inside summarized subtree
+	BOOST_TEST(A->enable_summary(false));
+
+	// existing & later inserted nodes are summarized
+	sp_node B = kernel::tfactory::create_object("node");
+	B->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+	A->insert("B", B);
+	BOOST_TEST(N->may_contain("Citizen_0"));
+	BOOST_TEST(N->may_contain("Citizen_1"));
+	BOOST_TEST(!N->may_contain("Citizen_2"));
+	BOOST_TEST(!N->deep_search("Citizen_2", node::Key::Name));
+	BOOST_TEST(N->deep_search("Citizen_1", node::Key::Name));
+	const auto oid = B->begin()->get()->oid();
+	BOOST_TEST(N->deep_search(oid, node::Key::OID));
+
+	// rename, move & erase update summaries of all ancestors
+	B->begin()->get()->rename("Citizen_2");
+	BOOST_TEST(N->deep_search("Citizen_2", node::Key::Name));
+	BOOST_TEST(!B->may_contain("Citizen_1"));
+	A->move(B->handle()->id(), N);
+	BOOST_TEST(N->may_contain("Citizen_2"));
+	BOOST_TEST(!A->may_contain("Citizen_2"));
+	N->erase("B", node::Key::Name);
+	BOOST_TEST(!N->may_contain(oid, node::Key::OID));
+	BOOST_TEST(!N->deep_search("Citizen_2", node::Key::Name));
+
+	// subtree of fusion link can be populated later, so anything may be there
+	auto F = std::make_shared<fusion_link>("F", std::make_shared<node>(), std::make_shared<fusion_client>());
+	A->insert(F);
+	BOOST_TEST(N->may_contain("Citizen_42"));
+	A->erase(F->id());
+	BOOST_TEST(!N->may_contain("Citizen_42"));
+
+	// filter grows with number of keys without false negatives
+	constexpr std::size_t n_persons = 1000;
+	for(std::size_t i = 0; i < n_persons; ++i)
+		A->insert("P_" + std::to_string(i), kernel::tfactory::create_object("bs_person", "P", 30.));
+	std::size_t n_found = 0, n_false = 0;
+	for(std::size_t i = 0; i < n_persons; ++i) {
+		n_found += N->may_contain("P_" + std::to_string(i));
+		n_false += N->may_contain("Q_" + std::to_string(i));
+	}
+	BOOST_TEST(n_found == n_persons);
+	BOOST_TEST(n_false < n_persons / 10);
+
+	// sym link can lead anywhere, so it disables pruning
+	A->insert(std::make_shared<sym_link>("sym", "/A/Citizen_0"));
+	BOOST_TEST(N->may_contain("Citizen_42"));
+	BOOST_TEST(!N->enable_summary(false));
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_stats) {
+	std::cout << "\n\n*** testing subtree stats..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	const auto age = [](const sp_link& L) {
+		const auto P = std::dynamic_pointer_cast<bs_person>(L->data());
+		return P ? P->age_ : 0.;
+	};
+	node::register_metric("age", age);
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	BOOST_TEST(N->enable_stats());
+	BOOST_TEST(A->enable_stats(false));
+
+	// later inserted nodes are counted
+	sp_node B = kernel::tfactory::create_object("node");
+	B->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+	A->insert("B", B);
+	auto S = N->stats();
+	BOOST_TEST(S.links == 4);
+	BOOST_TEST(S.nodes == 2);
+	BOOST_TEST(S.types["node"] == 2);
+	BOOST_TEST(S.types["bs_person"] == 2);
+	BOOST_TEST(S.metrics["age"] == 41.);
+
+	// move & erase update stats of all ancestors
+	A->move(B->handle()->id(), N);
+	BOOST_TEST(N->stats().links == 4);
+	BOOST_TEST(A->stats().links == 1);
+	N->erase("B", node::Key::Name);
+	S = N->stats();
+	BOOST_TEST(S.links == 2);
+	BOOST_TEST(S.nodes == 1);
+	BOOST_TEST(S.types["bs_person"] == 1);
+	BOOST_TEST(S.metrics["age"] == 20.);
+
+	// sym link is counted, but pointed object isn't
+	A->insert(std::make_shared<sym_link>("sym", "/A/Citizen_0"));
+	S = N->stats();
+	BOOST_TEST(S.links == 3);
+	BOOST_TEST(S.types["bs_person"] == 1);
+
+	// metric registered later is calculated on next read
+	node::register_metric("double_age", [=](const sp_link& L) { return 2 * age(L); });
+	BOOST_TEST(N->stats().metrics["double_age"] == 40.);
+
+	// deep chain is counted, recalculated and dropped without recursion
+	constexpr std::size_t depth = 100000;
+	sp_node C = kernel::tfactory::create_object("node");
+	auto tail = C;
+	for(std::size_t i = 0; i < depth; ++i) {
+		auto next = std::make_shared<node>();
+		tail->insert("level", next);
+		tail = std::move(next);
+	}
+	tail->insert("Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.));
+	A->insert("C", C);
+	S = N->stats();
+	BOOST_TEST(S.links == 5 + depth);
+	BOOST_TEST(S.nodes == 2 + depth);
+	BOOST_TEST(S.metrics["age"] == 42.);
+	node::register_metric("age", [=](const sp_link& L) { return 3 * age(L); });
+	BOOST_TEST(N->stats().metrics["age"] == 126.);
+	BOOST_TEST(tail->stats().metrics["age"] == 66.);
+
+	// stats are read while subtree is changed and metrics are registered
+	auto reader = std::async(std::launch::async, [&] {
+		for(int i = 0; i < 100; ++i) N->stats();
+	});
+	for(int i = 0; i < 10; ++i) {
+		node::register_metric("age", [=](const sp_link& L) { return (i + 1) * age(L); });
+		tail->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 1.));
+		tail->erase("Citizen_3", node::Key::Name);
+	}
+	reader.get();
+	BOOST_TEST(N->stats().metrics["age"] == 420.);
+	A->erase("C", node::Key::Name);
+	BOOST_TEST(N->stats().links == 3);
+
+	node::register_metric("age", nullptr);
+	node::register_metric("double_age", nullptr);
+	BOOST_TEST(!N->enable_stats(false));
+	BOOST_TEST(N->stats().links == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_snapshot) {
+	std::cout << "\n\n*** testing tree snapshots..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	for(int i = 0; i < 3; ++i) {
+		std::string p_name = "Citizen_" + std::to_string(i);
+		A->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(i + 20)));
+	}
+	const auto names = [](const std::vector<snapshot::leaf>& leafs) {
+		std::vector<std::string> res;
+		for(const auto& l : leafs) res.push_back(l.name);
+		return res;
+	};
+	const auto S1_names = std::vector<std::string>{ "Citizen_0", "Citizen_1", "Citizen_2" };
+
+	auto S1 = std::make_unique<snapshot>(hN);
+	// change live tree after snapshot is taken
+	A->begin()->get()->rename("Citizen_42");
+	A->erase("Citizen_1", node::Key::Name);
+	A->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 23.));
+	sp_node B = kernel::tfactory::create_object("node");
+	B->insert("Citizen_4", kernel::tfactory::create_object("bs_person", "Citizen_4", 24.));
+	N->insert("B", B);
+
+	// snapshot still sees initial tree
+	BOOST_TEST(names(*S1->leafs(A)) == S1_names);
+	BOOST_TEST(S1->leafs(N)->size() == 1);
+	std::size_t n_nodes = 0, n_leafs = 0;
+	S1->walk([&](const sp_node&, const std::vector<snapshot::leaf>& leafs) {
+		++n_nodes;
+		n_leafs += leafs.size();
+	});
+	BOOST_TEST(n_nodes == 2);
+	BOOST_TEST(n_leafs == 4);
+
+	// newer snapshot sees changes, older one is isolated from further changes
+	auto S2 = std::make_unique<snapshot>(hN);
+	BOOST_TEST(S2->epoch() > S1->epoch());
+	const auto S2_names = std::vector<std::string>{ "Citizen_42", "Citizen_2", "Citizen_3" };
+	BOOST_TEST(names(*S2->leafs(A)) == S2_names);
+	// unchanged node gives same list to all readers, that list is saved on next change
+	auto S2_A = S2->leafs(A);
+	BOOST_TEST(S2->leafs(A) == S2_A);
+	const auto L2 = std::weak_ptr<link>(*A->find("Citizen_2", node::Key::Name));
+	A->clear();
+	BOOST_TEST(names(*S1->leafs(A)) == S1_names);
+	BOOST_TEST(S2->leafs(A) == S2_A);
+	n_nodes = 0;
+	S2->walk([&](const sp_node&, const std::vector<snapshot::leaf>&) { ++n_nodes; });
+	BOOST_TEST(n_nodes == 3);
+
+	// after all snapshots are gone, saved lists are dropped & reads see live tree
+	S1.reset();
+	S2.reset();
+	S2_A.reset();
+	BOOST_TEST(L2.expired());
+	A->insert("Citizen_5", kernel::tfactory::create_object("bs_person", "Citizen_5", 25.));
+	BOOST_TEST(snapshot(hN).leafs(A)->size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_page) {
+	std::cout << "\n\n*** testing paged node iteration..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto N = std::make_shared<node>();
+	for(int i = 9; i >= 0; --i) {
+		std::string p_name = "Citizen_" + std::to_string(i);
+		N->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(i + 20)));
+	}
+
+	// read all links by pages in name order
+	std::vector<std::string> names;
+	auto cur = node::cursor{};
+	while(!cur.at_end) {
+		auto P = N->page(node::Key::Name, cur, 3);
+		BOOST_TEST(P.links.size() <= 3);
+		for(const auto& L : P.links) names.push_back(L->name());
+		cur = P.next;
+	}
+	BOOST_TEST(names.size() == 10);
+	BOOST_TEST(std::is_sorted(names.begin(), names.end()));
+	BOOST_TEST(cur.offset == 10);
+
+	// cursor stays valid while node changes
+	auto P = N->page(node::Key::AnyOrder, {}, 4);
+	BOOST_TEST(P.links.front()->name() == "Citizen_9");
+	N->insert("Citizen_10", kernel::tfactory::create_object("bs_person", "Citizen_10", 30.));
+	P = N->page(node::Key::AnyOrder, P.next, 4);
+	BOOST_TEST_REQUIRE(P.links.size() == 4);
+	BOOST_TEST(P.links.front()->name() == "Citizen_5");
+	// last returned link is erased => continue from link that followed it
+	// even if preceding links are erased too and positions are shifted
+	N->erase(P.links.back()->id());
+	N->erase("Citizen_9", node::Key::Name);
+	P = N->page(node::Key::AnyOrder, P.next, 100);
+	BOOST_TEST(P.next.at_end);
+	BOOST_TEST_REQUIRE(P.links.size() == 3);
+	BOOST_TEST(P.links.front()->name() == "Citizen_1");
+	BOOST_TEST(P.links.back()->name() == "Citizen_10");
+
+	// same for key order without index, links with equal keys aren't skipped
+	auto M = std::make_shared<node>("", node::Indexes::None);
+	for(int i = 0; i < 4; ++i)
+		M->insert("Citizen", kernel::tfactory::create_object("bs_person", "Citizen", double(i + 20)));
+	P = M->page(node::Key::Name, {}, 2);
+	BOOST_TEST_REQUIRE(P.links.size() == 2);
+	BOOST_TEST(M->page(node::Key::Name, {}, 2).links == P.links);
+	M->erase(P.links.back()->id());
+	P = M->page(node::Key::Name, P.next, 100);
+	BOOST_TEST(P.next.at_end);
+	BOOST_TEST(P.links.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_batch) {
+	std::cout << "\n\n*** testing multi-node batch..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	sp_node B = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	N->insert("B", B);
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	A->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+	const auto L0 = *A->begin(), L1 = *std::next(A->begin());
+
+	// events preceding insert of "sync" link are counted
+	std::mutex guard;
+	std::condition_variable delivered;
+	std::size_t n_events = 0;
+	bool synced = false;
+	N->subscribe([&](std::vector<event> batch) {
+		std::lock_guard<std::mutex> my_turn(guard);
+		for(const auto& e : batch) {
+			if(e.link->name_ref() == "sync") synced = true;
+			else if(!synced) ++n_events;
+		}
+		delivered.notify_all();
+	});
+
+	// failed batch leaves tree untouched
+	auto b = batch{};
+	b.insert(B, "Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.))
+		.rename(A, L0->id(), "Citizen_42")
+		.erase(A, L1->id())
+		.move(A, L0->id(), B)
+		.erase(B, L1->id());
+	BOOST_TEST(b.size() == 5);
+	BOOST_TEST((b.commit().code == Error::KeyMismatch));
+	BOOST_TEST(b.empty());
+	BOOST_TEST(A->size() == 2);
+	BOOST_TEST(B->empty());
+	BOOST_TEST(L0->name() == "Citizen_0");
+	BOOST_TEST(L0->owner() == A);
+	BOOST_TEST(A->find(std::size_t(1))->get() == L1.get());
+
+	// aborted batch isn't applied
+	b.erase(A, L0->id());
+	b.abort();
+	BOOST_TEST(b.commit().ok());
+	BOOST_TEST(A->size() == 2);
+
+	// successful batch
+	b.insert(B, "Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.))
+		.rename(A, L0->id(), "Citizen_42")
+		.erase(A, L1->id())
+		.move(A, L0->id(), B);
+	BOOST_TEST(b.commit().ok());
+	BOOST_TEST(A->empty());
+	BOOST_TEST(B->size() == 2);
+	BOOST_TEST(L0->name() == "Citizen_42");
+	BOOST_TEST(L0->owner() == B);
+	BOOST_TEST(B->find("Citizen_2", node::Key::Name) != B->end());
+	BOOST_TEST(B->find("Citizen_2", node::Key::Name)->get()->owner() == B);
+
+	// events are delivered only for successful batch
+	N->insert("sync", kernel::tfactory::create_object("bs_person", "sync", 0.));
+	{
+		std::unique_lock<std::mutex> my_turn(guard);
+		BOOST_TEST_REQUIRE(delivered.wait_for(my_turn, std::chrono::seconds(5), [&] { return synced; }));
+		BOOST_TEST(n_events == 4);
+	}
+
+	// inserted node is adopted inside transaction and rollback restores it's handle & stats
+	sp_node C = kernel::tfactory::create_object("node");
+	C->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 23.));
+	N->insert("C", C);
+	const auto hC = C->handle();
+	BOOST_TEST(N->enable_stats());
+	const auto S = N->stats();
+	auto hC1 = std::make_shared<hard_link>("C1", C);
+	b.insert(B, hC1).erase(A, L1->id());
+	BOOST_TEST((b.commit().code == Error::KeyMismatch));
+	BOOST_TEST(C->handle() == hC);
+	BOOST_TEST(hC->owner() == N);
+	BOOST_TEST(N->find(hC->id()) != N->end());
+	BOOST_TEST(!hC1->owner());
+	BOOST_TEST(N->stats().links == S.links);
+	BOOST_TEST(N->stats().nodes == S.nodes);
+
+	b.insert(B, hC1);
+	BOOST_TEST(b.commit().ok());
+	BOOST_TEST(C->handle() == hC1);
+	BOOST_TEST(hC1->owner() == B);
+	BOOST_TEST(N->find(hC->id()) == N->end());
+	BOOST_TEST(N->stats().links == S.links);
+	BOOST_TEST(N->stats().nodes == S.nodes);
+
+	// node that is changed by batch can be inserted by it into node maintaining stats & generation
+	N->subtree_generation();
+	sp_node D = kernel::tfactory::create_object("node");
+	b.insert(D, "Citizen_4", kernel::tfactory::create_object("bs_person", "Citizen_4", 24.))
+		.insert(N, "D", D);
+	BOOST_TEST(b.commit().ok());
+	BOOST_TEST(N->stats().links == S.links + 2);
+	BOOST_TEST(N->stats().nodes == S.nodes + 1);
+	BOOST_TEST(D->enable_stats());
+	BOOST_TEST(N->subtree_generation() >= D->generation());
+	// ... including when batch is rolled back
+	const auto hD = D->handle();
+	b.insert(D, "Citizen_5", kernel::tfactory::create_object("bs_person", "Citizen_5", 25.))
+		.move(N, hD->id(), B)
+		.erase(A, L1->id());
+	BOOST_TEST((b.commit().code == Error::KeyMismatch));
+	BOOST_TEST(hD->owner() == N);
+	BOOST_TEST(N->stats().links == S.links + 2);
+	BOOST_TEST(N->stats().nodes == S.nodes + 1);
+	D->insert("Citizen_6", kernel::tfactory::create_object("bs_person", "Citizen_6", 26.));
+	BOOST_TEST(N->subtree_generation() == D->generation());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_remote) {
+	std::cout << "\n\n*** testing remote subtree mounting..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	N->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	A->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+	A->insert("Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.));
+
+	const auto port = publish(hN);
+	BOOST_TEST_REQUIRE(port.has_value());
+	auto R = std::make_shared<remote_link>("remote", "127.0.0.1", *port);
+	// nothing is known before first request
+	BOOST_TEST(R->oid() == boost::uuids::to_string(boost::uuids::nil_uuid()));
+
+	// listing
+	auto RN = R->data_node();
+	BOOST_TEST_REQUIRE(RN);
+	BOOST_TEST(RN->handle() == R);
+	BOOST_TEST(RN->size() == 2);
+	BOOST_TEST(R->oid() == N->id());
+	auto RA = RN->find("A", node::Key::Name);
+	BOOST_TEST_REQUIRE(RA != RN->end());
+	// children metadata is available without requests
+	BOOST_TEST((*RA)->type_id() == "remote_link");
+	BOOST_TEST((*RA)->oid() == A->id());
+	BOOST_TEST(std::static_pointer_cast<remote_link>(*RA)->is_node());
+	BOOST_TEST((*RA)->req_status(link::Req::DataNode) == link::ReqStatus::Void);
+
+	// data
+	auto RC0 = RN->find("Citizen_0", node::Key::Name);
+	BOOST_TEST_REQUIRE(RC0 != RN->end());
+	BOOST_TEST((*RC0)->obj_type_id() == "bs_person");
+	auto P = std::dynamic_pointer_cast<bs_person>((*RC0)->data());
+	BOOST_TEST_REQUIRE(P);
+	BOOST_TEST(P->name_ == "Citizen_0");
+	BOOST_TEST(((*RC0)->data_node_ex().error().code == Error::NotANode));
+
+	// populate whole subtree
+	BOOST_TEST(R->populate(2).ok());
+	BOOST_TEST((*RA)->req_status(link::Req::DataNode) == link::ReqStatus::OK);
+	BOOST_TEST((*RA)->data_node()->size() == 2);
+	BOOST_TEST(deref_path("A/Citizen_2", R, node::Key::Name)->oid() ==
+		deref_path("A/Citizen_2", hN, node::Key::Name)->oid()
+	);
+
+	// deref on server side
+	auto RC2 = R->deref_path("A/Citizen_2", node::Key::Name);
+	BOOST_TEST_REQUIRE(RC2.has_value());
+	BOOST_TEST(std::static_pointer_cast<bs_person>((*RC2)->data())->age_ == 22.);
+	// paths can't escape published subtree
+	BOOST_TEST(!R->deref_path("../r", node::Key::Name));
+	BOOST_TEST((R->deref_path("A/Absent", node::Key::Name).error().code == Error::KeyMismatch));
+
+	// changes are seen after refresh
+	A->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 23.));
+	BOOST_TEST((*RA)->data_node()->size() == 2);
+	std::static_pointer_cast<remote_link>(*RA)->refresh();
+	BOOST_TEST((*RA)->data_node()->size() == 3);
+
+	// saved link mounts same remote subtree after load
+	const auto RA1 = std::dynamic_pointer_cast<remote_link>(test_json(*RA));
+	BOOST_TEST_REQUIRE(RA1);
+	BOOST_TEST(RA1->host() == "127.0.0.1");
+	BOOST_TEST(RA1->port() == *port);
+	BOOST_TEST(RA1->remote_path() == std::static_pointer_cast<remote_link>(*RA)->remote_path());
+	BOOST_TEST(RA1->data_node()->size() == 3);
+
+	BOOST_TEST(unpublish(*port).ok());
+	BOOST_TEST(!unpublish(*port).ok());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_mutation_log) {
+	std::cout << "\n\n*** testing mutations log..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	const std::string base = "mutations_base.bst", log_file = "mutations.log";
+	std::remove(log_file.c_str());
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	BOOST_TEST(save_tree(hN, base, TreeArchive::Binary).ok());
+
+	// compare structure, names and persons of two trees
+	const auto same_trees = [](const sp_node& lhs, const sp_node& rhs) {
+		std::vector<std::string> l_items, r_items;
+		const auto dump = [](const sp_node& N, std::vector<std::string>& res) {
+			walk(N->handle(), [&](const sp_link&, std::list<sp_link>&, std::vector<sp_link>& objs) {
+				for(const auto& L : objs) {
+					auto P = std::static_pointer_cast<bs_person>(L->data());
+					res.push_back(abspath(L, node::Key::Name) + ' ' + P->name_ + std::to_string(P->age_));
+				}
+			});
+		};
+		dump(lhs, l_items);
+		dump(rhs, r_items);
+		return !l_items.empty() && l_items == r_items;
+	};
+
+	auto replica = load_tree(base, TreeArchive::Binary);
+	BOOST_TEST_REQUIRE(replica.has_value());
+	auto F = log_follower(log_file, *replica);
+	{
+		auto mlog = mutation_log(hN, log_file);
+		// every mutation is written before call returns
+		sp_node B = kernel::tfactory::create_object("node");
+		B->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+		N->insert("B", B);
+		BOOST_TEST(mlog.last_seq() == 1);
+		A->insert("Citizen_2", kernel::tfactory::create_object("bs_person", "Citizen_2", 22.));
+		BOOST_TEST(mlog.last_seq() == 2);
+		A->rename(A->find("Citizen_0", node::Key::Name)->get()->id(), "Citizen_42");
+		BOOST_TEST(mlog.last_seq() == 3);
+		const auto L2 = *A->find("Citizen_2", node::Key::Name);
+		A->move(L2->id(), B);
+		BOOST_TEST(mlog.last_seq() == 4);
+		// insert is replayed before move, so moved link isn't lost
+		{
+			auto restored = load_tree(base, TreeArchive::Binary);
+			BOOST_TEST_REQUIRE(restored.has_value());
+			BOOST_TEST(mutation_log::replay(log_file, *restored).value_or(0) == 4);
+			BOOST_TEST(same_trees(N, (*restored)->data_node()));
+		}
+		std::static_pointer_cast<bs_person>(L2->data())->age_ = 33.;
+		L2->notify_data_changed();
+		BOOST_TEST(mlog.last_seq() == 5);
+		B->erase("Citizen_1", node::Key::Name);
+		BOOST_TEST(mlog.last_seq() == 6);
+		N->sort([](const link& lhs, const link& rhs) { return lhs.name() > rhs.name(); }, false);
+		BOOST_TEST(mlog.last_seq() == 7);
+		// batch events are delivered after all steps are done, every record keeps
+		// paths & names captured at it's own step
+		auto L5 = std::make_shared<hard_link>(
+			"Citizen_5", kernel::tfactory::create_object("bs_person", "Citizen_5", 25.)
+		);
+		BOOST_TEST(batch{}
+			.insert(B, L5)
+			.rename(B, L5->id(), "Citizen_55")
+			.rename(B, L5->id(), "Citizen_555")
+			.move(N, B->handle()->id(), A)
+			.commit().ok()
+		);
+		BOOST_TEST(mlog.last_seq() == 11);
+		const auto n_records = mlog.last_seq();
+		mlog.flush();
+		BOOST_TEST(mlog.last_seq() == n_records);
+
+		// follower catches up
+		auto n_applied = F.poll();
+		BOOST_TEST_REQUIRE(n_applied.has_value());
+		BOOST_TEST(*n_applied == n_records);
+		BOOST_TEST(F.last_seq() == n_records);
+		BOOST_TEST(same_trees(N, (*replica)->data_node()));
+		BOOST_TEST(*F.poll() == 0);
+
+		// replay on top of base snapshot gives same tree
+		auto restored = load_tree(base, TreeArchive::Binary);
+		BOOST_TEST_REQUIRE(restored.has_value());
+		BOOST_TEST(mutation_log::replay(log_file, *restored).value_or(0) == n_records);
+		BOOST_TEST(same_trees(N, (*restored)->data_node()));
+
+		// compaction folds log into snapshot
+		BOOST_TEST(mlog.compact(base).ok());
+		auto compacted = load_tree(base, TreeArchive::Binary);
+		BOOST_TEST_REQUIRE(compacted.has_value());
+		BOOST_TEST(same_trees(N, (*compacted)->data_node()));
+		BOOST_TEST(mutation_log::replay(log_file, *compacted).value_or(0) == n_records);
+
+		// logging continues after compaction
+		B->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 23.));
+		BOOST_TEST(mlog.last_seq() == n_records + 1);
+	}
+	BOOST_TEST(*F.poll() == 1);
+	BOOST_TEST(same_trees(N, (*replica)->data_node()));
+	// follower that missed compacted records can't continue
+	BOOST_TEST(!log_follower(log_file, *replica, 1).poll());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_events) {
+	std::cout << "\n\n*** testing node events..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+	using namespace std::chrono_literals;
+
+	// collect events delivered asynchronously
+	std::mutex guard;
+	std::condition_variable delivered;
+	std::vector<event> events;
+	std::size_t n_synced = 0;
+	const auto is_sync = [](const event& e) { return e.link && e.link->name() == "sync"; };
+	const auto collect = [&](std::vector<event> batch) {
+		std::lock_guard<std::mutex> my_turn(guard);
+		for(auto& e : batch) {
+			// sync marks aren't collected
+			if(!is_sync(e))
+				events.push_back(std::move(e));
+			else if(e.kind == Event::LinkErased)
+				++n_synced;
+		}
+		delivered.notify_all();
+	};
+	// batches are delivered in order, so all preceding events are received
+	// when every subscriber gets erase event of sync link inserted into `where`
+	const auto wait_events = [&](const sp_node& where, std::size_t n_subscribers = 1) {
+		where->insert("sync", kernel::tfactory::create_object("bs_person", "sync", 0.));
+		where->erase("sync", node::Key::Name);
+		std::unique_lock<std::mutex> my_turn(guard);
+		BOOST_TEST_REQUIRE(delivered.wait_for(my_turn, 5s, [&] { return n_synced >= n_subscribers; }));
+		n_synced = 0;
+		return std::exchange(events, {});
+	};
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	const auto sid = N->subscribe(collect);
+
+	// events from subtree are delivered with origin
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+	auto E = wait_events(A);
+	BOOST_TEST_REQUIRE(E.size() == 1);
+	BOOST_TEST(E[0].kind == Event::LinkInserted);
+	BOOST_TEST(E[0].link->name() == "Citizen_0");
+	BOOST_TEST(E[0].origin == A->handle());
+
+	// repeating renames are merged
+	auto L = *A->begin();
+	L->rename("Citizen_1");
+	L->rename("Citizen_2");
+	L->rename("Citizen_3");
+	E = wait_events(A);
+	BOOST_TEST_REQUIRE(!E.empty());
+	BOOST_TEST(E.size() <= 3);
+	BOOST_TEST(E.front().kind == Event::LinkRenamed);
+	BOOST_TEST(E.front().old_name == "Citizen_0");
+
+	// move is reported once
+	A->move(L->id(), N);
+	E = wait_events(A);
+	BOOST_TEST_REQUIRE(E.size() == 1);
+	BOOST_TEST(E[0].kind == Event::LinkMoved);
+	BOOST_TEST(E[0].origin == hN);
+	BOOST_TEST(E[0].source == A->handle());
+
+	// filtered shallow subscription
+	const auto sid_A = A->subscribe(collect, Event::LinkErased, false);
+	N->erase(L->id());
+	A->insert("Citizen_4", kernel::tfactory::create_object("bs_person", "Citizen_4", 24.));
+	A->erase("Citizen_4", node::Key::Name);
+	E = wait_events(A, 2);
+	BOOST_TEST(E.size() == 4);
+	BOOST_TEST(A->unsubscribe(sid_A));
+
+	// slow subscriber receives overflow notification
+	BOOST_TEST(N->unsubscribe(sid));
+	BOOST_TEST(!N->unsubscribe(sid));
+	std::atomic<bool> go = false;
+	std::promise<void> blocked;
+	N->subscribe([&, first = true](std::vector<event> batch) mutable {
+		if(std::exchange(first, false)) {
+			blocked.set_value();
+			while(!go) std::this_thread::yield();
+		}
+		collect(std::move(batch));
+	}, Event::LinkInserted, true, 10);
+	// first event is taken by blocked subscriber
+	N->insert("Citizen_5", kernel::tfactory::create_object("bs_person", "Citizen_5", 25.));
+	BOOST_TEST_REQUIRE((blocked.get_future().wait_for(5s) == std::future_status::ready));
+	for(int i = 0; i < 20; ++i)
+		A->insert("Citizen_" + std::to_string(i + 6), kernel::tfactory::create_object("bs_person", "", 0.));
+	go = true;
+	// overflow notification ends last batch
+	std::unique_lock<std::mutex> my_turn(guard);
+	BOOST_TEST_REQUIRE(delivered.wait_for(my_turn, 5s, [&] {
+		return !events.empty() && events.back().kind == Event::Overflow;
+	}));
+	BOOST_TEST(events.size() == 12);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_query) {
+	std::cout << "\n\n*** testing tree query..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// root with 3 nodes, each containing 10 persons
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	for(int i = 0; i < 3; ++i) {
+		sp_node sub = kernel::tfactory::create_object("node");
+		for(int j = 0; j < 10; ++j) {
+			std::string p_name = "Citizen_" + std::to_string(i * 10 + j);
+			sub->insert(p_name, kernel::tfactory::create_object("bs_person", p_name, double(j)));
+		}
+		N->insert("sub_" + std::to_string(i), sub);
+	}
+	N->insert(std::make_shared<sym_link>("sym", "/sub_0"));
+
+	for(bool parallel : {false, true}) {
+		BOOST_TEST(query(N).parallel(parallel).type("bs_person").count() == 30);
+		BOOST_TEST(query(hN).parallel(parallel).name_glob("Citizen_1?").count() == 10);
+		BOOST_TEST(query(N).parallel(parallel).name("Citizen_25").collect().size() == 1);
+		// sym link to node matches too, but isn't followed
+		BOOST_TEST(query(N).parallel(parallel).type("node").count() == 4);
+		BOOST_TEST(query(N).parallel(parallel).type("bs_person").limit(7).count() == 7);
+		BOOST_TEST(query(N).parallel(parallel).type("bs_person").max_depth(0).count() == 0);
+		BOOST_TEST(query(N).parallel(parallel).name_glob("Citizen_2*").where([](const sp_link& L) {
+			return std::static_pointer_cast<bs_person>(L->data())->age_ < 5;
+		}).count() == 6);
+	}
+	// results are streamed in tree order
+	std::vector<std::string> names;
+	query(N).name_glob("Citizen_*").for_each([&](const sp_link& L) {
+		names.push_back(L->name());
+		return names.size() < 3;
+	});
+	BOOST_TEST(names == std::vector<std::string>({"Citizen_0", "Citizen_1", "Citizen_2"}));
+	BOOST_TEST(query(N).oid(N->find("sub_1", node::Key::Name)->get()->oid()).first());
+
+	// batch path resolving
+	const auto paths = std::vector<std::string>{
+		"/sub_1/Citizen_12", "sub_1/Citizen_15", "/sub_1/Absent", "sub_0/../sub_2/Citizen_20", "",
+		"sym/Citizen_3", "/sub_1/Citizen_12"
+	};
+	for(bool parallel : {false, true}) {
+		const auto res = deref_paths(paths, hN, node::Key::Name, true, parallel);
+		BOOST_TEST_REQUIRE(res.size() == paths.size());
+		for(std::size_t i = 0; i < paths.size(); ++i)
+			BOOST_TEST(res[i] == deref_path(paths[i], hN, node::Key::Name));
+		BOOST_TEST(res[0]->name() == "Citizen_12");
+		BOOST_TEST(!res[2]);
+		BOOST_TEST(res[5]->name() == "Citizen_3");
+	}
+
+	// glob path resolving
+	for(bool parallel : {false, true}) {
+		BOOST_TEST(deref_glob("sub_*/Citizen_1?", hN, true, parallel).size() == 10);
+		// sym link is followed here
+		BOOST_TEST(deref_glob("*/Citizen_?", hN, true, parallel).size() == 20);
+		BOOST_TEST(deref_glob("/sub_?/../sub_2/Citizen_2*", hN, true, parallel).size() == 30);
+		BOOST_TEST(deref_glob("/sub_1/Citizen_15", hN, true, parallel).size() == 1);
+		BOOST_TEST(deref_glob("sub_*/Absent*", hN, true, parallel).empty());
+		BOOST_TEST(deref_glob("*/*", hN, [](const sp_link&) { return false; }, true, parallel) == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_cancel) {
+	std::cout << "\n\n*** testing cancellable requests..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	using namespace std::chrono_literals;
+	const auto wait_data = [](auto&& request) {
+		auto res = std::make_shared<std::promise<result_or_err<sp_obj>>>();
+		auto F = res->get_future();
+		request([res](result_or_err<sp_obj> obj, sp_clink) { res->set_value(std::move(obj)); });
+		BOOST_TEST_REQUIRE((F.wait_for(5s) == std::future_status::ready));
+		return F.get();
+	};
+
+	// cancelled or expired request isn't executed
+	auto L = std::make_shared<fusion_link>(
+		"stalled", std::make_shared<node>(), std::make_shared<stalled_client>()
+	);
+	auto T = cancel_token();
+	T.cancel();
+	for(const auto& token : {T, cancel_token(0ms)}) {
+		auto res = wait_data([&](auto&& f) { L->data(std::move(f), token); });
+		BOOST_TEST_REQUIRE(!res);
+		BOOST_TEST((res.error().code == Error::RequestCancelled));
+		BOOST_TEST(L->req_status(link::Req::Data) == link::ReqStatus::Void);
+	}
+
+	// bridge polls token of executing request, status is rolled back after cancellation
+	L->rs_reset(link::Req::DataNode, link::ReqStatus::Error);
+	const auto res = wait_data([&](auto&& f) { L->populate(std::move(f), "", cancel_token(50ms)); });
+	BOOST_TEST_REQUIRE(!res);
+	BOOST_TEST((res.error().code == Error::RequestCancelled));
+	BOOST_TEST(L->req_status(link::Req::DataNode) == link::ReqStatus::Error);
+
+	// request waiting for busy link wakes up when it's token is cancelled
+	{
+		auto T_busy = cancel_token(), T_wait = cancel_token();
+		auto busy_done = std::make_shared<std::promise<result_or_err<sp_obj>>>();
+		auto F_busy = busy_done->get_future();
+		L->populate(
+			[busy_done](result_or_err<sp_obj> obj, sp_clink) { busy_done->set_value(std::move(obj)); },
+			"", T_busy
+		);
+		const auto until = std::chrono::steady_clock::now() + 5s;
+		while(
+			L->req_status(link::Req::DataNode) != link::ReqStatus::Busy &&
+			std::chrono::steady_clock::now() < until
+		)
+			std::this_thread::yield();
+		BOOST_TEST_REQUIRE(L->req_status(link::Req::DataNode) == link::ReqStatus::Busy);
+
+		auto F_wait = std::async(std::launch::async, [&] {
+			const auto scope = cancel_token::scope(T_wait);
+			return L->populate("", true);
+		});
+		T_wait.cancel();
+		BOOST_TEST_REQUIRE((F_wait.wait_for(5s) == std::future_status::ready));
+		const auto res_wait = F_wait.get();
+		BOOST_TEST_REQUIRE(!res_wait);
+		BOOST_TEST((res_wait.error().code == Error::RequestCancelled));
+		BOOST_TEST(L->req_status(link::Req::DataNode) == link::ReqStatus::Busy);
+
+		T_busy.cancel();
+		BOOST_TEST_REQUIRE((F_busy.wait_for(5s) == std::future_status::ready));
+		BOOST_TEST((F_busy.get().error().code == Error::RequestCancelled));
+	}
+
+	// request that isn't cancelled is executed as usual
+	auto H = std::make_shared<hard_link>(
+		"person", kernel::tfactory::create_object("bs_person", std::string("Tyler"), 33.)
+	);
+	const auto res_ok = wait_data([&](auto&& f) { H->data(std::move(f), cancel_token(5s)); });
+	BOOST_TEST_REQUIRE(res_ok.has_value());
+	BOOST_TEST(*res_ok == H->data());
+
+	// cancelled deref returns nullptr
+	auto N = std::make_shared<node>();
+	N->insert(H);
+	auto hN = std::make_shared<hard_link>("root", N);
+	for(bool cancel : {false, true}) {
+		auto found = std::make_shared<std::promise<sp_link>>();
+		auto F = found->get_future();
+		auto token = cancel_token();
+		if(cancel) token.cancel();
+		deref_path(
+			[found](const sp_link& lnk) { found->set_value(lnk); }, token, "person", hN, node::Key::Name
+		);
+		BOOST_TEST_REQUIRE((F.wait_for(5s) == std::future_status::ready));
+		BOOST_TEST(F.get() == (cancel ? nullptr : sp_link(H)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_queue) {
+	std::cout << "\n\n*** testing bounded requests queue..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	using namespace std::chrono_literals;
+	// global limits are restored even if test fails
+	struct limits_guard {
+		link::queue_limits prev = link::get_queue_limits();
+		~limits_guard() { link::set_queue_limits(prev); }
+	} restore_limits;
+
+	std::mutex guard;
+	std::condition_variable got_code;
+	std::vector<std::error_code> codes;
+	const auto collect = [&](result_or_err<sp_obj> res, sp_clink) {
+		std::lock_guard<std::mutex> my_turn(guard);
+		codes.push_back(res ? std::error_code{} : res.error().code);
+		got_code.notify_all();
+	};
+	const auto n_codes = [&] {
+		std::lock_guard<std::mutex> my_turn(guard);
+		return codes.size();
+	};
+	const auto wait_codes = [&](std::size_t n) {
+		std::unique_lock<std::mutex> my_turn(guard);
+		return got_code.wait_for(my_turn, 5s, [&] { return codes.size() >= n; }) && codes.size() == n;
+	};
+
+	// actor of link is stalled by first request, second one waits in queue
+	auto client = std::make_shared<stalled_client>();
+	auto L = std::make_shared<fusion_link>("stalled", std::make_shared<node>(), client);
+	auto T = cancel_token();
+	link::set_queue_limits({1, 0, link::Overflow::Reject});
+	L->data(collect, T);
+	BOOST_TEST_REQUIRE(client->wait_started(1));
+	L->data(collect, T);
+	BOOST_TEST(L->queue_depth() == 1);
+	BOOST_TEST(link::total_queue_depth() >= 1);
+
+	// overflowed request is rejected immediately
+	L->data_node(collect);
+	BOOST_TEST_REQUIRE(n_codes() == 1);
+	BOOST_TEST((codes[0] == Error::QueueOverflow));
+
+	// duplicate request is joined to queued one, other kinds are rejected
+	link::set_queue_limits({1, 0, link::Overflow::Coalesce});
+	auto T_joined = cancel_token();
+	L->data(collect, T_joined);
+	L->data_node(collect);
+	BOOST_TEST(L->queue_depth() == 1);
+	BOOST_TEST_REQUIRE(n_codes() == 2);
+	BOOST_TEST((codes[1] == Error::QueueOverflow));
+
+	// blocked sender waits until queue has room
+	link::set_queue_limits({1, 0, link::Overflow::Block});
+	std::atomic<bool> sent = false;
+	auto sender = std::thread([&] {
+		L->data(collect, T);
+		sent = true;
+	});
+	const auto until = std::chrono::steady_clock::now() + 5s;
+	while(link::blocked_senders() == 0 && std::chrono::steady_clock::now() < until)
+		std::this_thread::yield();
+	BOOST_TEST_REQUIRE(link::blocked_senders() == 1);
+	BOOST_TEST(!sent);
+	// sender gives up when deadline of it's token expires
+	L->data(collect, cancel_token(50ms));
+	BOOST_TEST_REQUIRE(n_codes() == 3);
+	BOOST_TEST((codes[2] == Error::RequestCancelled));
+	BOOST_TEST(link::blocked_senders() == 1);
+
+	// unstall actor: requests made with `T` are cancelled (blocked sender gives up at once),
+	// but joined request has own token, so it's executed again and stalls actor until
+	// it's token is cancelled
+	T.cancel();
+	sender.join();
+	BOOST_TEST(sent);
+	BOOST_TEST_REQUIRE(client->wait_started(2));
+	BOOST_TEST(n_codes() == 5);
+	T_joined.cancel();
+	BOOST_TEST_REQUIRE(wait_codes(7));
+	for(std::size_t i = 2; i < codes.size(); ++i)
+		BOOST_TEST((codes[i] == Error::RequestCancelled));
+	BOOST_TEST(L->queue_depth() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_sweeper) {
+	std::cout << "\n\n*** testing weak links sweeper..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	using namespace std::chrono_literals;
+	// subtree with weak links to temp objects
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto N = root_lnk->data_node();
+	auto sub = std::make_shared<node>();
+	N->insert("sub", sub);
+	std::vector<sp_obj> objs;
+	const auto add_weak = [&](const sp_node& dst, std::size_t n) {
+		for(std::size_t i = 0; i < n; ++i) {
+			objs.push_back(kernel::tfactory::create_object("bs_person", "Temp_" + std::to_string(i), 1.));
+			dst->insert(std::make_shared<weak_link>("weak_" + std::to_string(i), objs.back()));
+		}
+	};
+	add_weak(N, 10);
+	add_weak(sub, 10);
+	// kill half of objects
+	for(std::size_t i = 0; i < objs.size(); i += 2)
+		objs[i].reset();
+
+	// full scan erases dead links by batches
+	auto pol = sweep_policy{};
+	pol.period = 0ms;
+	pol.batch_size = 4;
+	auto S = weak_sweeper(root_lnk, pol);
+	auto res = S.sweep();
+	BOOST_TEST(res.scans == 1);
+	BOOST_TEST(res.erased == 10);
+	BOOST_TEST(res.batches == 3);
+	BOOST_TEST(N->size() == 6);
+	BOOST_TEST(sub->size() == 5);
+
+	// tombstones are erased by compaction
+	pol.action = SweepAction::Tombstone;
+	S.set_policy(pol);
+	objs[1].reset();
+	res = S.sweep();
+	BOOST_TEST(res.tombstoned == 1);
+	BOOST_TEST(N->size() == 6);
+	BOOST_TEST((N->find("weak_1", node::Key::Name)->get()->flags() & link::Tombstone));
+	res = S.compact();
+	BOOST_TEST(res.erased == 1);
+	BOOST_TEST(N->find("weak_1", node::Key::Name) == N->end());
+
+	// expired link found by `data()` call is swept in background
+	pol.action = SweepAction::Erase;
+	pol.batch_size = 1;
+	S.set_policy(pol);
+	objs[3].reset();
+	const auto dead = N->find("weak_3", node::Key::Name)->get();
+	BOOST_TEST(!dead->data());
+	for(int i = 0; i < 100 && N->size() == 5; ++i)
+		std::this_thread::sleep_for(10ms);
+	BOOST_TEST(N->size() == 4);
+	BOOST_TEST(S.stats().sweeps >= 1);
+	BOOST_TEST(S.stats().erased == 12);
+
+	// one-shot sweep without background thread
+	pol.on_expiry = false;
+	S.set_policy(pol);
+	objs.clear();
+	BOOST_TEST(weak_sweeper::sweep(root_lnk).erased == 8);
+	BOOST_TEST(N->size() == 1);
+	BOOST_TEST(sub->empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_generation) {
+	std::cout << "\n\n*** testing generation counters..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	A->insert("Citizen_0", kernel::tfactory::create_object("bs_person", "Citizen_0", 20.));
+
+	// every change of node bumps it's generation above any earlier one
+	const auto g0 = node::current_generation();
+	BOOST_TEST(A->generation() <= g0);
+	A->insert("Citizen_1", kernel::tfactory::create_object("bs_person", "Citizen_1", 21.));
+	const auto g1 = A->generation();
+	BOOST_TEST(g1 > g0);
+	A->find("Citizen_1", node::Key::Name)->get()->rename("Citizen_2");
+	BOOST_TEST(A->generation() > g1);
+
+	// subtree generation reflects changes in nested nodes
+	const auto s0 = N->subtree_generation();
+	const auto n0 = N->generation();
+	BOOST_TEST(s0 == A->generation());
+	A->erase("Citizen_2", node::Key::Name);
+	BOOST_TEST(N->generation() == n0);
+	BOOST_TEST(N->subtree_generation() > s0);
+
+	// ... including later inserted ones
+	sp_node B = kernel::tfactory::create_object("node");
+	A->insert("B", B);
+	const auto s1 = N->subtree_generation();
+	B->insert("Citizen_3", kernel::tfactory::create_object("bs_person", "Citizen_3", 23.));
+	BOOST_TEST(N->subtree_generation() > s1);
+	BOOST_TEST(A->subtree_generation() == B->generation());
+
+	// move changes both nodes, data change notification bumps owner
+	const auto s2 = N->subtree_generation();
+	A->move(B->handle()->id(), N);
+	BOOST_TEST(A->generation() > s2);
+	BOOST_TEST(N->generation() > A->generation());
+	const auto b0 = B->generation();
+	B->find("Citizen_3", node::Key::Name)->get()->notify_data_changed();
+	BOOST_TEST(B->generation() > b0);
+	BOOST_TEST(N->subtree_generation() == B->generation());
+
+	// nothing happens -- nothing changes
+	const auto s3 = N->subtree_generation();
+	N->find("A", node::Key::Name);
+	BOOST_TEST(N->subtree_generation() == s3);
+
+	// tracking is turned on in deep chain without recursion
+	constexpr std::size_t depth = 100000;
+	sp_node C = kernel::tfactory::create_object("node");
+	auto tail = C;
+	for(std::size_t i = 0; i < depth; ++i) {
+		auto next = std::make_shared<node>();
+		tail->insert("level", next);
+		tail = std::move(next);
+	}
+	BOOST_TEST(C->subtree_generation() == tail->handle()->owner()->generation());
+	tail->insert("Citizen_4", kernel::tfactory::create_object("bs_person", "Citizen_4", 24.));
+	BOOST_TEST(C->subtree_generation() == tail->generation());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_sort) {
+	std::cout << "\n\n*** testing custom order sorting..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	for(auto i : {10, 2, 1, 20, 3})
+		N->insert("item_" + std::to_string(i), kernel::tfactory::create_object("bs_person", "p", double(i)));
+	const auto names = [&] {
+		std::vector<std::string> res;
+		for(const auto& L : *N) res.push_back(L->name());
+		return res;
+	};
+
+	// one-time lexical sort by user-defined key
+	N->sort(node::key_order([](const link& L) { return L.name(); }), false);
+	BOOST_TEST(!N->is_sorted());
+	auto expected = std::vector<std::string>{"item_1", "item_10", "item_2", "item_20", "item_3"};
+	BOOST_TEST(names() == expected, boost::test_tools::per_element());
+
+	// persistent natural order is maintained on insert, rename & move
+	N->sort(node::natural_order());
+	BOOST_TEST(N->is_sorted());
+	expected = {"item_1", "item_2", "item_3", "item_10", "item_20"};
+	BOOST_TEST(names() == expected, boost::test_tools::per_element());
+
+	N->insert(std::make_shared<hard_link>("item_5", kernel::tfactory::create_object("bs_person", "p", 5.)), 0);
+	N->rename("item_20", "item_4", node::Key::Name);
+	sp_node A = kernel::tfactory::create_object("node");
+	auto lA = A->insert("item_11", kernel::tfactory::create_object("bs_person", "p", 11.)).first;
+	A->move((*lA)->id(), N, 0);
+	expected = {"item_1", "item_2", "item_3", "item_4", "item_5", "item_10", "item_11"};
+	BOOST_TEST(names() == expected, boost::test_tools::per_element());
+
+	// link replaced in batch is also placed by comparator
+	const auto l3 = *N->find("item_3", node::Key::Name);
+	BOOST_TEST(
+		batch{}.insert(N, std::make_shared<hard_link>("item_6", l3->data()), InsertPolicy::ReplaceDupOID)
+		.commit().ok()
+	);
+	expected = {"item_1", "item_2", "item_4", "item_5", "item_6", "item_10", "item_11"};
+	BOOST_TEST(names() == expected, boost::test_tools::per_element());
+
+	// sort is reported to subscribers by single event without link
+	using namespace std::chrono_literals;
+	std::mutex guard;
+	std::condition_variable delivered;
+	bool reordered = false;
+	const auto sid = N->subscribe([&](std::vector<event> batch) {
+		std::lock_guard<std::mutex> my_turn(guard);
+		for(const auto& e : batch)
+			if(e.kind == Event::Reordered && !e.link && e.origin == hN) reordered = true;
+		delivered.notify_all();
+	}, Event::Reordered);
+	N->sort(node::natural_order());
+	{
+		std::unique_lock<std::mutex> my_turn(guard);
+		BOOST_TEST(delivered.wait_for(my_turn, 5s, [&] { return reordered; }));
+	}
+	N->unsubscribe(sid);
+
+	// turned off order leaves links in place
+	N->sort(nullptr);
+	BOOST_TEST(!N->is_sorted());
+	N->insert("item_0", kernel::tfactory::create_object("bs_person", "p", 0.));
+	BOOST_TEST((*N->find(N->size() - 1))->name() == "item_0");
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_traverse) {
+	std::cout << "\n\n*** testing iterative traversal..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// r -> {A -> {C, p1}, B, p0} + sym link from C back to A
+	auto hN = make_root_link("hard_link", "r");
+	auto N = hN->data_node();
+	sp_node A = kernel::tfactory::create_object("node");
+	sp_node B = kernel::tfactory::create_object("node");
+	sp_node C = kernel::tfactory::create_object("node");
+	N->insert("A", A);
+	N->insert("B", B);
+	N->insert("p0", kernel::tfactory::create_object("bs_person", "p0", 1.));
+	A->insert("C", C);
+	A->insert("p1", kernel::tfactory::create_object("bs_person", "p1", 2.));
+	C->insert(std::make_shared<sym_link>("up", "/A"));
+
+	const auto visit_order = [&](TraverseOrder order, bool follow_symlinks = false) {
+		auto opts = traverse_opts{};
+		opts.order = order;
+		opts.follow_symlinks = follow_symlinks;
+		std::string res;
+		traverse(hN, [&](traverse_frame& F) {
+			res += F.link->name() + std::to_string(F.depth) + ' ';
+			return TraverseStep::Continue;
+		}, opts);
+		return res;
+	};
+	BOOST_TEST(visit_order(TraverseOrder::PreOrder) == "r0 A1 C2 B1 ");
+	BOOST_TEST(visit_order(TraverseOrder::PostOrder) == "C2 A1 B1 r0 ");
+	BOOST_TEST(visit_order(TraverseOrder::BFS) == "r0 A1 B1 C2 ");
+	// sym link cycle is entered only once
+	BOOST_TEST(visit_order(TraverseOrder::PreOrder, true) == "r0 A1 C2 up3 C4 B1 ");
+
+	// skip subtree & stop
+	std::size_t n_visited = 0;
+	BOOST_TEST(traverse(N, [&](traverse_frame& F) {
+		++n_visited;
+		return F.link->name() == "A" ? TraverseStep::Skip : TraverseStep::Continue;
+	}));
+	BOOST_TEST(n_visited == 3);
+	BOOST_TEST(!traverse(N, [](traverse_frame& F) {
+		return F.depth ? TraverseStep::Stop : TraverseStep::Continue;
+	}));
+
+	// deep chain doesn't overflow stack in walk, deep search & copy
+	constexpr std::size_t depth = 100000;
+	auto tail = C;
+	for(std::size_t i = 0; i < depth; ++i) {
+		auto next = std::make_shared<node>();
+		tail->insert("level", next);
+		tail = std::move(next);
+	}
+	tail->insert("bottom", kernel::tfactory::create_object("bs_person", "bottom", 3.));
+
+	std::size_t n_walked = 0;
+	walk(hN, [&](const sp_link&, std::list<sp_link>&, std::vector<sp_link>&) { ++n_walked; }, true, false);
+	BOOST_TEST(n_walked == depth + 4);
+	BOOST_TEST(N->deep_search("bottom", node::Key::Name));
+	auto A_copy = std::make_shared<node>(*A);
+	BOOST_TEST(A_copy->size() == 2);
+
+	tail = nullptr;
+	auto opts = traverse_opts{};
+	opts.follow_symlinks = false;
+	traverse(A_copy, [&](traverse_frame& F) {
+		if(F.depth == depth + 1) tail = F.node;
+		return TraverseStep::Continue;
+	}, opts);
+	BOOST_TEST((tail && tail->size() == 1));
+
+	// deep chains are released without recursion on scope exit
+	tail.reset();
+}
@@ -0,0 +1,587 @@
+/// @file
+/// @author uentity
+/// @date 19.10.2026
+/// @brief Performance measurements of BS tree operations
+/// @copyright
+/// This Source Code Form is subject to the terms of the Mozilla Public License,
+/// v. 2.0. If a copy of the MPL was not distributed with this file,
+/// You can obtain one at https://mozilla.org/MPL/2.0/
+
+#define BOOST_TEST_DYN_LINK
+
+#include "test_objects.h"
+#include <bs/kernel/types_factory.h>
+#include <bs/tree/tree.h>
+
+#include <boost/test/unit_test.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <list>
+#include <thread>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define BS_TEST_HAVE_MALLINFO
+#endif
+
+using namespace blue_sky;
+using namespace blue_sky::tree;
+
+namespace {
+
+// bytes currently allocated from heap or 0 if not supported
+auto heap_used() -> std::size_t {
+#ifdef BS_TEST_HAVE_MALLINFO
+	return mallinfo2().uordblks;
+#else
+	return 0;
+#endif
+}
+
+// run `f` and return elapsed time in seconds
+template<typename F>
+auto timeit(F&& f) -> double {
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// make links to `n` persons named with `prefix` + index
+auto make_persons(std::size_t n, const std::string& prefix = "Citizen_") {
+	std::vector<sp_link> res;
+	res.reserve(n);
+	for(std::size_t i = 0; i < n; ++i) {
+		auto p_name = prefix + std::to_string(i);
+		res.push_back(std::make_shared<hard_link>(
+			p_name, kernel::tfactory::create_object("bs_person", p_name, double(i))
+		));
+	}
+	return res;
+}
+
+// bridge that loads data slowly
+struct slow_bridge : fusion_iface {
+	std::chrono::milliseconds delay;
+	std::atomic<std::size_t> n_pulls{0};
+
+	explicit slow_bridge(std::chrono::milliseconds delay_) : delay(delay_) {}
+
+	auto populate(const sp_node&, const std::string&) -> error override {
+		return perfect;
+	}
+
+	auto pull_data(const sp_obj&) -> error override {
+		++n_pulls;
+		std::this_thread::sleep_for(delay);
+		return perfect;
+	}
+};
+
+} // eof hidden namespace
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_indexes) {
+	std::cout << "\n\n*** measuring node insert performance for different indexes..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// [NOTE] element of links container holds headers of all indexes regardless of active set,
+	// so bytes per link are the same for every set and switched off index saves insert time only
+	constexpr std::size_t n_links = 100000;
+	using Indexes = node::Indexes;
+	for(auto idx : {Indexes::All, Indexes::Name, Indexes::None}) {
+		auto links = make_persons(n_links);
+		const auto mem_start = heap_used();
+		auto N = std::make_shared<node>("", idx);
+		const auto t = timeit([&] {
+			for(auto& L : links) N->insert(std::move(L));
+		});
+		const auto mem_used = heap_used() - mem_start;
+		// first range query builds switched off index
+		const auto t_build = timeit([&] { N->equal_type("bs_person"); });
+		std::cout << fmt::format(
+			"indexes = {}: {:.0f} inserts/sec, {} bytes/link, type index ready in {:.3f} s",
+			enumval(idx), n_links / t, mem_used / n_links, t_build
+		) << std::endl;
+
+		BOOST_TEST(N->find("Citizen_42", node::Key::Name) != N->end());
+		BOOST_TEST(N->indexes() == (idx | Indexes::Type));
+		const auto types = N->equal_type("bs_person");
+		BOOST_TEST(std::size_t(std::distance(types.first, types.second)) == n_links);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_interned_names) {
+	std::cout << "\n\n*** measuring memory & lookup with interned link names..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// long names (that don't fit into small string buffer) from small vocabulary
+	constexpr std::size_t n_links = 100000, n_names = 100;
+	const auto vocab_name = [](std::size_t i) {
+		return "simulation_grid_property_" + std::to_string(i % n_names);
+	};
+	const auto obj = kernel::tfactory::create_object("bs_person", "Citizen", 42.);
+
+	std::array<sp_node, 2> nodes;
+	for(bool intern : {false, true}) {
+		link::intern_names(intern);
+		const auto mem_start = heap_used();
+		auto N = std::make_shared<node>();
+		for(std::size_t i = 0; i < n_links; ++i)
+			N->insert(std::make_shared<hard_link>(vocab_name(i), obj));
+		const auto mem_used = heap_used() - mem_start;
+
+		std::size_t n_found = 0;
+		const auto t_find = timeit([&] {
+			for(std::size_t i = 0; i < n_names; ++i)
+				n_found += N->equal_range(vocab_name(i)).first != N->end<node::Key::Name>();
+		});
+		std::cout << fmt::format(
+			"interning = {}: {} bytes/link, name lookup {:.6f} s", intern, mem_used / n_links, t_find
+		) << std::endl;
+		BOOST_TEST(n_found == n_names);
+		nodes[intern] = std::move(N);
+	}
+	link::intern_names(false);
+
+	// interned names share string instance
+	auto N = nodes[1];
+	const auto r = N->equal_range(vocab_name(0));
+	BOOST_TEST(std::distance(r.first, r.second) == n_links / n_names);
+	BOOST_TEST(&(*r.first)->name_ref() == &(*std::next(r.first))->name_ref());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_summary) {
+	std::cout << "\n\n*** measuring deep search with subtree summaries..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// build tree with `n_nodes` nodes per level
+	constexpr std::size_t n_levels = 3, n_nodes = 10, n_leafs = 20, n_queries = 200;
+	const auto root = std::make_shared<node>();
+	std::vector<sp_node> all_nodes{root}, level{root};
+	for(std::size_t l = 0; l < n_levels; ++l) {
+		std::vector<sp_node> next_level;
+		for(const auto& N : level) {
+			N->insert(make_persons(n_leafs, "Citizen_" + std::to_string(all_nodes.size()) + "_"));
+			for(std::size_t i = 0; i < n_nodes; ++i) {
+				auto child = std::make_shared<node>();
+				N->insert("node_" + std::to_string(i), child);
+				next_level.push_back(child);
+			}
+		}
+		all_nodes.insert(all_nodes.end(), next_level.begin(), next_level.end());
+		level = std::move(next_level);
+	}
+
+	// negative lookups
+	const auto search_absent = [&] {
+		std::size_t n_found = 0;
+		for(std::size_t i = 0; i < n_queries; ++i)
+			n_found += bool(root->deep_search("Absent_" + std::to_string(i), node::Key::Name));
+		return n_found;
+	};
+	const auto t_plain = timeit(search_absent);
+	root->enable_summary();
+	const auto t_summary = timeit(search_absent);
+
+	// false positive rate: fraction of subtrees that aren't pruned for absent key
+	std::size_t n_fp = 0;
+	for(std::size_t i = 0; i < n_queries; ++i) {
+		const auto key = "Absent_" + std::to_string(i);
+		for(const auto& N : all_nodes)
+			n_fp += N->may_contain(key);
+	}
+	std::cout << fmt::format(
+		"{} nodes: negative deep search {:.4f} s -> {:.4f} s (x{:.1f}), false positive rate {:.4f}",
+		all_nodes.size(), t_plain, t_summary, t_plain / t_summary,
+		double(n_fp) / (n_queries * all_nodes.size())
+	) << std::endl;
+	BOOST_TEST(search_absent() == 0);
+	BOOST_TEST(root->deep_search("Citizen_1_7", node::Key::Name));
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_deref_glob) {
+	std::cout << "\n\n*** measuring glob path resolving vs walk & filter..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// /results/run_i/{mesh, params}/{x_final, y_final, x_i, ...}
+	constexpr std::size_t n_runs = 200, n_steps = 50;
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto results = std::make_shared<node>();
+	root_lnk->data_node()->insert("results", results);
+	const auto obj = kernel::tfactory::create_object("bs_person", "Citizen", 42.);
+	for(std::size_t i = 0; i < n_runs; ++i) {
+		auto run = std::make_shared<node>();
+		for(auto sub_name : {"mesh", "params"}) {
+			auto sub = std::make_shared<node>();
+			for(auto coord : {"x_", "y_", "z_"}) {
+				sub->insert(std::make_shared<hard_link>(std::string(coord) + "final", obj));
+				for(std::size_t j = 0; j < n_steps; ++j)
+					sub->insert(std::make_shared<hard_link>(coord + std::to_string(j), obj));
+			}
+			run->insert(sub_name, std::move(sub));
+		}
+		results->insert("run_" + std::to_string(i), std::move(run));
+	}
+
+	std::size_t n_walk = 0;
+	const auto t_walk = timeit([&] {
+		walk(root_lnk, [&](const sp_link& cur_root, std::list<sp_link>&, std::vector<sp_link>& leafs) {
+			if(cur_root->name() != "mesh") return;
+			for(const auto& L : leafs) {
+				const auto& name = L->name();
+				n_walk += name.size() >= 6 && name.compare(name.size() - 6, 6, "_final") == 0;
+			}
+		});
+	});
+	std::vector<std::size_t> n_glob;
+	std::vector<double> t_glob;
+	for(bool parallel : {false, true}) {
+		t_glob.push_back(timeit([&] {
+			n_glob.push_back(deref_glob("/results/*/mesh/?_final", root_lnk, true, parallel).size());
+		}));
+	}
+	std::cout << fmt::format(
+		"{} matches: walk & filter {:.4f} s, deref_glob {:.4f} s (x{:.1f}), parallel {:.4f} s (x{:.1f})",
+		n_walk, t_walk, t_glob[0], t_walk / t_glob[0], t_glob[1], t_walk / t_glob[1]
+	) << std::endl;
+	BOOST_TEST(n_walk == 3 * n_runs);
+	BOOST_TEST(n_glob[0] == n_walk);
+	BOOST_TEST(n_glob[1] == n_walk);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_deref_paths) {
+	std::cout << "\n\n*** measuring batch path resolving..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// /project/case_i/step_j/Citizen_k
+	constexpr std::size_t n_cases = 20, n_steps = 20, n_leafs = 20;
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto project = std::make_shared<node>();
+	root_lnk->data_node()->insert("project", project);
+	std::vector<std::string> paths;
+	for(std::size_t i = 0; i < n_cases; ++i) {
+		auto case_node = std::make_shared<node>();
+		for(std::size_t j = 0; j < n_steps; ++j) {
+			auto step = std::make_shared<node>();
+			step->insert(make_persons(n_leafs));
+			case_node->insert("step_" + std::to_string(j), std::move(step));
+			for(std::size_t k = 0; k < n_leafs; ++k)
+				paths.push_back(fmt::format("/project/case_{}/step_{}/Citizen_{}", i, j, k));
+		}
+		project->insert("case_" + std::to_string(i), std::move(case_node));
+	}
+
+	std::vector<sp_link> res_single;
+	const auto t_single = timeit([&] {
+		for(const auto& path : paths)
+			res_single.push_back(deref_path(path, root_lnk, node::Key::Name));
+	});
+	std::vector<sp_link> res_batch;
+	const auto t_batch = timeit([&] {
+		res_batch = deref_paths(paths, root_lnk, node::Key::Name);
+	});
+	std::cout << fmt::format(
+		"{} paths: deref_path {:.4f} s, deref_paths {:.4f} s (x{:.1f})",
+		paths.size(), t_single, t_batch, t_single / t_batch
+	) << std::endl;
+	BOOST_TEST(res_batch == res_single);
+	BOOST_TEST(std::find(res_batch.begin(), res_batch.end(), nullptr) == res_batch.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_stats) {
+	std::cout << "\n\n*** measuring subtree stats vs walk..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	constexpr std::size_t n_nodes = 100, n_leafs = 100;
+	const auto build = [&](bool with_stats) {
+		auto root_lnk = make_root_link("hard_link", "root");
+		if(with_stats) root_lnk->data_node()->enable_stats();
+		for(std::size_t i = 0; i < n_nodes; ++i) {
+			auto N = std::make_shared<node>();
+			root_lnk->data_node()->insert("node_" + std::to_string(i), N);
+			N->insert(make_persons(n_leafs));
+		}
+		return root_lnk;
+	};
+	sp_link plain, counted;
+	const auto t_build_plain = timeit([&] { plain = build(false); });
+	const auto t_build_stats = timeit([&] { counted = build(true); });
+
+	std::size_t n_walk = 0;
+	const auto t_walk = timeit([&] {
+		walk(plain, [&](const sp_link&, std::list<sp_link>&, std::vector<sp_link>& leafs) {
+			for(const auto& L : leafs)
+				n_walk += L->obj_type_id() == "bs_person";
+		});
+	});
+	std::size_t n_stats = 0;
+	const auto t_stats = timeit([&] {
+		n_stats = counted->data_node()->stats().types["bs_person"];
+	});
+	std::cout << fmt::format(
+		"{} objects: build {:.4f} s -> {:.4f} s with stats, count by walk {:.6f} s, by stats {:.6f} s",
+		n_walk, t_build_plain, t_build_stats, t_walk, t_stats
+	) << std::endl;
+	BOOST_TEST(n_walk == n_nodes * n_leafs);
+	BOOST_TEST(n_stats == n_walk);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_page) {
+	std::cout << "\n\n*** measuring paged iteration over huge node..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	constexpr std::size_t n_links = 1000000, page_size = 1000;
+	auto N = std::make_shared<node>();
+	N->insert(make_persons(n_links));
+
+	std::size_t n_keys = 0;
+	const auto t_keys = timeit([&] { n_keys = N->keys<node::Key::Name>().size(); });
+	node::page_t P;
+	const auto t_page = timeit([&] { P = N->page(node::Key::Name, {}, page_size); });
+	std::size_t n_paged = 0;
+	const auto t_all = timeit([&] {
+		auto cur = node::cursor{};
+		while(!cur.at_end) {
+			auto next = N->page(node::Key::Name, cur, page_size);
+			n_paged += next.links.size();
+			cur = std::move(next.next);
+		}
+	});
+	std::cout << fmt::format(
+		"{} links: all names {:.4f} s, first page {:.6f} s, all pages {:.4f} s",
+		n_links, t_keys, t_page, t_all
+	) << std::endl;
+	BOOST_TEST(n_keys == n_links);
+	BOOST_TEST(P.links.size() == page_size);
+	BOOST_TEST(n_paged == n_links);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_abspath) {
+	std::cout << "\n\n*** measuring cached abspath & root lookup..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// deep chain of nodes with leafs at the bottom
+	constexpr std::size_t depth = 50, n_leafs = 1000, n_rounds = 10;
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto N = root_lnk->data_node();
+	for(std::size_t i = 0; i < depth; ++i) {
+		auto next = std::make_shared<node>();
+		N->insert("level_" + std::to_string(i), next);
+		N = std::move(next);
+	}
+	N->insert(make_persons(n_leafs));
+
+	std::size_t n_chars = 0;
+	const auto calc_paths = [&] {
+		for(const auto& L : *N) {
+			n_chars += abspath(L, node::Key::Name).size();
+			n_chars += find_root_handle(L) == root_lnk;
+		}
+	};
+	const auto t_cold = timeit(calc_paths);
+	const auto t_warm = timeit([&] {
+		for(std::size_t i = 0; i < n_rounds; ++i) calc_paths();
+	}) / n_rounds;
+	// new node handles in another tree don't invalidate cached paths
+	auto other_lnk = make_root_link("hard_link", "other");
+	const auto other = other_lnk->data_node();
+	const auto t_other = timeit([&] {
+		for(std::size_t i = 0; i < n_rounds; ++i) {
+			other->insert("level_0", std::make_shared<node>());
+			calc_paths();
+		}
+	}) / n_rounds;
+	std::cout << fmt::format(
+		"{} links at depth {}: first pass {:.6f} s, next passes {:.6f} s, with changes in other tree {:.6f} s",
+		n_leafs, depth, t_cold, t_warm, t_other
+	) << std::endl;
+	BOOST_TEST(n_chars > 0);
+	BOOST_TEST(abspath(*N->begin(), node::Key::Name).rfind("/level_0/level_1/", 0) == 0);
+	BOOST_TEST(find_root(*N->begin()) == root_lnk->data_node());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_remote) {
+	std::cout << "\n\n*** measuring remote link vs local link..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	constexpr std::size_t n_nodes = 100, n_leafs = 100, n_requests = 1000;
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto N = root_lnk->data_node();
+	for(std::size_t i = 0; i < n_nodes; ++i) {
+		auto sub = std::make_shared<node>();
+		sub->insert(make_persons(n_leafs));
+		N->insert("sub_" + std::to_string(i), std::move(sub));
+	}
+
+	const auto port = publish(root_lnk);
+	BOOST_TEST_REQUIRE(port.has_value());
+	auto R = std::make_shared<remote_link>("remote", "127.0.0.1", *port);
+
+	// latency of single requests
+	const auto path = "sub_42/Citizen_42";
+	const auto t_local = timeit([&] {
+		for(std::size_t i = 0; i < n_requests; ++i)
+			BOOST_TEST_REQUIRE(deref_path(path, root_lnk, node::Key::Name));
+	}) / n_requests;
+	const auto t_remote = timeit([&] {
+		for(std::size_t i = 0; i < n_requests; ++i)
+			BOOST_TEST_REQUIRE(R->deref_path(path, node::Key::Name).has_value());
+	}) / n_requests;
+	std::cout << fmt::format(
+		"deref_path: local {:.6f} s, remote {:.6f} s per request", t_local, t_remote
+	) << std::endl;
+
+	// throughput of listing whole tree: level by level with pipelined requests
+	std::size_t n_listed = 0;
+	const auto t_populate = timeit([&] {
+		BOOST_TEST(R->populate(2).ok());
+		for(const auto& L : *R->data_node())
+			n_listed += L->data_node()->size();
+	});
+	const auto t_walk = timeit([&] {
+		std::size_t n = 0;
+		for(const auto& L : *N)
+			n += L->data_node()->size();
+		BOOST_TEST(n == n_listed);
+	});
+	std::cout << fmt::format(
+		"listing of {} links: local {:.6f} s, remote {:.6f} s ({:.0f} links/s)",
+		n_listed, t_walk, t_populate, n_listed / t_populate
+	) << std::endl;
+
+	// cached data is returned without requests
+	const auto L = deref_path(path, R, node::Key::Name);
+	BOOST_TEST_REQUIRE(L);
+	const auto t_pull = timeit([&] { BOOST_TEST(L->data()); });
+	const auto t_cached = timeit([&] { BOOST_TEST(L->data()); });
+	std::cout << fmt::format("data: first pull {:.6f} s, cached {:.6f} s", t_pull, t_cached) << std::endl;
+
+	BOOST_TEST(n_listed == n_nodes * n_leafs);
+	BOOST_TEST(unpublish(*port).ok());
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_link_status) {
+	std::cout << "\n\n*** measuring readers contention on loading link..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	constexpr std::size_t n_threads = 64, n_rounds = 10;
+	constexpr auto delay = std::chrono::milliseconds(50);
+	auto B = std::make_shared<slow_bridge>(delay);
+	auto L = std::make_shared<fusion_link>("slow", std::make_shared<node>(), B);
+
+	std::atomic<std::size_t> n_ok{0};
+	const auto c_start = std::clock();
+	const auto t_total = timeit([&] {
+		for(std::size_t r = 0; r < n_rounds; ++r) {
+			// all readers hit link while first one is loading data
+			L->rs_reset(link::Req::Data);
+			std::vector<std::thread> readers;
+			readers.reserve(n_threads);
+			for(std::size_t i = 0; i < n_threads; ++i)
+				readers.emplace_back([&] { n_ok += bool(L->data_ex(true)); });
+			for(auto& t : readers) t.join();
+		}
+	});
+	const auto t_cpu = double(std::clock() - c_start) / CLOCKS_PER_SEC;
+	std::cout << fmt::format(
+		"{} readers x {} rounds: wall {:.6f} s (load takes {:.3f} s), cpu {:.6f} s, {} loads",
+		n_threads, n_rounds, t_total, std::chrono::duration<double>(delay).count() * n_rounds,
+		t_cpu, B->n_pulls.load()
+	) << std::endl;
+
+	BOOST_TEST(n_ok == n_threads * n_rounds);
+	// readers that come after load started must not trigger another load
+	BOOST_TEST(B->n_pulls == n_rounds);
+	BOOST_TEST(L->req_status(link::Req::Data) == link::ReqStatus::OK);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_propagate_owner) {
+	std::cout << "\n\n*** measuring deep owner propagation..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// wide subtree with leafs in every node
+	constexpr std::size_t n_nodes = 1000, n_leafs = 100, depth = 10000;
+	auto root_lnk = make_root_link("hard_link", "root");
+	auto R = root_lnk->data_node();
+	for(std::size_t i = 0; i < n_nodes; ++i) {
+		auto N = std::make_shared<node>();
+		N->insert(make_persons(n_leafs));
+		R->insert("node_" + std::to_string(i), N);
+	}
+	// and long chain of nested nodes
+	auto tail = std::make_shared<node>();
+	R->insert("chain", tail);
+	for(std::size_t i = 0; i < depth; ++i) {
+		auto N = std::make_shared<node>();
+		tail->insert("level", N);
+		tail = std::move(N);
+	}
+
+	const auto t_serial = timeit([&] { R->propagate_owner(true, false); });
+	const auto t_parallel = timeit([&] { R->propagate_owner(true, true); });
+	std::cout << fmt::format(
+		"{} nodes x {} leafs + chain of {} nodes: serial {:.6f} s, parallel {:.6f} s",
+		n_nodes, n_leafs, depth, t_serial, t_parallel
+	) << std::endl;
+
+	BOOST_TEST(tail->handle()->owner()->handle()->owner());
+	const auto N = R->find("node_1", node::Key::Name)->get()->data_node();
+	BOOST_TEST(N->begin()->get()->owner() == N);
+}
+
+BOOST_AUTO_TEST_CASE(test_tree_perf_traverse) {
+	std::cout << "\n\n*** measuring iterative traversal vs recursion..." << std::endl;
+	std::cout << "*********************************************************************" << std::endl;
+
+	// shallow tree: 3 levels of 20 nodes with leafs on last level
+	constexpr std::size_t n_nodes = 20, n_leafs = 50;
+	auto root_lnk = make_root_link("hard_link", "root");
+	const auto R = root_lnk->data_node();
+	for(std::size_t i = 0; i < n_nodes; ++i) {
+		auto N1 = std::make_shared<node>();
+		R->insert("node_" + std::to_string(i), N1);
+		for(std::size_t j = 0; j < n_nodes; ++j) {
+			auto N2 = std::make_shared<node>();
+			N1->insert("node_" + std::to_string(j), N2);
+			N2->insert(make_persons(n_leafs));
+		}
+	}
+
+	// recursive walk that visits same links
+	std::size_t n_rec = 0;
+	const auto rec_walk = [&](const sp_node& N, auto& self) -> void {
+		for(const auto& L : *N) {
+			++n_rec;
+			if(auto child = L->data_node())
+				self(child, self);
+		}
+	};
+	std::size_t n_iter = 0, n_walk = 0;
+	const auto t_rec = timeit([&] { rec_walk(R, rec_walk); });
+	const auto t_iter = timeit([&] {
+		traverse(root_lnk, [&](traverse_frame& F) {
+			n_iter += F.nodes.size() + F.leafs.size();
+			return TraverseStep::Continue;
+		}, {TraverseOrder::PreOrder, false, false, true});
+	});
+	const auto t_walk = timeit([&] {
+		walk(root_lnk, [&](const sp_link&, std::list<sp_link>& nodes, std::vector<sp_link>& leafs) {
+			n_walk += nodes.size() + leafs.size();
+		});
+	});
+	const auto t_deep_search = timeit([&] {
+		BOOST_TEST(!R->deep_search("missing", node::Key::Name));
+	});
+	std::cout << fmt::format(
+		"{} links: recursion {:.6f} s, traverse {:.6f} s, walk {:.6f} s, deep search {:.6f} s",
+		n_rec, t_rec, t_iter, t_walk, t_deep_search
+	) << std::endl;
+
+	BOOST_TEST(n_iter == n_rec);
+	BOOST_TEST(n_walk == n_rec);
+}